@@ -0,0 +1,103 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+
+namespace MagoST
+{
+    // A bounded cache of values looked up by address, dropping the least recently used.
+    // It's split into shards with their own lock, so that threads walking stacks,
+    // disassembling, and evaluating expressions don't wait on each other much.
+
+    template <class T>
+    class AddrCache
+    {
+        static const int    ShardCount = 8;
+
+        typedef std::pair<uint64_t, T>                          Item;
+        typedef std::list<Item>                                 ItemList;
+        typedef std::unordered_map<uint64_t, typename ItemList::iterator> ItemMap;
+
+        struct Shard
+        {
+            Guard       Lock;
+            ItemList    Items;      // most recently used first
+            ItemMap     Map;
+        };
+
+        Shard       mShards[ShardCount];
+        size_t      mShardCapacity;
+
+    public:
+        explicit AddrCache( size_t capacity )
+            :   mShardCapacity( capacity / ShardCount )
+        {
+            if ( mShardCapacity == 0 )
+                mShardCapacity = 1;
+        }
+
+        bool Find( uint64_t key, T& value )
+        {
+            Shard&      shard = GetShard( key );
+            GuardedArea guard( shard.Lock );
+
+            auto it = shard.Map.find( key );
+            if ( it == shard.Map.end() )
+                return false;
+
+            shard.Items.splice( shard.Items.begin(), shard.Items, it->second );
+            value = it->second->second;
+            return true;
+        }
+
+        void Add( uint64_t key, const T& value )
+        {
+            Shard&      shard = GetShard( key );
+            GuardedArea guard( shard.Lock );
+
+            auto it = shard.Map.find( key );
+            if ( it != shard.Map.end() )
+            {
+                shard.Items.splice( shard.Items.begin(), shard.Items, it->second );
+                it->second->second = value;
+                return;
+            }
+
+            if ( shard.Map.size() >= mShardCapacity )
+            {
+                shard.Map.erase( shard.Items.back().first );
+                shard.Items.pop_back();
+            }
+
+            shard.Items.push_front( Item( key, value ) );
+            shard.Map[key] = shard.Items.begin();
+        }
+
+        void Clear()
+        {
+            for ( int i = 0; i < ShardCount; i++ )
+            {
+                GuardedArea guard( mShards[i].Lock );
+
+                mShards[i].Map.clear();
+                mShards[i].Items.clear();
+            }
+        }
+
+    private:
+        Shard& GetShard( uint64_t key )
+        {
+            // addresses are aligned and close together, so mix in the higher bits
+            uint64_t    mixed = key ^ (key >> 7) ^ (key >> 17);
+            return mShards[mixed % ShardCount];
+        }
+    };
+}
@@ -30,6 +30,7 @@
 
 // Magus
 #include <SmartPtr.h>
+#include <Guard.h>
 
 // CVSym project
 #include "..\CVSym\Error.h"
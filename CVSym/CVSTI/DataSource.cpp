@@ -11,13 +11,23 @@
 #include "IAddressMap.h"
 #include "ImageDebugContainer.h"
 #include "Session.h"
+#include "SymbolCache.h"
 #include "../CVSym/PDBDebugStore.h"
+#include <algorithm>
 
 using namespace std;
 
 
 namespace MagoST
 {
+    const wchar_t   SymbolCacheExt[] = L".msc";
+
+    // The cache directory is shared by all sessions, and is trimmed to these
+    // after a file is written.
+    const size_t    MaxSymbolCacheFiles = 256;
+    const uint64_t  MaxSymbolCacheDirSize = 256 * 1024 * 1024;
+    const LONGLONG  MaxSymbolCacheFileSize = 64 * 1024 * 1024;
+
     DataSource::DataSource()
         :   mRefCount( 0 ),
             mDebugView( NULL ),
@@ -104,6 +114,9 @@ namespace MagoST
             mStore = store;
         }
 
+        if ( SUCCEEDED( hr ) )
+            InitSymbolCacheFile( filename );
+
         return hr;
     }
 
@@ -138,4 +151,225 @@ namespace MagoST
     {
         return mAddrMap;
     }
+
+    void DataSource::SetSymbolCacheDir( const wchar_t* dir )
+    {
+        mSymbolCacheDir = (dir != NULL) ? dir : L"";
+    }
+
+    static uint64_t hashBytes( uint64_t hash, const void* bytes, size_t size )
+    {
+        // FNV-1a
+        const uint8_t* p = (const uint8_t*) bytes;
+
+        for ( size_t i = 0; i < size; i++ )
+        {
+            hash ^= p[i];
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    void DataSource::InitSymbolCacheFile( const wchar_t* filename )
+    {
+        const DWORD     PdbIdOffset = 4;
+        const DWORD     PdbIdSize = 16 + 4;     // GUID and age
+        const uint64_t  HashSeed = 0xCBF29CE484222325ULL;
+
+        mSymbolCacheFile.clear();
+        mSymbolCacheId.clear();
+
+        if ( mSymbolCacheDir.empty() || (filename == NULL) || (mDebugView == NULL) )
+            return;
+
+        // A PDB is identified by its GUID and age. Embedded CodeView has no such ID, 
+        // but it's part of the image, so the image's size and write time stand in for it.
+
+        if ( (mDebugSize >= PdbIdOffset + PdbIdSize) && (memcmp( mDebugView, "RSDS", 4 ) == 0) )
+        {
+            mSymbolCacheId.assign( (const char*) mDebugView, PdbIdOffset + PdbIdSize );
+        }
+        else
+        {
+            WIN32_FILE_ATTRIBUTE_DATA   attrs = { 0 };
+
+            if ( !GetFileAttributesExW( filename, GetFileExInfoStandard, &attrs ) )
+                return;
+
+            mSymbolCacheId.assign( "CV" );
+            mSymbolCacheId.append( (const char*) &attrs.nFileSizeHigh, sizeof attrs.nFileSizeHigh );
+            mSymbolCacheId.append( (const char*) &attrs.nFileSizeLow, sizeof attrs.nFileSizeLow );
+            mSymbolCacheId.append( (const char*) &attrs.ftLastWriteTime, sizeof attrs.ftLastWriteTime );
+        }
+
+        mSymbolCacheId.append( (const char*) filename, wcslen( filename ) * sizeof( wchar_t ) );
+
+        // the file name only has to tell binaries apart, the ID inside is checked on read
+        const wchar_t*  baseName = wcsrchr( filename, L'\\' );
+        wchar_t         suffix[32] = L"";
+        uint64_t        idHash = hashBytes( HashSeed, mSymbolCacheId.data(), mSymbolCacheId.size() );
+
+        baseName = (baseName != NULL) ? baseName + 1 : filename;
+        swprintf_s( suffix, L"-%016I64x%s", idHash, SymbolCacheExt );
+
+        mSymbolCacheFile = GetSymbolCachePath( baseName );
+        mSymbolCacheFile.append( suffix );
+    }
+
+    std::wstring DataSource::GetSymbolCachePath( const wchar_t* name )
+    {
+        std::wstring    path( mSymbolCacheDir );
+
+        if ( path.back() != L'\\' )
+            path.append( 1, L'\\' );
+        path.append( name );
+        return path;
+    }
+
+    bool DataSource::HasSymbolCache()
+    {
+        return !mSymbolCacheFile.empty();
+    }
+
+    HRESULT DataSource::LoadSymbolCache( SymbolCacheData& data )
+    {
+        if ( mSymbolCacheFile.empty() )
+            return E_FAIL;
+
+        FileHandlePtr           hFile;
+        LARGE_INTEGER           fileSize = { 0 };
+        std::vector<uint8_t>    bytes;
+        DWORD                   bytesRead = 0;
+
+        // the strings are copied out anyway, so a plain read does as well as mapping the file
+        hFile = CreateFileW( 
+            mSymbolCacheFile.c_str(), 
+            GENERIC_READ | FILE_WRITE_ATTRIBUTES, 
+            FILE_SHARE_READ | FILE_SHARE_DELETE, 
+            NULL, 
+            OPEN_EXISTING, 
+            FILE_FLAG_SEQUENTIAL_SCAN, 
+            NULL );
+        if ( hFile.IsEmpty() )
+            return HRESULT_FROM_WIN32( GetLastError() );
+
+        if ( !GetFileSizeEx( hFile, &fileSize ) )
+            return HRESULT_FROM_WIN32( GetLastError() );
+        if ( (fileSize.QuadPart == 0) || (fileSize.QuadPart > MaxSymbolCacheFileSize) )
+            return E_FAIL;
+
+        bytes.resize( (size_t) fileSize.QuadPart );
+
+        if ( !ReadFile( hFile, &bytes[0], (DWORD) bytes.size(), &bytesRead, NULL ) )
+            return HRESULT_FROM_WIN32( GetLastError() );
+
+        if ( (bytesRead != bytes.size()) 
+            || !SymbolCache::Read( &bytes[0], bytes.size(), mSymbolCacheId, data ) )
+            return E_FAIL;
+
+        // the oldest files are trimmed first, so mark this one as used
+        FILETIME    now = { 0 };
+
+        GetSystemTimeAsFileTime( &now );
+        SetFileTime( hFile, NULL, NULL, &now );
+
+        return S_OK;
+    }
+
+    HRESULT DataSource::SaveSymbolCache( const SymbolCacheData& data )
+    {
+        if ( mSymbolCacheFile.empty() )
+            return E_FAIL;
+
+        std::vector<uint8_t>    bytes;
+        std::wstring            tempPath( mSymbolCacheFile );
+        FileHandlePtr           hFile;
+        DWORD                   written = 0;
+        wchar_t                 suffix[32] = L"";
+
+        SymbolCache::Write( mSymbolCacheId, data, bytes );
+
+        // it's fine if it already exists
+        CreateDirectoryW( mSymbolCacheDir.c_str(), NULL );
+
+        // write to a private file, then move it in place,
+        // so that other sessions never see a partial file
+        swprintf_s( suffix, L".%x.tmp", GetCurrentThreadId() );
+        tempPath.append( suffix );
+
+        hFile = CreateFileW( tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL );
+        if ( hFile.IsEmpty() )
+            return HRESULT_FROM_WIN32( GetLastError() );
+
+        BOOL    ok = WriteFile( hFile, bytes.data(), (DWORD) bytes.size(), &written, NULL );
+
+        hFile.Attach( INVALID_HANDLE_VALUE );
+
+        if ( !ok || (written != bytes.size())
+            || !MoveFileExW( tempPath.c_str(), mSymbolCacheFile.c_str(), MOVEFILE_REPLACE_EXISTING ) )
+        {
+            HRESULT hr = HRESULT_FROM_WIN32( GetLastError() );
+            DeleteFileW( tempPath.c_str() );
+            return FAILED( hr ) ? hr : E_FAIL;
+        }
+
+        TrimSymbolCacheDir();
+
+        return S_OK;
+    }
+
+    void DataSource::TrimSymbolCacheDir()
+    {
+        struct CacheFile
+        {
+            uint64_t        LastWrite;
+            uint64_t        Size;
+            std::wstring    Name;
+
+            bool operator<( const CacheFile& other ) const
+            {
+                return LastWrite > other.LastWrite;
+            }
+        };
+
+        std::vector<CacheFile>  files;
+        WIN32_FIND_DATAW        findData = { 0 };
+        std::wstring            pattern( GetSymbolCachePath( L"*" ) );
+        HANDLE                  hFind = INVALID_HANDLE_VALUE;
+        uint64_t                totalSize = 0;
+
+        pattern.append( SymbolCacheExt );
+
+        hFind = FindFirstFileW( pattern.c_str(), &findData );
+        if ( hFind == INVALID_HANDLE_VALUE )
+            return;
+
+        do
+        {
+            if ( (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 )
+                continue;
+
+            CacheFile   file;
+
+            file.LastWrite = ((uint64_t) findData.ftLastWriteTime.dwHighDateTime << 32) 
+                | findData.ftLastWriteTime.dwLowDateTime;
+            file.Size = ((uint64_t) findData.nFileSizeHigh << 32) | findData.nFileSizeLow;
+            file.Name = findData.cFileName;
+            files.push_back( file );
+        } while ( FindNextFileW( hFind, &findData ) );
+
+        FindClose( hFind );
+
+        // keep the most recently used files that fit in the limits, 
+        // and delete the rest; another session might still be reading one, which is fine
+        std::sort( files.begin(), files.end() );
+
+        for ( size_t i = 0; i < files.size(); i++ )
+        {
+            totalSize += files[i].Size;
+
+            if ( (i >= MaxSymbolCacheFiles) || (totalSize > MaxSymbolCacheDirSize) )
+                DeleteFileW( GetSymbolCachePath( files[i].Name.c_str() ).c_str() );
+        }
+    }
 }
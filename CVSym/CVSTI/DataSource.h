@@ -9,11 +9,13 @@
 
 #include "IDataSource.h"
 #include <memory>
+#include <string>
 
 namespace MagoST
 {
     class IDebugContainer;
     class IAddressMap;
+    struct SymbolCacheData;
 
 
     class DataSource : public IDataSource
@@ -27,6 +29,10 @@ namespace MagoST
 
         RefPtr<IAddressMap>             mAddrMap;
 
+        std::wstring                    mSymbolCacheDir;
+        std::wstring                    mSymbolCacheFile;
+        std::string                     mSymbolCacheId;
+
     public:
         DataSource();
         ~DataSource();
@@ -44,7 +50,19 @@ namespace MagoST
 
         virtual HRESULT OpenSession( ISession*& session );
 
+        virtual void SetSymbolCacheDir( const wchar_t* dir );
+
         IDebugStore* GetDebugStore();
         RefPtr<IAddressMap> GetAddressMap();
+
+        // returns false if there's no cache for this debug info
+        bool HasSymbolCache();
+        HRESULT LoadSymbolCache( SymbolCacheData& data );
+        HRESULT SaveSymbolCache( const SymbolCacheData& data );
+
+    private:
+        void InitSymbolCacheFile( const wchar_t* filename );
+        std::wstring GetSymbolCachePath( const wchar_t* name );
+        void TrimSymbolCacheDir();
     };
 }
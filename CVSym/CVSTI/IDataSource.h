@@ -31,5 +31,9 @@ namespace MagoST
         virtual HRESULT InitDebugInfo( IDiaSession* session, IAddressMap* addrMap ) = 0;
 
         virtual HRESULT OpenSession( ISession*& session ) = 0;
+
+        // Sessions keep the symbol name indexes they build in files in this directory, 
+        // and read them back for the same debug info. Call before InitDebugInfo.
+        virtual void SetSymbolCacheDir( const wchar_t* dir ) = 0;
     };
 }
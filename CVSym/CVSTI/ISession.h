@@ -26,6 +26,14 @@ namespace MagoST
     struct LineInfo;
     struct FileSegmentInfo;
 
+    struct FileLineRequest
+    {
+        const char* FileName;       // UTF-8
+        size_t      FileNameLen;
+        uint16_t    LineStart;
+        uint16_t    LineEnd;
+    };
+
     class ISession
     {
     public:
@@ -66,6 +74,10 @@ namespace MagoST
             size_t nameLen, 
             SymHandle& handle ) = 0;
 
+        // builds the name indexes used by the FindMatching and short name functions;
+        // they're built on first use otherwise. Can be called on any thread.
+        virtual HRESULT CacheGlobals() = 0;
+
         virtual HRESULT FindMatchingGlobals( const char* nameChars, size_t nameLen, std::vector<SymHandle>& handles ) = 0;
         virtual HRESULT FindMatchingDebugFuncs( const char* nameChars, size_t nameLen, std::vector<SymHandle>& handles ) = 0;
         virtual HRESULT FindMatchingForeachFuncs( const char* nameChars, size_t nameLen, std::vector<std::string>& funcs ) = 0;
@@ -75,6 +87,8 @@ namespace MagoST
         virtual HRESULT FindFuncShortName( const char* nameChars, size_t nameLen, std::string& shortName ) = 0;
 
         virtual HRESULT FindGlobalSymbolByAddr( uint64_t va, bool exact, SymHandle& symHandle, uint16_t& sec, uint32_t& offset, uint32_t& symOff ) = 0;
+        // same as FindGlobalSymbolByAddr and then getting the symbol's name, but the name is cached
+        virtual HRESULT FindGlobalSymbolNameByAddr( uint64_t va, bool exact, std::string& name, uint32_t& symOff ) = 0;
 
         virtual HRESULT FindOuterSymbolByAddr( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff) = 0;
         virtual HRESULT FindOuterSymbolByRVA( SymbolHeapId heapId, DWORD rva, SymHandle& handle ) = 0;
@@ -103,6 +117,13 @@ namespace MagoST
             size_t nameLen, 
             TypeHandle& handle ) = 0;
 
+        // like FindChildType, but also looks through the base classes of the field list
+        virtual HRESULT FindMemberType( 
+            TypeIndex fieldListIndex, 
+            const char* nameChars, 
+            size_t nameLen, 
+            TypeHandle& handle ) = 0;
+
         // source files
 
         virtual HRESULT GetCompilandCount( uint32_t& count ) = 0;
@@ -121,5 +142,8 @@ namespace MagoST
         virtual bool FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
                                 std::list<LineNumber>& lines ) = 0;
 
+        // resolves each request to lines[i], trying an exact file name match before a partial one
+        virtual bool BindLines( const std::vector<FileLineRequest>& requests, std::vector<std::list<LineNumber>>& lines ) = 0;
+
     };
 }
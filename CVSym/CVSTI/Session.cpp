@@ -9,6 +9,9 @@
 #include "Session.h"
 #include "DataSource.h"
 #include "IAddressMap.h"
+#include "SymbolCache.h"
+#include <process.h>
+#include <memory>
 // TODO:
 #include "..\CVSym\cvconst.h"
 
@@ -19,7 +22,11 @@ namespace MagoST
         :   mRefCount( 0 ),
             mLoadAddr( 0 ),
             mDataSource( dataSource ),
-            mStore( NULL )
+            mStore( NULL ),
+            mOuterSymbols( 0x4000 ),
+            mAddrSymbols( 0x4000 ),
+            mGlobalsCached( false ),
+            mSourceFilesCached( false )
     {
         _ASSERT( dataSource != NULL );
 
@@ -211,54 +218,109 @@ namespace MagoST
 
     HRESULT Session::FindGlobalSymbolByAddr( uint64_t va, bool exact, SymHandle& symHandle, uint16_t& sec, uint32_t& offset, uint32_t& symOff )
     {
-        sec = GetSecOffsetFromVA( va, offset );
-        if ( sec == 0 )
-            return E_NOT_FOUND;
+        AddrSymbol sym;
+        _findAddrSymbol( va, exact, sym );
+
+        sec = sym.Sec;
+        offset = sym.Offset;
+        if ( sym.Sec == 0 )
+            return sym.Result;
 
-        DWORD off = 0;
-        HRESULT hr = FindOuterSymbolByAddr( MagoST::SymHeap_GlobalSymbols, sec, offset, symHandle, off );
-        if ( FAILED( hr ) || ( exact && off != 0 ) )
-            hr = FindOuterSymbolByAddr( MagoST::SymHeap_StaticSymbols, sec, offset, symHandle, off );
-        if ( FAILED( hr ) || ( exact && off != 0 ) )
-            hr = FindOuterSymbolByAddr( MagoST::SymHeap_PublicSymbols, sec, offset, symHandle, off );
+        symHandle = sym.Handle;
+        if ( !FAILED( sym.Result ) || ( exact && sym.SymOff != 0 ) )
+            symOff = sym.SymOff;
 
-        if ( !FAILED( hr ) )
+        return sym.Result;
+    }
+
+    HRESULT Session::FindGlobalSymbolNameByAddr( uint64_t va, bool exact, std::string& name, uint32_t& symOff )
+    {
+        AddrSymbol sym;
+        uint64_t key = _findAddrSymbol( va, exact, sym );
+
+        if ( FAILED( sym.Result ) )
+            return sym.Result;
+
+        if ( !sym.NameCached )
         {
-            symOff = off;
-            if ( exact && off != 0 )
-                hr = E_NOT_FOUND;
+            MagoST::SymInfoData infoData = { 0 };
+            MagoST::ISymbolInfo* symInfo = NULL;
+            SymString pstrName;
+
+            if ( GetSymbolInfo( sym.Handle, infoData, symInfo ) == S_OK && symInfo->GetName( pstrName ) )
+                sym.Name.assign( pstrName.GetName(), pstrName.GetLength() );
+
+            sym.NameCached = true;
+            mAddrSymbols.Add( key, sym );
         }
 
-        return hr;
+        if ( sym.Name.empty() )
+            return E_FAIL;
+
+        name = sym.Name;
+        symOff = sym.SymOff;
+        return S_OK;
+    }
+
+    uint64_t Session::_findAddrSymbol( uint64_t va, bool exact, AddrSymbol& sym )
+    {
+        uint64_t key = (va << 1) | (exact ? 1 : 0);
+
+        // the top bit of the address is lost in the key, so check it
+        if ( mAddrSymbols.Find( key, sym ) && sym.Va == va )
+            return key;
+
+        sym.Va = va;
+        sym.Handle = SymHandle();
+        sym.Offset = 0;
+        sym.SymOff = 0;
+        sym.NameCached = false;
+        sym.Name.clear();
+
+        sym.Sec = GetSecOffsetFromVA( va, sym.Offset );
+        if ( sym.Sec == 0 )
+        {
+            sym.Result = E_NOT_FOUND;
+        }
+        else
+        {
+            DWORD off = 0;
+            HRESULT hr = FindOuterSymbolByAddr( MagoST::SymHeap_GlobalSymbols, sym.Sec, sym.Offset, sym.Handle, off );
+            if ( FAILED( hr ) || ( exact && off != 0 ) )
+                hr = FindOuterSymbolByAddr( MagoST::SymHeap_StaticSymbols, sym.Sec, sym.Offset, sym.Handle, off );
+            if ( FAILED( hr ) || ( exact && off != 0 ) )
+                hr = FindOuterSymbolByAddr( MagoST::SymHeap_PublicSymbols, sym.Sec, sym.Offset, sym.Handle, off );
+
+            if ( !FAILED( hr ) )
+            {
+                sym.SymOff = off;
+                if ( exact && off != 0 )
+                    hr = E_NOT_FOUND;
+            }
+            sym.Result = hr;
+        }
+
+        // failures are kept too, there are many addresses without symbols in disassembly
+        mAddrSymbols.Add( key, sym );
+        return key;
     }
 
     HRESULT Session::FindOuterSymbolByAddr( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff )
     {
         uint64_t segoff = ((uint64_t)heapId << 48) | ((uint64_t)segment << 32) | offset;
-        auto it = mAddrSymbolMap.find( segoff );
-        if( it != mAddrSymbolMap.end() )
+        OuterSymbol sym;
+        if( mOuterSymbols.Find( segoff, sym ) )
         {
-            handle = it->second.first;
-            symOff = it->second.second;
+            handle = sym.Handle;
+            symOff = sym.SymOff;
             return S_OK;
         }
         HRESULT hr = mStore->FindSymbol( heapId, segment, offset, handle, symOff );
         if (hr != S_OK)
             return hr;
-        if ( mAddrSymbolMap.size() >= 0x4000 )
-        {
-            // remove last (oldest?) element in a random bucket
-            uint64_t val = mAddrSymbolMap.begin()->first;
-            auto buckets = mAddrSymbolMap.bucket_count();
-            for ( auto idx = std::rand() % buckets; idx < buckets; idx++ )
-                if ( mAddrSymbolMap.bucket_size( idx ) > 0 )
-                {
-                    val = std::prev( mAddrSymbolMap.end( idx ) )->first;
-                    break;
-                }
-            mAddrSymbolMap.erase( val );
-        }
-        mAddrSymbolMap[segoff] = { handle, symOff };
+        sym.Handle = handle;
+        sym.SymOff = symOff;
+        mOuterSymbols.Add( segoff, sym );
         return S_OK;
     }
 
@@ -406,16 +468,75 @@ namespace MagoST
         size_t nameLen, 
         TypeHandle& handle )
     {
+        HRESULT             hr = S_OK;
+        const MemberTable*  table = NULL;
+        GuardedArea         guard( mMembersGuard );
+
+        hr = _getChildTypes( parentHandle, table );
+        if ( FAILED( hr ) )
+            return hr;
+
+        auto it = table->find( std::string( nameChars, nameLen ) );
+        if ( it == table->end() )
+            return S_FALSE;
+
+        handle = it->second.Handle;
+        return S_OK;
+    }
+
+    HRESULT Session::FindMemberType( 
+        TypeIndex fieldListIndex, 
+        const char* nameChars, 
+        size_t nameLen, 
+        TypeHandle& handle )
+    {
+        GuardedArea         guard( mMembersGuard );
+        const MemberTable*  table = _getMembers( fieldListIndex, 0 );
+
+        if ( table == NULL )
+            return S_FALSE;
+
+        auto it = table->find( std::string( nameChars, nameLen ) );
+        if ( it == table->end() )
+            return S_FALSE;
+
+        handle = it->second.Handle;
+        return S_OK;
+    }
+
+    size_t Session::TypeHandleKey::operator() ( const TypeHandle& handle ) const
+    {
+        return std::hash<intptr_t>()( handle.unused1 ) ^ (size_t) handle.unused2;
+    }
+
+    bool Session::TypeHandleKey::operator() ( const TypeHandle& handle1, const TypeHandle& handle2 ) const
+    {
+        return (handle1.unused1 == handle2.unused1) && (handle1.unused2 == handle2.unused2);
+    }
+
+    // Reads all the children of a type once. When a name is used more than once, 
+    // the first child that isn't a function taking arguments is kept, because 
+    // until we support overload sets, we prefer an overload with zero arguments.
+
+    HRESULT Session::_getChildTypes( TypeHandle parentHandle, const MemberTable*& table )
+    {
+        auto it = mChildTypes.find( parentHandle );
+        if ( it != mChildTypes.end() )
+        {
+            table = &it->second;
+            return S_OK;
+        }
+
         HRESULT     hr = S_OK;
         TypeScope   scope = { 0 };
         TypeHandle  childHandle = { 0 };
         SymInfoData infoData = { 0 };
+        MemberTable children;
 
         hr = mStore->SetChildTypeScope( parentHandle, scope );
         if ( FAILED( hr ) )
             return hr;
 
-        HRESULT found = S_FALSE;
         for ( ; mStore->NextType( scope, childHandle ); )
         {
             ISymbolInfo*    symInfo = NULL;
@@ -432,16 +553,10 @@ namespace MagoST
             if ( !symInfo->GetName( pstrName ) )
                 continue;
 
-            if ( (nameLen == pstrName.GetLength()) && (memcmp( nameChars, pstrName.GetName(), nameLen ) == 0) )
-            {
-                if ( tag != SymTagFunction )
-                {
-                    handle = childHandle;
-                    found = S_OK;
-                    break;
-                }
+            MemberEntry entry = { childHandle, true };
 
-                // until we support overload sets, prefer an overload with zero arguments
+            if ( tag == SymTagFunction )
+            {
                 TypeIndex funcType;
                 TypeHandle funcTypeHandle;
                 SymInfoData funcInfoData = { 0 };
@@ -457,17 +572,96 @@ namespace MagoST
                 std::vector<TypeIndex> indexes;
                 if ( !funcInfo->GetTypes( indexes ) )
                     continue;
-                if ( indexes.empty() || found == S_FALSE )
-                {
-                    handle = childHandle;
-                    found = S_OK;
-                    if( indexes.empty() )
-                        break;
-                }
+
+                entry.Preferred = indexes.empty();
             }
+
+            auto inserted = children.insert( 
+                MemberTable::value_type( std::string( pstrName.GetName(), pstrName.GetLength() ), entry ) );
+
+            if ( !inserted.second && !inserted.first->second.Preferred && entry.Preferred )
+                inserted.first->second = entry;
         }
         mStore->EndTypeScope( scope );
-        return found;
+
+        MemberTable& cached = mChildTypes[parentHandle];
+        cached.swap( children );
+        table = &cached;
+        return S_OK;
+    }
+
+    // The members of a field list, followed by those of its base classes that 
+    // aren't hidden by a member of the same name.
+
+    const Session::MemberTable* Session::_getMembers( TypeIndex fieldListIndex, int depth )
+    {
+        auto it = mMembers.find( fieldListIndex );
+        if ( it != mMembers.end() )
+            return &it->second;
+
+        TypeHandle          flistHandle = { 0 };
+        TypeIndex           baseFListIndex = 0;
+        const MemberTable*  children = NULL;
+
+        if ( !mStore->GetTypeFromTypeIndex( fieldListIndex, flistHandle ) )
+            return NULL;
+
+        if ( _getChildTypes( flistHandle, children ) != S_OK )
+            return NULL;
+
+        MemberTable members( *children );
+
+        // a bad base class chain could loop forever
+        if ( (depth < MaxBaseClassDepth) && _getBaseFieldList( flistHandle, baseFListIndex ) )
+        {
+            const MemberTable* baseMembers = _getMembers( baseFListIndex, depth + 1 );
+
+            // insert doesn't replace members we already have
+            if ( baseMembers != NULL )
+                members.insert( baseMembers->begin(), baseMembers->end() );
+        }
+
+        MemberTable& cached = mMembers[fieldListIndex];
+        cached.swap( members );
+        return &cached;
+    }
+
+    bool Session::_getBaseFieldList( TypeHandle fieldListHandle, TypeIndex& baseFieldListIndex )
+    {
+        TypeScope       scope = { 0 };
+        TypeHandle      baseTH = { 0 };
+        SymInfoData     baseInfoData = { 0 };
+        ISymbolInfo*    baseInfo = NULL;
+        TypeIndex       baseClassTI = 0;
+        TypeHandle      baseClassTH = { 0 };
+        SymInfoData     baseClassInfoData = { 0 };
+        ISymbolInfo*    baseClassInfo = NULL;
+
+        if ( mStore->SetChildTypeScope( fieldListHandle, scope ) != S_OK )
+            return false;
+
+        // base classes are first in the field list
+        bool hasNext = mStore->NextType( scope, baseTH );
+        mStore->EndTypeScope( scope );
+        if ( !hasNext )
+            return false;
+
+        if ( mStore->GetTypeInfo( baseTH, baseInfoData, baseInfo ) != S_OK )
+            return false;
+
+        if ( baseInfo->GetSymTag() != SymTagBaseClass )
+            return false;
+
+        if ( !baseInfo->GetType( baseClassTI ) )
+            return false;
+
+        if ( !mStore->GetTypeFromTypeIndex( baseClassTI, baseClassTH ) )
+            return false;
+
+        if ( mStore->GetTypeInfo( baseClassTH, baseClassInfoData, baseClassInfo ) != S_OK )
+            return false;
+
+        return baseClassInfo->GetFieldList( baseFieldListIndex );
     }
 
     // source files
@@ -511,10 +705,85 @@ namespace MagoST
     {
         return mStore->FindLine( seg, offset, lineNumber );
     }
+
+    // lower case with back slashes, so that names compare like ExactFileNameMatch
+    static std::string normalizeFileName( const char* name, size_t len )
+    {
+        std::string path( name, len );
+        for ( size_t i = 0; i < len; i++ )
+        {
+            if ( path[i] == '/' )
+                path[i] = '\\';
+            else
+                path[i] = (char) tolower( (unsigned char) path[i] );
+        }
+        return path;
+    }
+
+    static size_t getFileNamePos( const std::string& path )
+    {
+        size_t pos = path.find_last_of( '\\' );
+        return pos == std::string::npos ? 0 : pos + 1;
+    }
+
     bool Session::FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
                              std::list<LineNumber>& lines )
     {
-        return mStore->FindLines( exactMatch, fileName, fileNameLen, reqLineStart, reqLineEnd, lines );
+        if ( fileNameLen == 0 )
+            return false;
+
+        _cacheSourceFiles();
+
+        std::string path = normalizeFileName( fileName, fileNameLen );
+        return _findLines( exactMatch, path, reqLineStart, reqLineEnd, lines );
+    }
+
+    bool Session::BindLines( const std::vector<FileLineRequest>& requests, std::vector<std::list<LineNumber>>& lines )
+    {
+        bool found = false;
+
+        lines.clear();
+        lines.resize( requests.size() );
+
+        if ( requests.empty() )
+            return false;
+
+        _cacheSourceFiles();
+
+        for ( size_t i = 0; i < requests.size(); i++ )
+        {
+            const FileLineRequest& req = requests[i];
+
+            if ( req.FileNameLen == 0 )
+                continue;
+
+            std::string path = normalizeFileName( req.FileName, req.FileNameLen );
+
+            if ( _findLines( true, path, req.LineStart, req.LineEnd, lines[i] )
+                || _findLines( false, path, req.LineStart, req.LineEnd, lines[i] ) )
+                found = true;
+        }
+        return found;
+    }
+
+    bool Session::_findLines( bool exactMatch, const std::string& path, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                              std::list<LineNumber>& lines )
+    {
+        auto it = mSourceFiles.find( path.substr( getFileNamePos( path ) ) );
+        if ( it == mSourceFiles.end() )
+            return false;
+
+        // a partial match only needs the same file name, which the lookup already made sure of
+        bool found = false;
+        for ( auto& file : it->second )
+        {
+            if ( exactMatch && file.Path != path )
+                continue;
+
+            if ( mStore->FindFileLines( file.CompilandIndex, file.FileIndex, reqLineStart, reqLineEnd, lines ) )
+                found = true;
+        }
+        return found;
     }
 
     bool Session::FindLineByNum( uint16_t compIndex, uint16_t fileIndex, uint16_t line, LineNumber& lineNumber )
@@ -526,10 +795,8 @@ namespace MagoST
         return mStore->FindNextLineByNum( compIndex, fileIndex, line, lineNumber );
     }
 
-    bool Session::reverse_less::operator() ( const std::string& s1, const std::string& s2 ) const
+    static bool reverseLess( const char* s1, size_t l1, const char* s2, size_t l2 )
     {
-        size_t l1 = s1.length();
-        size_t l2 = s2.length();
         size_t lmin = l1 < l2 ? l1 : l2;
         for ( size_t i = 1; i <= lmin; i++ )
             if ( s1[l1 - i] < s2[l2 - i] )
@@ -540,6 +807,11 @@ namespace MagoST
         return l1 < l2;
     }
 
+    bool Session::reverse_less::operator() ( const std::string& s1, const std::string& s2 ) const
+    {
+        return reverseLess( s1.data(), s1.length(), s2.data(), s2.length() );
+    }
+
     static std::string stripOneMember(const char* name, size_t len)
     {
         // strip one-member template duplication "fun!(arg).fun" -> "fun!(arg)"
@@ -627,23 +899,257 @@ namespace MagoST
         return std::string( name + pos, len - pos );
     }
 
+    void Session::_cacheSourceFiles()
+    {
+        if ( mSourceFilesCached )
+            return;
+
+        // breakpoints can be bound on another thread, so wait for its index
+        GuardedArea guard( mSourceFilesGuard );
+
+        if ( mSourceFilesCached )
+            return;
+
+        _scanSourceFiles();
+
+        mSourceFilesCached = true;
+    }
+
+    void Session::_scanSourceFiles()
+    {
+        uint32_t compCount = 0;
+        if ( mStore->GetCompilandCount( compCount ) != S_OK )
+            return;
+
+        for ( uint32_t compIx = 1; compIx <= compCount && compIx <= USHRT_MAX; compIx++ )
+        {
+            CompilandInfo compInfo;
+            if ( mStore->GetCompilandInfo( (uint16_t) compIx, compInfo ) != S_OK )
+                continue;
+
+            for ( uint16_t fileIx = 0; fileIx < compInfo.FileCount; fileIx++ )
+            {
+                FileInfo fileInfo;
+                if ( mStore->GetFileInfo( (uint16_t) compIx, fileIx, fileInfo ) != S_OK )
+                    continue;
+                if ( fileInfo.Name.GetLength() == 0 )
+                    continue;
+
+                SourceFileRef file;
+                file.CompilandIndex = (uint16_t) compIx;
+                file.FileIndex = fileIx;
+                file.Path = normalizeFileName( fileInfo.Name.GetName(), fileInfo.Name.GetLength() );
+
+                std::string name = file.Path.substr( getFileNamePos( file.Path ) );
+                mSourceFiles[name].push_back( std::move( file ) );
+            }
+        }
+    }
+
     void Session::_cacheGlobals()
     {
-        if( !mGlobals.empty() || !mDebugFuncs.empty() )
+        if( mGlobalsCached )
             return;
 
+        // the indexes might be getting built on another thread, so wait for them
+        GuardedArea guard( mGlobalsGuard );
+
+        if( mGlobalsCached )
+            return;
+
+        bool useCache = mDataSource->HasSymbolCache();
+
+        if( !useCache || !_loadGlobalsCache() )
+        {
+            _scanGlobals();
+
+            if( useCache )
+                _saveGlobalsCache();
+        }
+
+        mGlobalsCached = true;
+    }
+
+    HRESULT Session::CacheGlobals()
+    {
+        _cacheGlobals();
+        return S_OK;
+    }
+
+    bool Session::_loadGlobalsCache()
+    {
+        SymbolCacheData data;
+
+        if( mDataSource->LoadSymbolCache( data ) != S_OK )
+            return false;
+
+        mGlobals.reserve( data.Globals.size() );
+        for( auto& name : data.Globals )
+            mGlobals.push_back( mNames.Intern( name ) );
+
+        mFuncShorts.reserve( data.FuncShorts.size() );
+        for( auto& pair : data.FuncShorts )
+            mFuncShorts.push_back( { mNames.Intern( pair.first ), mNames.Intern( pair.second ) } );
+
+        mUDTshorts.reserve( data.UDTShorts.size() );
+        for( auto& pair : data.UDTShorts )
+            mUDTshorts.push_back( { mNames.Intern( pair.first ), mNames.Intern( pair.second ) } );
+
+        _sortNames();
+
+        // the handles of the debug functions are only valid for this session, so look them up again
+        for( auto& name : data.DebugFuncs )
+            _findDebugFuncs( name );
+
+        _buildUDTfqns();
+        mNames.ReleaseLookup();
+        return true;
+    }
+
+    void Session::_saveGlobalsCache()
+    {
+        SymbolCacheData data;
+
+        data.Globals.reserve( mGlobals.size() );
+        for( auto id : mGlobals )
+            data.Globals.push_back( mNames.GetString( id ) );
+
+        data.FuncShorts.reserve( mFuncShorts.size() );
+        for( auto& name : mFuncShorts )
+            data.FuncShorts.push_back( { mNames.GetString( name.Fqn ), mNames.GetString( name.Short ) } );
+
+        data.UDTShorts.reserve( mUDTshorts.size() );
+        for( auto& name : mUDTshorts )
+            data.UDTShorts.push_back( { mNames.GetString( name.Fqn ), mNames.GetString( name.Short ) } );
+
+        for( auto& func : mDebugFuncs )
+            data.DebugFuncs.push_back( func.first );
+
+        // if it can't be written, then the next session will scan again
+        mDataSource->SaveSymbolCache( data );
+    }
+
+    void Session::_scanGlobals()
+    {
+        uint32_t symCount = 0;
+        int threadCount = 1;
+
+        // DIA spends most of the time getting symbol properties, so split the symbols
+        // into slices, each scanned on its own thread, and merge the results in order
+        if( mStore->GetSymbolCount( SymHeap_GlobalSymbols, symCount ) == S_OK )
+        {
+            SYSTEM_INFO sysInfo = { 0 };
+            GetSystemInfo( &sysInfo );
+
+            threadCount = std::min<int>( sysInfo.dwNumberOfProcessors, MaxScanThreads );
+            threadCount = std::min<int>( threadCount, symCount / MinScanRangeSize );
+            if( threadCount < 1 )
+                threadCount = 1;
+        }
+
+        std::unique_ptr<GlobalsScanRange[]> ranges( new GlobalsScanRange[threadCount] );
+        HANDLE hThreads[MaxScanThreads] = { 0 };
+        uint32_t rangeSize = symCount / threadCount;
+
+        for( int i = 0; i < threadCount; i++ )
+        {
+            ranges[i].This = this;
+            ranges[i].Start = i * rangeSize;
+            // the last one goes to the end, also when the count isn't known
+            ranges[i].Count = (i == threadCount - 1) ? std::numeric_limits<uint32_t>::max() : rangeSize;
+            ranges[i].Scanned = false;
+            ranges[i].Scan.OwnStore = false;
+        }
+
+        // this thread does the first slice. Each thread scans with its own copy of the store,
+        // so that DIA objects aren't shared between threads, and so that the scan doesn't
+        // get in the way of others using this session while it's loading
+        for( int i = 1; i < threadCount; i++ )
+            hThreads[i] = (HANDLE) _beginthreadex( NULL, 0, ScanGlobalsProc, &ranges[i], 0, NULL );
+
+        _scanGlobalRangeWithCopy( ranges[0] );
+
+        for( int i = 1; i < threadCount; i++ )
+        {
+            if( hThreads[i] != NULL )
+            {
+                WaitForSingleObject( hThreads[i], INFINITE );
+                CloseHandle( hThreads[i] );
+            }
+        }
+
+        // without copies, the store is only used on this thread
+        for( int i = 0; i < threadCount; i++ )
+        {
+            if( !ranges[i].Scanned )
+                _scanGlobalRange( mStore, ranges[i].Start, ranges[i].Count, ranges[i].Scan );
+        }
+
+        for( int i = 0; i < threadCount; i++ )
+            _mergeGlobals( ranges[i].Scan );
+
+        _sortNames();
+        _finalizeUDTshorts();
+        _buildUDTfqns();
+        _finalizeFuncShorts();
+
+        std::vector<ModulePrefix> noModules;
+        mModuleNames.swap( noModules );
+        mNames.ReleaseLookup();
+    }
+
+    unsigned int Session::ScanGlobalsProc( void* param )
+    {
+        _ASSERT( param != NULL );
+
+        GlobalsScanRange* range = (GlobalsScanRange*) param;
+
+        // DIA is a COM server
+        HRESULT hr = CoInitializeEx( NULL, COINIT_MULTITHREADED );
+        if( FAILED( hr ) )
+            return 0;
+
+        range->This->_scanGlobalRangeWithCopy( *range );
+
+        CoUninitialize();
+        return 0;
+    }
+
+    bool Session::_scanGlobalRangeWithCopy( GlobalsScanRange& range )
+    {
+        IDebugStore* store = NULL;
+
+        if( mStore->OpenCopy( store ) != S_OK )
+            return false;
+
+        range.Scan.OwnStore = true;
+        _scanGlobalRange( store, range.Start, range.Count, range.Scan );
+        range.Scanned = true;
+
+        delete store;
+        return true;
+    }
+
+    void Session::_scanGlobalRange( IDebugStore* store, uint32_t start, uint32_t count, GlobalsScan& scan )
+    {
         EnumNamedSymbolsData searchHandle;
-        if( mStore->FindFirstSymbol( SymHeap_GlobalSymbols, nullptr, 0, searchHandle) != S_OK)
+        HRESULT hr = S_OK;
+
+        if( start == 0 )
+            hr = store->FindFirstSymbol( SymHeap_GlobalSymbols, nullptr, 0, searchHandle );
+        else
+            hr = store->FindFirstSymbolAt( SymHeap_GlobalSymbols, start, searchHandle );
+        if( hr != S_OK )
             return;
 
-        do
+        for( uint32_t n = 0; n < count; n++ )
         {
             SymHandle symHandle;
             MagoST::SymInfoData symData = { 0 };
             MagoST::ISymbolInfo* symInfo = NULL;
-            if( mStore->GetCurrentSymbol( searchHandle, symHandle) != S_OK )
+            if( store->GetCurrentSymbol( searchHandle, symHandle) != S_OK )
                 break;
-            if( mStore->GetSymbolInfo( symHandle, symData, symInfo ) != S_OK )
+            if( store->GetSymbolInfo( symHandle, symData, symInfo ) != S_OK )
                 break;
 
             DataKind kind = DataIsUnknown;
@@ -666,19 +1172,15 @@ namespace MagoST
                 SymString name;
                 if (symInfo->GetName(name))
                 {
+                    StringId id = scan.Names.Intern( name.GetName(), name.GetLength() );
                     if (ends_with(name, "__debugOverview") ||
                         ends_with(name, "__debugExpanded") ||
                         ends_with(name, "__debugStringView"))
                     {
-                        std::string sname(name.GetName(), name.GetLength());
-                        auto it = mDebugFuncs.find(sname);
-                        if (it == mDebugFuncs.end())
-                            mDebugFuncs.insert({ sname, { symHandle } });
-                        else
-                            it->second.push_back(symHandle);
+                        scan.DebugFuncs.push_back( { id, symHandle } );
                     }
                     // any function can be scope of other functions or types
-                    _addFQNSymbol( false, name.GetName(), name.GetLength() );
+                    scan.FuncFqns.push_back( id );
                 }
             }
             else if ( tag == SymTagUDT || tag == SymTagEnum )
@@ -686,7 +1188,7 @@ namespace MagoST
                 SymString name;
                 if ( symInfo->GetName( name ) ) // && strncmp( name.GetName(), "CAPTURE.", 8 ) != 0 )
                 {
-                    _addFQNSymbol( true, name.GetName(), name.GetLength() );
+                    scan.UDTFqns.push_back( scan.Names.Intern( name.GetName(), name.GetLength() ) );
                 }
             }
             else if( symInfo->GetDataKind( kind ) )
@@ -701,129 +1203,229 @@ namespace MagoST
                         SymString name;
                         if( symInfo->GetName( name ) )
                         {
-                            mGlobals.insert( std::string( name.GetName(), name.GetLength() ) );
+                            scan.Globals.push_back( scan.Names.Intern( name.GetName(), name.GetLength() ) );
                         }
                         break;
                     }
                 }
             }
-        } while ( mStore->FindNextSymbol( searchHandle ) == S_OK );
 
-        mStore->FindSymbolDone(searchHandle);
+            if( store->FindNextSymbol( searchHandle ) != S_OK )
+                break;
+        }
 
-        _finalizeUDTshorts();
-        _buildUDTfqns();
-        _finalizeFuncShorts();
+        store->FindSymbolDone(searchHandle);
+    }
+
+    void Session::_mergeGlobals( const GlobalsScan& scan )
+    {
+        const StringPool& names = scan.Names;
+
+        for( auto id : scan.Globals )
+            mGlobals.push_back( mNames.Intern( names.GetChars( id ), names.GetLength( id ) ) );
+
+        for( auto& func : scan.DebugFuncs )
+        {
+            if( scan.OwnStore )
+            {
+                // there are only a few, and only the first of a name finds them all
+                std::string name = names.GetString( func.first );
+                if( mDebugFuncs.find( name ) == mDebugFuncs.end() )
+                    _findDebugFuncs( name );
+            }
+            else
+                mDebugFuncs[names.GetString( func.first )].push_back( func.second );
+        }
+
+        for( auto id : scan.FuncFqns )
+            _addFQNSymbol( false, names.GetChars( id ), names.GetLength( id ) );
+
+        for( auto id : scan.UDTFqns )
+            _addFQNSymbol( true, names.GetChars( id ), names.GetLength( id ) );
+    }
+
+    void Session::_findDebugFuncs( const std::string& name )
+    {
+        EnumNamedSymbolsData searchHandle;
+        if( mStore->FindFirstSymbol( SymHeap_GlobalSymbols, name.data(), name.size(), searchHandle ) != S_OK )
+            return;
+
+        do
+        {
+            SymHandle symHandle;
+            MagoST::SymInfoData symData = { 0 };
+            MagoST::ISymbolInfo* symInfo = NULL;
+            if( mStore->GetCurrentSymbol( searchHandle, symHandle ) != S_OK )
+                break;
+            if( mStore->GetSymbolInfo( symHandle, symData, symInfo ) != S_OK )
+                break;
+
+            SymTag tag = symInfo->GetSymTag();
+            if ( tag == SymTagFunction || tag == SymTagMethod )
+                mDebugFuncs[name].push_back( symHandle );
+        } while ( mStore->FindNextSymbol( searchHandle ) == S_OK );
+
+        mStore->FindSymbolDone( searchHandle );
     }
 
     void Session::_addFQNSymbol( bool udt, const char* symbol, size_t len )
     {
         auto& shorts = udt ? mUDTshorts : mFuncShorts;
-        shorts.insert( { std::string( symbol, len ), {} } );
+        StringId id = mNames.Intern( symbol, len );
+        shorts.push_back( { id, StringPool::EmptyId } );
 
         int pos = getLastDotPos( symbol, len );
         if ( pos > 0 )
-        {
+            mModuleNames.push_back( { id, (uint32_t) pos } );
+    }
+
+    void Session::_sortNames()
+    {
+        const StringPool& names = mNames;
 
-            std::string mod( symbol, pos );
-            if( !mModuleNames.empty() )
+        std::sort( mGlobals.begin(), mGlobals.end(), [&names]( StringId id1, StringId id2 )
             {
-                auto it = std::lower_bound( mModuleNames.begin(), mModuleNames.end(), mod );
-                if ( it != mModuleNames.end() && *it == mod )
-                    return; // already in mModuleNames
-                if ( it != mModuleNames.begin() )
-                {
-                    auto before = it;
-                    auto& m = *(--before);
-                    if( m.compare( 0, m.length(), mod, 0, m.length() ) == 0 )
-                        return; // shorter modname found
-                }
-                while( it != mModuleNames.end() )
-                {
-                    auto& m = *it;
-                    if ( mod.compare( 0, mod.length(), m, 0, mod.length()) != 0 )
-                        break;
-                    it = mModuleNames.erase( it ); // remove longer modname
-                }
+                return reverseLess( names.GetChars( id1 ), names.GetLength( id1 ), 
+                                    names.GetChars( id2 ), names.GetLength( id2 ) );
+            });
+        mGlobals.erase( std::unique( mGlobals.begin(), mGlobals.end() ), mGlobals.end() );
+
+        auto lessFqn = [&names]( const ShortName& n1, const ShortName& n2 )
+            {
+                return names.Compare( n1.Fqn, n2.Fqn ) < 0;
+            };
+        auto sameFqn = []( const ShortName& n1, const ShortName& n2 )
+            {
+                return n1.Fqn == n2.Fqn;
+            };
+        std::sort( mFuncShorts.begin(), mFuncShorts.end(), lessFqn );
+        mFuncShorts.erase( std::unique( mFuncShorts.begin(), mFuncShorts.end(), sameFqn ), mFuncShorts.end() );
+        std::sort( mUDTshorts.begin(), mUDTshorts.end(), lessFqn );
+        mUDTshorts.erase( std::unique( mUDTshorts.begin(), mUDTshorts.end(), sameFqn ), mUDTshorts.end() );
+
+        // only keep the shortest module names, longer ones are inside of them
+        std::sort( mModuleNames.begin(), mModuleNames.end(), [&names]( const ModulePrefix& m1, const ModulePrefix& m2 )
+            {
+                size_t len = std::min( m1.Length, m2.Length );
+                int ret = memcmp( names.GetChars( m1.Fqn ), names.GetChars( m2.Fqn ), len );
+                return ret < 0 || (ret == 0 && m1.Length < m2.Length);
+            });
+
+        size_t moduleCount = 0;
+        for( size_t i = 0; i < mModuleNames.size(); i++ )
+        {
+            if( moduleCount > 0 )
+            {
+                auto& m = mModuleNames[moduleCount - 1];
+                if( memcmp( names.GetChars( m.Fqn ), names.GetChars( mModuleNames[i].Fqn ), m.Length ) == 0 )
+                    continue; // shorter modname found
             }
-            mModuleNames.insert( mod );
+            mModuleNames[moduleCount++] = mModuleNames[i];
         }
+        mModuleNames.resize( moduleCount );
     }
 
     void Session::_finalizeUDTshorts()
     {
-        auto prev = mUDTshorts.begin();
-        for( auto it = mUDTshorts.begin(); it != mUDTshorts.end(); ++it )
+        size_t prev = 0;
+        for( size_t i = 0; i < mUDTshorts.size(); i++ )
         {
-            while( it->first.size() > prev->first.size() &&
-                   it->first.compare( 0, prev->first.size(), prev->first ) == 0 &&
-                   it->first[prev->first.size()] == '.' )
+            const char* prevName = mNames.GetChars( mUDTshorts[prev].Fqn );
+            uint32_t prevLen = mNames.GetLength( mUDTshorts[prev].Fqn );
+
+            for( ; ; )
             {
+                const char* name = mNames.GetChars( mUDTshorts[i].Fqn );
+                uint32_t len = mNames.GetLength( mUDTshorts[i].Fqn );
+
+                if( len <= prevLen || memcmp( name, prevName, prevLen ) != 0 || name[prevLen] != '.' )
+                    break;
+
                 // an enclosing type adds its name to the sub type short name
-                std::string shortName = getShortName( it->first.data(), it->first.size() );
-                it->second = prev->second + "." + shortName;
-                ++it;
-                if ( it == mUDTshorts.end() )
+                std::string shortName = getShortName( name, len );
+                mUDTshorts[i].Short = mNames.Intern( mNames.GetString( mUDTshorts[prev].Short ) + "." + shortName );
+                ++i;
+                if ( i == mUDTshorts.size() )
                     return;
             }
-            prev = it;
-            std::string shortName = getShortName( prev->first.data(), prev->first.size() );
-            prev->second = shortName.empty() ? prev->first : shortName;
+            prev = i;
+            StringId fqn = mUDTshorts[prev].Fqn;
+            std::string shortName = getShortName( mNames.GetChars( fqn ), mNames.GetLength( fqn ) );
+            mUDTshorts[prev].Short = shortName.empty() ? fqn : mNames.Intern( shortName );
         }
     }
 
     void Session::_buildUDTfqns()
     {
-        for( auto it = mUDTshorts.begin(); it != mUDTshorts.end(); ++it )
-        {
-            auto fqnit = mUDTfqns.insert({ &(it->second), {} });
-            fqnit.first->second.push_back(&(it->first));
-        }
+        const StringPool& names = mNames;
+
+        // equal short names are interned to the same ID, FQNs stay in order
+        mUDTfqns = mUDTshorts;
+        std::stable_sort( mUDTfqns.begin(), mUDTfqns.end(), [&names]( const ShortName& n1, const ShortName& n2 )
+            {
+                return names.Compare( n1.Short, n2.Short ) < 0;
+            });
     }
 
     void Session::_finalizeFuncShorts()
     {
-        auto funcit = mFuncShorts.begin();
+        size_t funcIx = 0;
         for ( auto modit = mModuleNames.begin(); modit != mModuleNames.end(); ++modit )
         {
-            while ( funcit != mFuncShorts.end() && funcit->first < *modit )
+            const char* mod = mNames.GetChars( modit->Fqn );
+
+            while ( funcIx < mFuncShorts.size() && mNames.Compare( mFuncShorts[funcIx].Fqn, mod, modit->Length ) < 0 )
             {
-                std::string shortName = stripOneMember( funcit->first.data(), funcit->first.size() );
-                funcit->second = shortName.empty() ? funcit->first : shortName;
-                ++funcit;
+                StringId fqn = mFuncShorts[funcIx].Fqn;
+                std::string shortName = stripOneMember( mNames.GetChars( fqn ), mNames.GetLength( fqn ) );
+                mFuncShorts[funcIx].Short = shortName.empty() ? fqn : mNames.Intern( shortName );
+                ++funcIx;
             }
-            while ( funcit != mFuncShorts.end() &&
-                funcit->first.size() > modit->size() &&
-                funcit->first.compare( 0, modit->size(), *modit ) == 0 )
+            while ( funcIx < mFuncShorts.size() )
             {
-                auto relName = funcit->first.substr( modit->size() );
-                auto stripped = stripOneMember( relName.data(), relName.size() );
-                funcit->second = stripped.empty() ? relName : stripped;
-                ++funcit;
+                StringId fqn = mFuncShorts[funcIx].Fqn;
+                const char* name = mNames.GetChars( fqn );
+                uint32_t len = mNames.GetLength( fqn );
+
+                if ( len <= modit->Length || memcmp( name, mod, modit->Length ) != 0 )
+                    break;
+
+                const char* relName = name + modit->Length;
+                size_t relLen = len - modit->Length;
+                auto stripped = stripOneMember( relName, relLen );
+                mFuncShorts[funcIx].Short = stripped.empty() ? mNames.Intern( relName, relLen ) : mNames.Intern( stripped );
+                ++funcIx;
             }
         }
     }
 
-    HRESULT Session::_findMatchingGlobals( std::set<std::string, reverse_less>& symSet,
+    HRESULT Session::_findMatchingGlobals( const std::vector<StringId>& symSet,
         const char* nameChars, size_t nameLen, std::vector<SymHandle>& handles )
     {
         _cacheGlobals();
         
-        std::string search( nameChars, nameLen );
-        for( auto it = symSet.lower_bound( search ); it != symSet.end(); ++it )
+        const StringPool& names = mNames;
+        auto it = std::lower_bound( symSet.begin(), symSet.end(), nameChars, [&names, nameLen]( StringId id, const char* search )
+            {
+                return reverseLess( names.GetChars( id ), names.GetLength( id ), search, nameLen );
+            });
+        for( ; it != symSet.end(); ++it )
         {
-            if ( it->length() < nameLen || search != it->data() + it->length() - nameLen )
+            const char* name = mNames.GetChars( *it );
+            size_t len = mNames.GetLength( *it );
+
+            if ( len < nameLen || memcmp( nameChars, name + len - nameLen, nameLen ) != 0 )
                 break;
-            if ( it->length() == nameLen ) // skip name without '.'
+            if ( len == nameLen ) // skip name without '.'
                 continue;
-            if ( (*it)[it->length() - nameLen - 1] != '.' )
+            if ( name[len - nameLen - 1] != '.' )
                 break;
 
             MagoST::SymInfoData infoData = { 0 };
             MagoST::ISymbolInfo* symInfo = NULL;
             SymHandle handle;
 
-            HRESULT hr = _findGlobalSymbol( it->data(), nullptr, handle, infoData, symInfo );
+            HRESULT hr = _findGlobalSymbol( name, nullptr, handle, infoData, symInfo );
             if( SUCCEEDED( hr ) )
                 handles.push_back( handle );
         }
@@ -856,32 +1458,63 @@ namespace MagoST
     {
         _cacheGlobals();
 
-        std::string search(nameChars, nameLen);
-        for (auto it = mFuncShorts.lower_bound(search); it != mFuncShorts.end(); ++it)
+        const StringPool& names = mNames;
+        auto it = std::lower_bound( mFuncShorts.begin(), mFuncShorts.end(), nameChars, [&names, nameLen]( const ShortName& n, const char* search )
+            {
+                return names.Compare( n.Fqn, search, nameLen ) < 0;
+            });
+        for (; it != mFuncShorts.end(); ++it)
         {
-            if (it->first.length() < nameLen || search.compare(0, nameLen, it->first, 0, nameLen) != 0)
+            const char* name = mNames.GetChars(it->Fqn);
+            size_t len = mNames.GetLength(it->Fqn);
+
+            if (len < nameLen || memcmp(nameChars, name, nameLen) != 0)
                 break;
-            if (it->first.length() > nameLen && it->first[nameLen] != '.')
+            if (len > nameLen && name[nameLen] != '.')
                 break;
-            if (it->first.length() > nameLen)
-                funcs.push_back(it->first);
+            if (len > nameLen)
+                funcs.push_back(std::string(name, len));
         }
         return funcs.empty() ? E_NOT_FOUND : S_OK;
     }
 
+    const Session::ShortName* Session::_findShortName( const std::vector<ShortName>& shorts, const char* nameChars, size_t nameLen )
+    {
+        const StringPool& names = mNames;
+        auto it = std::lower_bound( shorts.begin(), shorts.end(), nameChars, [&names, nameLen]( const ShortName& n, const char* search )
+            {
+                return names.Compare( n.Fqn, search, nameLen ) < 0;
+            });
+        if( it == shorts.end() || names.Compare( it->Fqn, nameChars, nameLen ) != 0 )
+            return NULL;
+        return &*it;
+    }
+
+    std::pair<size_t, size_t> Session::_findUDTfqns( const char* nameChars, size_t nameLen )
+    {
+        const StringPool& names = mNames;
+        auto first = std::lower_bound( mUDTfqns.begin(), mUDTfqns.end(), nameChars, [&names, nameLen]( const ShortName& n, const char* search )
+            {
+                return names.Compare( n.Short, search, nameLen ) < 0;
+            });
+        auto last = first;
+        while( last != mUDTfqns.end() && names.Compare( last->Short, nameChars, nameLen ) == 0 )
+            ++last;
+        return { first - mUDTfqns.begin(), last - mUDTfqns.begin() };
+    }
+
     HRESULT Session::FindUDTShortName( const char* nameChars, size_t nameLen, std::string& shortName )
     {
         _cacheGlobals();
 
-        std::string search( nameChars, nameLen );
-        auto it = mUDTshorts.find( search );
-        if( it == mUDTshorts.end() )
+        auto name = _findShortName( mUDTshorts, nameChars, nameLen );
+        if( name == NULL )
             return E_NOT_FOUND;
-        auto itfqn = mUDTfqns.find( &it->second );
-        _ASSERT( itfqn != mUDTfqns.end() );
-        if( itfqn->second.size() > 1 )
+        auto fqns = _findUDTfqns( mNames.GetChars( name->Short ), mNames.GetLength( name->Short ) );
+        _ASSERT( fqns.second > fqns.first );
+        if( fqns.second - fqns.first > 1 )
             return E_FAIL;
-        shortName = it->second;
+        shortName = mNames.GetString( name->Short );
         return S_OK;
     }
 
@@ -889,11 +1522,10 @@ namespace MagoST
     {
         _cacheGlobals();
 
-        std::string search( nameChars, nameLen );
-        auto it = mUDTfqns.find( &search );
-        if( it == mUDTfqns.end() || it->second.size() != 1 )
+        auto fqns = _findUDTfqns( nameChars, nameLen );
+        if( fqns.second - fqns.first != 1 )
             return E_NOT_FOUND;
-        longName = *(it->second[0]);
+        longName = mNames.GetString( mUDTfqns[fqns.first].Fqn );
         return S_OK;
     }
 
@@ -901,11 +1533,10 @@ namespace MagoST
     {
         _cacheGlobals();
 
-        std::string search( nameChars, nameLen );
-        auto it = mFuncShorts.find( search );
-        if( it == mFuncShorts.end() || it->second.empty() )
+        auto name = _findShortName( mFuncShorts, nameChars, nameLen );
+        if( name == NULL || name->Short == StringPool::EmptyId )
             return E_NOT_FOUND;
-        shortName = it->second;
+        shortName = mNames.GetString( name->Short );
         return S_OK;
     }
 
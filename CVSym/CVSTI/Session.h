@@ -8,8 +8,9 @@
 #pragma once
 
 #include "ISession.h"
+#include "StringPool.h"
+#include "AddrCache.h"
 
-#include <set>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -30,35 +31,133 @@ namespace MagoST
         RefPtr<DataSource>  mDataSource;
         IDebugStore*        mStore;         // valid while we hold onto data source
         RefPtr<IAddressMap> mAddrMap;
-        std::unordered_map<uint64_t, std::pair<SymHandle, DWORD>> mAddrSymbolMap;
+
+        // address lookups are shared by stack frames, disassembly, and expressions
+        struct OuterSymbol
+        {
+            SymHandle   Handle;
+            DWORD       SymOff;
+        };
+        struct AddrSymbol
+        {
+            uint64_t    Va;
+            HRESULT     Result;
+            SymHandle   Handle;
+            uint16_t    Sec;
+            uint32_t    Offset;
+            uint32_t    SymOff;
+            bool        NameCached;
+            std::string Name;
+        };
+        AddrCache<OuterSymbol> mOuterSymbols; // (heap, segment, offset) -> symbol
+        AddrCache<AddrSymbol> mAddrSymbols; // (VA, exact) -> symbol
 
         struct reverse_less
         {
             bool operator() (const std::string& s1, const std::string& s2) const;
         };
-        std::set<std::string, reverse_less> mGlobals;
         std::map<std::string, std::vector<SymHandle>, reverse_less> mDebugFuncs;
 
-        std::set<std::string> mModuleNames; // FQN with trailing dot
-        std::map<std::string, std::string> mFuncShorts; // FQN -> short name
-        std::map<std::string, std::string> mUDTshorts; // FQN -> short name
-        // short name -> FQNs, values in mUDTshorts
-        struct less_string_ptr {
-            bool operator()(const std::string* s1, const std::string* s2) const { return *s1 < *s2; }
+        // the names below are interned once in mNames, the indexes are sorted arrays of IDs
+        struct ShortName
+        {
+            StringId    Fqn;
+            StringId    Short;
+        };
+        struct ModulePrefix
+        {
+            StringId    Fqn;        // symbol that the module name was taken from
+            uint32_t    Length;     // including the trailing dot
+        };
+        StringPool mNames;
+        std::vector<StringId> mGlobals; // sorted by reverse_less
+        std::vector<ModulePrefix> mModuleNames; // FQN with trailing dot, only while scanning
+        std::vector<ShortName> mFuncShorts; // sorted by FQN
+        std::vector<ShortName> mUDTshorts; // sorted by FQN
+        std::vector<ShortName> mUDTfqns; // mUDTshorts sorted by short name
+        volatile bool mGlobalsCached;
+        Guard mGlobalsGuard;
+
+        // names found by one thread scanning a slice of the global symbols
+        struct GlobalsScan
+        {
+            StringPool Names;
+            std::vector<StringId> Globals;
+            std::vector<StringId> FuncFqns;
+            std::vector<StringId> UDTFqns;
+            std::vector<std::pair<StringId, SymHandle>> DebugFuncs;
+            bool OwnStore;  // scanned with a copy of mStore, whose handles aren't ours
         };
-        std::map<const std::string*, std::vector<const std::string*>, less_string_ptr> mUDTfqns;
+        struct GlobalsScanRange
+        {
+            Session*    This;
+            uint32_t    Start;
+            uint32_t    Count;
+            bool        Scanned;
+            GlobalsScan Scan;
+        };
+        static const int MaxScanThreads = 8;
+        static const uint32_t MinScanRangeSize = 20000;
+
+        // normalized file name without directory -> source files of all compilands
+        struct SourceFileRef
+        {
+            uint16_t    CompilandIndex;
+            uint16_t    FileIndex;
+            std::string Path;       // normalized full path
+        };
+        std::unordered_map<std::string, std::vector<SourceFileRef>> mSourceFiles;
+        volatile bool mSourceFilesCached;
+        Guard mSourceFilesGuard;
+
+        // members by name, built the first time a type is searched
+        struct MemberEntry
+        {
+            TypeHandle  Handle;
+            bool        Preferred;  // not a function that takes arguments
+        };
+        typedef std::unordered_map<std::string, MemberEntry> MemberTable;
+        struct TypeHandleKey
+        {
+            size_t operator() ( const TypeHandle& handle ) const;
+            bool operator() ( const TypeHandle& handle1, const TypeHandle& handle2 ) const;
+        };
+        static const int MaxBaseClassDepth = 64;
+        std::unordered_map<TypeHandle, MemberTable, TypeHandleKey, TypeHandleKey> mChildTypes;
+        std::unordered_map<TypeIndex, MemberTable> mMembers; // field list -> members, with base classes
+        Guard mMembersGuard;
 
         void _addFQNSymbol( bool udt, const char* symbol, size_t len );
         void _cacheGlobals();
+        void _scanGlobals();
+        bool _scanGlobalRangeWithCopy( GlobalsScanRange& range );
+        void _scanGlobalRange( IDebugStore* store, uint32_t start, uint32_t count, GlobalsScan& scan );
+        void _mergeGlobals( const GlobalsScan& scan );
+        void _findDebugFuncs( const std::string& name );
+        bool _loadGlobalsCache();
+        void _saveGlobalsCache();
+        void _sortNames();
         void _finalizeUDTshorts();
         void _buildUDTfqns();
         void _finalizeFuncShorts();
-
+        void _cacheSourceFiles();
+        void _scanSourceFiles();
+        HRESULT _getChildTypes( TypeHandle parentHandle, const MemberTable*& table );
+        const MemberTable* _getMembers( TypeIndex fieldListIndex, int depth );
+        bool _getBaseFieldList( TypeHandle fieldListHandle, TypeIndex& baseFieldListIndex );
+        bool _findLines( bool exactMatch, const std::string& path, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                         std::list<LineNumber>& lines );
+
+        uint64_t _findAddrSymbol( uint64_t va, bool exact, AddrSymbol& sym );
         HRESULT _findGlobalSymbol(const char* symbol, std::function<bool(TypeIndex)> fnTest,
                                   SymHandle& handle, SymInfoData& infoData, ISymbolInfo*& symInfo );
-        HRESULT _findMatchingGlobals( std::set<std::string, reverse_less>& symSet,
+        const ShortName* _findShortName( const std::vector<ShortName>& shorts, const char* nameChars, size_t nameLen );
+        std::pair<size_t, size_t> _findUDTfqns( const char* shortChars, size_t shortLen ); // range in mUDTfqns
+        HRESULT _findMatchingGlobals( const std::vector<StringId>& symSet,
             const char* nameChars, size_t nameLen, std::vector<SymHandle>& handles );
 
+        static unsigned int __stdcall ScanGlobalsProc( void* param );
+
     public:
         Session( DataSource* dataSource );
 
@@ -99,6 +198,8 @@ namespace MagoST
             size_t nameLen, 
             SymHandle& handle );
 
+        virtual HRESULT CacheGlobals();
+
         virtual HRESULT FindMatchingGlobals( const char* nameChars, size_t nameLen, std::vector<SymHandle>& handles );
         virtual HRESULT FindMatchingDebugFuncs( const char* nameChars, size_t nameLen, std::vector<SymHandle>& handles );
         virtual HRESULT FindMatchingForeachFuncs( const char* nameChars, size_t nameLen, std::vector<std::string>& handles );
@@ -108,6 +209,7 @@ namespace MagoST
         virtual HRESULT FindFuncShortName( const char* nameChars, size_t nameLen, std::string& shortName );
 
         virtual HRESULT FindGlobalSymbolByAddr( uint64_t va, bool exact, SymHandle& symHandle, uint16_t& sec, uint32_t& offset, uint32_t& symOff );
+        virtual HRESULT FindGlobalSymbolNameByAddr( uint64_t va, bool exact, std::string& name, uint32_t& symOff );
 
         virtual HRESULT FindOuterSymbolByAddr( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff );
         virtual HRESULT FindOuterSymbolByRVA( SymbolHeapId heapId, DWORD rva, SymHandle& handle );
@@ -135,6 +237,11 @@ namespace MagoST
             const char* nameChars, 
             size_t nameLen, 
             TypeHandle& handle );
+        virtual HRESULT FindMemberType( 
+            TypeIndex fieldListIndex, 
+            const char* nameChars, 
+            size_t nameLen, 
+            TypeHandle& handle );
 
         // source files
 
@@ -153,5 +260,7 @@ namespace MagoST
 
         virtual bool FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
                                 std::list<LineNumber>& lines );
+
+        virtual bool BindLines( const std::vector<FileLineRequest>& requests, std::vector<std::list<LineNumber>>& lines );
     };
 }
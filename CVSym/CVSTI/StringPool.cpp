@@ -0,0 +1,191 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "StringPool.h"
+#include <algorithm>
+
+
+namespace MagoST
+{
+    StringPool::StringPool()
+        :   mBlock( NULL ),
+            mBlockUsed( BlockSize )
+    {
+        Entry   empty = { "", 0 };
+        mEntries.push_back( empty );
+    }
+
+    StringPool::~StringPool()
+    {
+        Clear();
+    }
+
+    StringId StringPool::Intern( const std::string& str )
+    {
+        return Intern( str.data(), str.size() );
+    }
+
+    StringId StringPool::Intern( const char* str, size_t len )
+    {
+        if ( len == 0 )
+            return EmptyId;
+
+        _ASSERT( len < std::numeric_limits<uint32_t>::max() );
+
+        // keep the table at most half full
+        if ( mBuckets.size() < (mEntries.size() + 1) * 2 )
+        {
+            size_t  bucketCount = std::max<size_t>( mBuckets.size(), 1024 );
+
+            while ( bucketCount < (mEntries.size() + 1) * 2 )
+                bucketCount *= 2;
+
+            Rehash( bucketCount );
+        }
+
+        size_t  mask = mBuckets.size() - 1;
+        size_t  i = Hash( str, len ) & mask;
+
+        for ( ; mBuckets[i] != 0; i = (i + 1) & mask )
+        {
+            const Entry&    entry = mEntries[mBuckets[i] - 1];
+
+            if ( (entry.Length == len) && (memcmp( entry.Chars, str, len ) == 0) )
+                return mBuckets[i] - 1;
+        }
+
+        Entry   entry = { CopyChars( str, len ), (uint32_t) len };
+        StringId id = (StringId) mEntries.size();
+
+        mEntries.push_back( entry );
+        mBuckets[i] = id + 1;
+        return id;
+    }
+
+    const char* StringPool::GetChars( StringId id ) const
+    {
+        _ASSERT( id < mEntries.size() );
+        return mEntries[id].Chars;
+    }
+
+    uint32_t StringPool::GetLength( StringId id ) const
+    {
+        _ASSERT( id < mEntries.size() );
+        return mEntries[id].Length;
+    }
+
+    std::string StringPool::GetString( StringId id ) const
+    {
+        _ASSERT( id < mEntries.size() );
+        return std::string( mEntries[id].Chars, mEntries[id].Length );
+    }
+
+    size_t StringPool::GetCount() const
+    {
+        return mEntries.size();
+    }
+
+    int StringPool::Compare( StringId id, const char* str, size_t len ) const
+    {
+        const Entry&    entry = mEntries[id];
+        size_t          minLen = entry.Length < len ? entry.Length : len;
+        int             ret = memcmp( entry.Chars, str, minLen );
+
+        if ( ret != 0 )
+            return ret;
+        if ( entry.Length == len )
+            return 0;
+        return entry.Length < len ? -1 : 1;
+    }
+
+    int StringPool::Compare( StringId id1, StringId id2 ) const
+    {
+        if ( id1 == id2 )
+            return 0;
+        return Compare( id1, mEntries[id2].Chars, mEntries[id2].Length );
+    }
+
+    void StringPool::ReleaseLookup()
+    {
+        std::vector<StringId> empty;
+        mBuckets.swap( empty );
+    }
+
+    void StringPool::Clear()
+    {
+        for ( size_t i = 0; i < mBlocks.size(); i++ )
+            delete [] mBlocks[i];
+
+        mBlocks.clear();
+        mBlock = NULL;
+        mBlockUsed = BlockSize;
+        mEntries.resize( 1 );
+        ReleaseLookup();
+    }
+
+    const char* StringPool::CopyChars( const char* str, size_t len )
+    {
+        char*   chars = NULL;
+
+        if ( len + 1 > BlockSize / 4 )
+        {
+            // big strings get their own block, so that the current one isn't wasted
+            chars = new char[len + 1];
+            mBlocks.push_back( chars );
+        }
+        else
+        {
+            if ( BlockSize - mBlockUsed < len + 1 )
+            {
+                mBlock = new char[BlockSize];
+                mBlocks.push_back( mBlock );
+                mBlockUsed = 0;
+            }
+
+            chars = mBlock + mBlockUsed;
+            mBlockUsed += len + 1;
+        }
+
+        memcpy( chars, str, len );
+        chars[len] = '\0';
+        return chars;
+    }
+
+    void StringPool::Rehash( size_t bucketCount )
+    {
+        _ASSERT( (bucketCount & (bucketCount - 1)) == 0 );
+
+        size_t  mask = bucketCount - 1;
+
+        mBuckets.assign( bucketCount, 0 );
+
+        // the empty string is never looked up
+        for ( StringId id = 1; id < mEntries.size(); id++ )
+        {
+            size_t  i = Hash( mEntries[id].Chars, mEntries[id].Length ) & mask;
+
+            while ( mBuckets[i] != 0 )
+                i = (i + 1) & mask;
+
+            mBuckets[i] = id + 1;
+        }
+    }
+
+    uint32_t StringPool::Hash( const char* str, size_t len )
+    {
+        // FNV-1a
+        uint32_t    hash = 2166136261U;
+
+        for ( size_t i = 0; i < len; i++ )
+        {
+            hash ^= (uint8_t) str[i];
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <string>
+
+
+namespace MagoST
+{
+    typedef uint32_t StringId;
+
+
+    // Keeps one copy of each distinct string and hands out small IDs for them.
+    // The characters live in large blocks that never move, so pointers to them
+    // stay valid until the pool is cleared. Strings are zero terminated.
+
+    class StringPool
+    {
+        static const size_t     BlockSize = 64 * 1024;
+
+        struct Entry
+        {
+            const char* Chars;
+            uint32_t    Length;
+        };
+
+        std::vector<char*>      mBlocks;
+        char*                   mBlock;         // where small strings go
+        size_t                  mBlockUsed;
+        std::vector<Entry>      mEntries;
+        std::vector<StringId>   mBuckets;       // open addressing, ID + 1, 0 is free
+
+    public:
+        static const StringId   EmptyId = 0;    // always the empty string
+
+        StringPool();
+        ~StringPool();
+
+        StringId    Intern( const char* str, size_t len );
+        StringId    Intern( const std::string& str );
+
+        const char* GetChars( StringId id ) const;
+        uint32_t    GetLength( StringId id ) const;
+        std::string GetString( StringId id ) const;
+        size_t      GetCount() const;
+
+        // forward order of the characters, like std::string
+        int         Compare( StringId id, const char* str, size_t len ) const;
+        int         Compare( StringId id1, StringId id2 ) const;
+
+        // frees the table used by Intern, it's rebuilt if more strings are added
+        void        ReleaseLookup();
+        void        Clear();
+
+    private:
+        StringPool( const StringPool& );
+        StringPool& operator=( const StringPool& );
+
+        const char* CopyChars( const char* str, size_t len );
+        void        Rehash( size_t bucketCount );
+        static uint32_t Hash( const char* str, size_t len );
+    };
+}
@@ -0,0 +1,170 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// not built with the precompiled header, so that it builds outside of Windows
+#include "SymbolCache.h"
+
+
+namespace MagoST
+{
+    namespace
+    {
+        void writeU32( std::vector<uint8_t>& bytes, uint32_t value )
+        {
+            bytes.push_back( (uint8_t) value );
+            bytes.push_back( (uint8_t) (value >> 8) );
+            bytes.push_back( (uint8_t) (value >> 16) );
+            bytes.push_back( (uint8_t) (value >> 24) );
+        }
+
+        void writeString( std::vector<uint8_t>& bytes, const std::string& str )
+        {
+            writeU32( bytes, (uint32_t) str.size() );
+            bytes.insert( bytes.end(), str.begin(), str.end() );
+        }
+
+        void writeStrings( std::vector<uint8_t>& bytes, const std::vector<std::string>& strs )
+        {
+            writeU32( bytes, (uint32_t) strs.size() );
+            for ( size_t i = 0; i < strs.size(); i++ )
+                writeString( bytes, strs[i] );
+        }
+
+        void writePairs( std::vector<uint8_t>& bytes, const std::vector<SymbolCacheData::NamePair>& pairs )
+        {
+            writeU32( bytes, (uint32_t) pairs.size() );
+            for ( size_t i = 0; i < pairs.size(); i++ )
+            {
+                writeString( bytes, pairs[i].first );
+                writeString( bytes, pairs[i].second );
+            }
+        }
+
+        class Reader
+        {
+            const uint8_t*  mCur;
+            const uint8_t*  mEnd;
+
+        public:
+            Reader( const uint8_t* bytes, size_t size )
+                :   mCur( bytes ),
+                    mEnd( bytes + size )
+            {
+            }
+
+            bool ReadU32( uint32_t& value )
+            {
+                if ( mEnd - mCur < 4 )
+                    return false;
+
+                value = mCur[0] | (mCur[1] << 8) | (mCur[2] << 16) | ((uint32_t) mCur[3] << 24);
+                mCur += 4;
+                return true;
+            }
+
+            bool ReadString( std::string& str )
+            {
+                uint32_t    len = 0;
+
+                if ( !ReadU32( len ) || (uint32_t) (mEnd - mCur) < len )
+                    return false;
+
+                str.assign( (const char*) mCur, len );
+                mCur += len;
+                return true;
+            }
+
+            bool ReadCount( uint32_t& count, uint32_t minItemSize )
+            {
+                // reject counts that can't fit, before reserving for them
+                return ReadU32( count ) && (count <= (uint32_t) (mEnd - mCur) / minItemSize);
+            }
+
+            bool ReadStrings( std::vector<std::string>& strs )
+            {
+                uint32_t    count = 0;
+
+                if ( !ReadCount( count, 4 ) )
+                    return false;
+
+                strs.resize( count );
+                for ( uint32_t i = 0; i < count; i++ )
+                {
+                    if ( !ReadString( strs[i] ) )
+                        return false;
+                }
+                return true;
+            }
+
+            bool ReadPairs( std::vector<SymbolCacheData::NamePair>& pairs )
+            {
+                uint32_t    count = 0;
+
+                if ( !ReadCount( count, 8 ) )
+                    return false;
+
+                pairs.resize( count );
+                for ( uint32_t i = 0; i < count; i++ )
+                {
+                    if ( !ReadString( pairs[i].first ) || !ReadString( pairs[i].second ) )
+                        return false;
+                }
+                return true;
+            }
+
+            bool AtEnd()
+            {
+                return mCur == mEnd;
+            }
+        };
+    }
+
+
+    void SymbolCache::Write(
+        const std::string& identity,
+        const SymbolCacheData& data,
+        std::vector<uint8_t>& bytes )
+    {
+        bytes.clear();
+
+        writeU32( bytes, Magic );
+        writeU32( bytes, Version );
+        writeString( bytes, identity );
+
+        writeStrings( bytes, data.Globals );
+        writeStrings( bytes, data.DebugFuncs );
+        writePairs( bytes, data.FuncShorts );
+        writePairs( bytes, data.UDTShorts );
+    }
+
+    bool SymbolCache::Read(
+        const uint8_t* bytes,
+        size_t size,
+        const std::string& identity,
+        SymbolCacheData& data )
+    {
+        Reader      reader( bytes, size );
+        uint32_t    magic = 0;
+        uint32_t    version = 0;
+        std::string fileIdentity;
+
+        if ( !reader.ReadU32( magic ) || (magic != Magic) )
+            return false;
+        if ( !reader.ReadU32( version ) || (version != Version) )
+            return false;
+        if ( !reader.ReadString( fileIdentity ) || (fileIdentity != identity) )
+            return false;
+
+        if ( !reader.ReadStrings( data.Globals )
+            || !reader.ReadStrings( data.DebugFuncs )
+            || !reader.ReadPairs( data.FuncShorts )
+            || !reader.ReadPairs( data.UDTShorts ) )
+            return false;
+
+        return reader.AtEnd();
+    }
+}
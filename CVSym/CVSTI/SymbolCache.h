@@ -0,0 +1,58 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace MagoST
+{
+    // The name indexes that a session builds by walking all global symbols.
+    // Symbol handles point into the loaded debug info, so they aren't kept.
+
+    struct SymbolCacheData
+    {
+        typedef std::pair<std::string, std::string> NamePair;
+
+        std::vector<std::string>    Globals;
+        std::vector<std::string>    DebugFuncs;     // names of __debugOverview and friends
+        std::vector<NamePair>       FuncShorts;     // FQN -> short name
+        std::vector<NamePair>       UDTShorts;      // FQN -> short name
+    };
+
+
+    // Cache file layout, all numbers are little endian uint32:
+    //   magic, version, identity length, identity bytes
+    //   then each list in SymbolCacheData order: count, then length-prefixed strings
+    //
+    // The identity is opaque here. It holds whatever makes the debug info unique,
+    // like the PDB GUID and age, and the image path.
+    // This only deals with buffers, and needs nothing from Windows, so that it can be
+    // tested anywhere. DataSource reads and writes the files.
+
+    class SymbolCache
+    {
+    public:
+        static const uint32_t  Magic = 0x4353474D;     // "MGSC"
+        static const uint32_t  Version = 1;
+
+        static void Write(
+            const std::string& identity,
+            const SymbolCacheData& data,
+            std::vector<uint8_t>& bytes );
+
+        // fails if the buffer is truncated, has another version, or belongs to other debug info
+        static bool Read(
+            const uint8_t* bytes,
+            size_t size,
+            const std::string& identity,
+            SymbolCacheData& data );
+    };
+}
@@ -21,6 +21,7 @@
 #include <inttypes.h>
 
 // STL
+#include <algorithm>
 #include <list>
 #include <vector>
 
@@ -29,6 +30,7 @@
 
 // Magus
 #include <SmartPtr.h>
+#include <Guard.h>
 
 // This project
 #include "Error.h"
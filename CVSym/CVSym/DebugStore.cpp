@@ -30,10 +30,14 @@ namespace MagoST
             mGlobalTypesDir( NULL ),
             mCompilandCount( 0 ),
             mTLSSegment( 0 ),
-            mTextSegment( 2 )
+            mTextSegment( 2 ),
+            mLineIndexBuilt( false )
     {
         memset( mSymsDir, 0, sizeof mSymsDir );
 
+        for ( int i = 0; i < SymHeap_Count; i++ )
+            mAddrIndex[i].Built = false;
+
         C_ASSERT( sizeof( SymbolScopeIn ) == sizeof( SymbolScope ) );
         C_ASSERT( sizeof( TypeScopeIn ) == sizeof( TypeScope ) );
         C_ASSERT( sizeof( EnumNamedSymbolsDataIn ) == sizeof( EnumNamedSymbolsData ) );
@@ -582,6 +586,29 @@ namespace MagoST
         return S_OK;
     }
 
+    HRESULT DebugStore::GetSymbolCount( SymbolHeapId heapId, uint32_t& count )
+    {
+        UNREFERENCED_PARAMETER( heapId );
+        UNREFERENCED_PARAMETER( count );
+        // the symbol hash is only searched by name or address
+        return E_NOTIMPL;
+    }
+
+    HRESULT DebugStore::FindFirstSymbolAt( SymbolHeapId heapId, uint32_t index, EnumNamedSymbolsData& data )
+    {
+        UNREFERENCED_PARAMETER( heapId );
+        UNREFERENCED_PARAMETER( index );
+        UNREFERENCED_PARAMETER( data );
+        return E_NOTIMPL;
+    }
+
+    HRESULT DebugStore::OpenCopy( IDebugStore*& store )
+    {
+        UNREFERENCED_PARAMETER( store );
+        // not needed, since the symbols aren't walked in slices
+        return E_NOTIMPL;
+    }
+
     HRESULT DebugStore::FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff )
     {
         if ( heapId >= SymHeap_Max )
@@ -589,12 +616,13 @@ namespace MagoST
         if ( mSymsDir[heapId] == NULL )
             return E_FAIL;
 
-        return FindSymHashSymbol( segment, offset, mSymsDir[heapId], handle, symOff );
+        return FindSymHashSymbol( segment, offset, heapId, handle, symOff );
     }
 
-    HRESULT DebugStore::FindSymHashSymbol( WORD segment, DWORD offset, OMFDirEntry* entry, SymHandle& handle, DWORD& symOff )
+    HRESULT DebugStore::FindSymHashSymbol( WORD segment, DWORD offset, SymbolHeapId heapId, SymHandle& handle, DWORD& symOff )
     {
         SymHandleIn*    internalHandle = (SymHandleIn*) &handle;
+        OMFDirEntry*    entry = mSymsDir[heapId];
         OMFSymHash*     symHash = GetCVPtr<OMFSymHash>( entry->lfo );
 
         if ( (symHash == NULL) || (symHash->addrhash != 0xC) )
@@ -605,10 +633,26 @@ namespace MagoST
         if ( !ValidateCVPtr( tablePtr, symHash->cbHAddr ) )
             return E_FAIL;
 
-        OMFAddrTable        table( tablePtr );
+        AddrIndex&          index = mAddrIndex[heapId];
         uint32_t            symOffset = 0;
 
-        if ( !table.GetSymbolOffset( segment, offset, symOffset ) )
+        {
+            // built once and not changed after, so it's read outside the guard
+            GuardedArea guard( mAddrIndexGuard );
+
+            if ( !index.Built )
+            {
+                BuildAddrIndex( index, tablePtr );
+                index.Built = true;
+            }
+        }
+
+        if ( (segment < 1) || (segment > index.Segments.size()) )     // segments are 1-based
+            return E_FAIL;
+
+        const AddrSegment&  seg = index.Segments[segment - 1];
+
+        if ( !OMFAddrTable::FindSymbolOffset( seg.Pairs, seg.Count, offset, symOffset ) )
             return E_FAIL;
 
         BYTE*   symPtr = (BYTE*) (symHash + 1) + symOffset;
@@ -640,6 +684,61 @@ namespace MagoST
         return S_OK;
     }
 
+    void DebugStore::BuildAddrIndex( AddrIndex& index, BYTE* tablePtr )
+    {
+        OMFAddrTable    table( tablePtr );
+        WORD            numGroups = table.GetNumGroups();
+        size_t          unsortedCount = 0;
+
+        index.Segments.clear();
+        index.Sorted.clear();
+
+        if ( !ValidateCVPtr( tablePtr, 4 + (8 * numGroups) ) )
+            return;
+
+        index.Segments.resize( numGroups );
+
+        for ( WORD i = 0; i < numGroups; i++ )
+        {
+            AddrSegment&    seg = index.Segments[i];
+            DWORD           count = table.GetNumItems( i );
+
+            seg.Pairs = table.GetGroup( i );
+            seg.Count = 0;
+
+            if ( (count == 0xFFFFFFFF) || (count > 0xFFFFFFFF / sizeof( AddrPair )) )
+                continue;
+            if ( !ValidateCVPtr( (void*) seg.Pairs, (DWORD) (count * sizeof( AddrPair )) ) )
+                continue;
+
+            seg.Count = count;
+
+            if ( !OMFAddrTable::IsSorted( seg.Pairs, count ) )
+                unsortedCount += count;
+        }
+
+        if ( unsortedCount == 0 )
+            return;
+
+        // all copies go in one vector, so reserve it up front to keep the pointers valid
+        index.Sorted.reserve( unsortedCount );
+
+        for ( WORD i = 0; i < numGroups; i++ )
+        {
+            AddrSegment&    seg = index.Segments[i];
+
+            if ( OMFAddrTable::IsSorted( seg.Pairs, seg.Count ) )
+                continue;
+
+            size_t  start = index.Sorted.size();
+
+            index.Sorted.insert( index.Sorted.end(), seg.Pairs, seg.Pairs + seg.Count );
+            OMFAddrTable::SortByOffset( index.Sorted.data() + start, seg.Count );
+
+            seg.Pairs = index.Sorted.data() + start;
+        }
+    }
+
     bool DebugStore::IsTLSData( SymHandleIn& internalHandle )
     {
         uint16_t        segment;
@@ -1566,146 +1665,193 @@ namespace MagoST
                 if ( !matches )
                     continue;
 
-                MagoST::LineNumber  line = { 0 };
-                if ( !FindLineByNum( compIx, fileIx, (uint16_t) reqLineStart, line ) )
-                    continue;
-
-                // do the line ranges overlap?
-                if ( ((line.Number <= reqLineEnd) && (line.NumberEnd >= reqLineStart)) )
-                {
-                    do
-                    {
-                        lines.push_back (line);
-                    }
-                    while( FindNextLineByNum( compIx, fileIx, (uint16_t) reqLineStart, line ) );
-                }
+                FindFileLines( compIx, fileIx, reqLineStart, reqLineEnd, lines );
             }
         }
         return lines.size() > 0;
     }
 
-    bool DebugStore::FindCompilandFileSegmentByOffset( WORD seg, DWORD offset, uint16_t& compIndex, uint16_t& fileIndex, FileSegmentInfo& fileSegInfo )
+    bool DebugStore::FindFileLines( uint16_t compIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                    std::list<LineNumber>& lines )
     {
-        uint32_t    compCount = 0;
+        const std::vector<LineNumber>&  table = GetFileLineTable( compIndex, fileIndex );
 
-        GetCompilandCount( compCount );
+        // the first line at or after the start of the requested range
+        auto it = std::lower_bound( table.begin(), table.end(), reqLineStart, 
+            []( const LineNumber& line, uint16_t number )
+            {
+                return line.Number < number;
+            } );
 
-        for ( uint16_t zCompIx = 0; zCompIx < compCount; zCompIx++ )
+        // no code at or after the start, but the last line can still cover it
+        if ( (it == table.end()) && !table.empty() )
         {
-            // no source, no files
-            if ( mCompilandDetails[ zCompIx ].SourceEntry == NULL )
-                continue;
+            it = std::lower_bound( table.begin(), table.end(), table.back().Number, 
+                []( const LineNumber& line, uint16_t number )
+                {
+                    return line.Number < number;
+                } );
+        }
 
-            OMFDirEntry*        entry = &mDirs[zCompIx];
-            OMFModule*          mod = GetCVPtr<OMFModule>( entry->lfo );
-            OMFSegDesc*         segDescTable = NULL;
+        if ( it == table.end() )
+            return false;
 
-            if ( mod == NULL )
-                continue;
+        size_t      count = lines.size();
+        uint16_t    number = it->Number;
+
+        // all code for that line, in any segment instance
+        for ( ; (it != table.end()) && (it->Number == number); ++it )
+        {
+            // do the line ranges overlap?
+            if ( (it->Number <= reqLineEnd) && (it->NumberEnd >= reqLineStart) )
+                lines.push_back( *it );
+        }
+
+        return lines.size() > count;
+    }
+
+    const std::vector<LineNumber>& DebugStore::GetFileLineTable( uint16_t compIndex, uint16_t fileIndex )
+    {
+        uint32_t                key = ((uint32_t) compIndex << 16) | fileIndex;
+
+        {
+            GuardedArea             guard( mFileLinesGuard );
+            FileLineMap::iterator   it = mFileLines.find( key );
+
+            // tables in the map are complete and don't change, and map nodes don't move
+            if ( it != mFileLines.end() )
+                return it->second;
+        }
 
-            segDescTable = (OMFSegDesc*) (mod + 1);
+        std::vector<LineNumber>     table;
+        FileSegmentInfo             segInfo = { 0 };
 
-            for ( uint16_t modSegIx = 0; modSegIx < mod->cSeg; modSegIx++ )
+        for ( uint16_t segIx = 0; GetFileSegment( compIndex, fileIndex, segIx, segInfo ); segIx++ )
+        {
+            for ( uint16_t lineIx = 0; lineIx < segInfo.LineCount; lineIx++ )
             {
-                if ( (segDescTable[modSegIx].Seg == seg) 
-                    && (offset >= segDescTable[modSegIx].Off)
-                    && ((offset - segDescTable[modSegIx].Off + 1) <= segDescTable[modSegIx].cbSeg) )
-                {
-                    if ( FindFileSegment( seg, offset, zCompIx + 1, fileIndex, fileSegInfo ) )
-                    {
-                        compIndex = zCompIx + 1;
-                        return true;
-                    }
-                    break;
-                }
+                LineNumber  line = { 0 };
+
+                SetLineNumberFromSegment( compIndex, fileIndex, segInfo, lineIx, line );
+                table.push_back( line );
             }
         }
 
-        return false;
+        // stable, so that the same line keeps the order of segment instances and offsets
+        std::stable_sort( table.begin(), table.end(), 
+            []( const LineNumber& a, const LineNumber& b )
+            {
+                return a.Number < b.Number;
+            } );
+
+        GuardedArea guard( mFileLinesGuard );
+
+        // if another thread added the same table meanwhile, keep that one
+        auto    inserted = mFileLines.insert( FileLineMap::value_type( key, std::vector<LineNumber>() ) );
+
+        if ( inserted.second )
+            inserted.first->second.swap( table );
+
+        return inserted.first->second;
     }
 
-    bool    DebugStore::FindFileSegment( WORD seg, DWORD offset, uint16_t compIndex, uint16_t& fileIndex, FileSegmentInfo& fileSegInfo )
+    bool DebugStore::FindCompilandFileSegmentByOffset( WORD seg, DWORD offset, uint16_t& compIndex, uint16_t& fileIndex, FileSegmentInfo& fileSegInfo )
     {
-        if ( (compIndex < 1) || (compIndex > mCompilandCount) )
+        {
+            // built once and not changed after, so it's read outside the guard
+            GuardedArea guard( mLineIndexGuard );
+
+            if ( !mLineIndexBuilt )
+                BuildLineIndex();
+        }
+
+        const LineRangeIndex::Range*    found = mLineIndex.Find( seg, offset );
+
+        if ( found == NULL )
+            return false;
+
+        if ( !GetFileSegment( found->CompIndex, found->FileIndex, found->SegInstance, fileSegInfo ) )
             return false;
 
+        compIndex = found->CompIndex;
+        fileIndex = found->FileIndex;
+        return true;
+    }
+
+    void DebugStore::BuildLineIndex()
+    {
+        mLineIndex.Clear();
+
+        for ( uint16_t compIx = 1; compIx <= mCompilandCount; compIx++ )
+            AddLineRanges( compIx );
+
+        mLineIndex.Sort();
+
+        mLineIndexBuilt = true;
+    }
+
+    void DebugStore::AddLineRanges( uint16_t compIndex )
+    {
         const uint16_t      zCompIx = compIndex - 1;
+        OMFDirEntry*        entry = &mDirs[zCompIx];
+        OMFModule*          mod = GetCVPtr<OMFModule>( entry->lfo );
         OMFSourceModule*    srcMod = NULL;
 
+        // no source, no files
         if ( mCompilandDetails[zCompIx].SourceEntry != NULL )
             srcMod = GetCVPtr<OMFSourceModule>( mCompilandDetails[zCompIx].SourceEntry->lfo );
 
-        if ( srcMod == NULL )
-            return false;
+        if ( (mod == NULL) || (srcMod == NULL) )
+            return;
 
+        OMFSegDesc* segDescTable = (OMFSegDesc*) (mod + 1);
         DWORD*      filePtrTable = (DWORD*) (((BYTE*) srcMod) + 4);
-        OffsetPair* offsetTable = (OffsetPair*) (filePtrTable + srcMod->cFile);
-        WORD*       segTable = (WORD*) (offsetTable + srcMod->cSeg);
 
-        for ( uint16_t zModSegIx = 0; zModSegIx < srcMod->cSeg; zModSegIx++ )
+        for ( uint16_t zFileIx = 0; zFileIx < srcMod->cFile; zFileIx++ )
         {
-            if ( segTable[zModSegIx] != seg )
-                continue;
+            OMFSourceFile*  file = (OMFSourceFile*) ((BYTE*) srcMod + filePtrTable[zFileIx]);
+            DWORD*          srcLinePtrTable = (DWORD*) ((BYTE*) file + 4);
+            OffsetPair*     startEndTable = (OffsetPair*) (srcLinePtrTable + file->cSeg);
 
-            if ( ((offsetTable[zModSegIx].first == 0) && (offsetTable[zModSegIx].second == 0))
-                || ((offset >= offsetTable[zModSegIx].first) && (offset <= offsetTable[zModSegIx].second)) )
+            for ( uint16_t zSegIx = 0; zSegIx < file->cSeg; zSegIx++ )
             {
-                for ( uint16_t zFileIx = 0; zFileIx < srcMod->cFile; zFileIx++ )
-                {
-                    OMFSourceFile*  file = (OMFSourceFile*) ((BYTE*) srcMod + filePtrTable[zFileIx]);
+                OMFSourceLine*  line = (OMFSourceLine*) ((BYTE*) srcMod + srcLinePtrTable[zSegIx]);
+                DWORD*          offsetTable = (DWORD*) ((BYTE*) line + 4);
+                LineRangeIndex::Range   range = { 0 };
 
-                    if ( FindFileSegment( seg, offset, srcMod, file, fileSegInfo ) )
-                    {
-                        fileIndex = zFileIx;
-                        return true;
-                    }
-                }
-            }
-            break;
-        }
-
-        return false;
-    }
-
-    bool DebugStore::FindFileSegment( 
-        WORD seg, 
-        DWORD offset, 
-        OMFSourceModule* srcMod, 
-        OMFSourceFile* file, 
-        FileSegmentInfo& fileSegInfo )
-    {
-        DWORD*          srcLinePtrTable = (DWORD*) ((BYTE*) file + 4);
-        OffsetPair*     startEndTable = (OffsetPair*) (srcLinePtrTable + file->cSeg);
+                if ( line->cLnOff == 0 )
+                    continue;
 
-        for ( uint16_t zSegIx = 0; zSegIx < file->cSeg; zSegIx++ )
-        {
-            OMFSourceLine*  line = (OMFSourceLine*) ((BYTE*) srcMod + srcLinePtrTable[zSegIx]);
+                range.Seg = line->Seg;
+                range.CompIndex = compIndex;
+                range.FileIndex = zFileIx;
+                range.SegInstance = zSegIx;
+                range.Start = startEndTable[zSegIx].first;
+                range.End = startEndTable[zSegIx].second;
 
-            if ( line->Seg != seg )
-                continue;
+                if ( (range.Start == 0) && (range.End == 0) )
+                {
+                    // no range given, so it covers each of the compiland's parts of 
+                    // the section, of which there can be many with COMDATs
+                    for ( uint16_t modSegIx = 0; modSegIx < mod->cSeg; modSegIx++ )
+                    {
+                        if ( (segDescTable[modSegIx].Seg != range.Seg) || (segDescTable[modSegIx].cbSeg == 0) )
+                            continue;
 
-            DWORD*  offsetTable = (DWORD*) ((BYTE*) line + 4);
-            WORD*   numberTable = (WORD*) (offsetTable + line->cLnOff);
+                        range.Start = segDescTable[modSegIx].Off;
+                        range.End = segDescTable[modSegIx].Off + segDescTable[modSegIx].cbSeg - 1;
 
-            DWORD end = startEndTable[zSegIx].second;
-            FixEndOffset( offsetTable[line->cLnOff - 1], end );
+                        mLineIndex.Add( range );
+                    }
+                }
+                else
+                {
+                    FixEndOffset( offsetTable[line->cLnOff - 1], range.End );
 
-            if ( ((startEndTable[zSegIx].first == 0) && (startEndTable[zSegIx].second == 0))
-                || ((startEndTable[zSegIx].first <= offset) && (end >= offset)) )
-            {
-                fileSegInfo.SegmentIndex = line->Seg;
-                fileSegInfo.SegmentInstance = zSegIx;
-                fileSegInfo.Start = startEndTable[zSegIx].first;
-                fileSegInfo.End = end;
-                fileSegInfo.LineCount = line->cLnOff;
-                fileSegInfo.LineNumbers = numberTable;
-                fileSegInfo.Offsets = offsetTable;
-                return true;
+                    mLineIndex.Add( range );
+                }
             }
-            // don't leave yet, because the addr might be in another file/segment instance
         }
-
-        return false;
     }
 
     HRESULT DebugStore::GetSymbolBytePtr( SymHandle handle, BYTE* bytes, DWORD& size )
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <map>
+#include "LineRangeIndex.h"
 
 struct OMFDirEntry;
 struct OMFDirHeader;
@@ -42,6 +44,15 @@ namespace MagoST
         virtual HRESULT GetCurrentSymbol( const EnumNamedSymbolsData& searchHandle, SymHandle& handle ) = 0;
         virtual HRESULT FindSymbolDone( EnumNamedSymbolsData& handle ) = 0;
 
+        // all the symbols of a heap can be walked in slices, for example on separate threads;
+        // continue with FindNextSymbol
+        virtual HRESULT GetSymbolCount( SymbolHeapId heapId, uint32_t& count ) = 0;
+        virtual HRESULT FindFirstSymbolAt( SymbolHeapId heapId, uint32_t index, EnumNamedSymbolsData& data ) = 0;
+
+        // Opens another store on the same debug info, for using on another thread.
+        // Its symbol handles are its own. The caller deletes it before this store.
+        virtual HRESULT OpenCopy( IDebugStore*& store ) = 0;
+
         virtual HRESULT FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff ) = 0;
 
         virtual HRESULT GetSymbolInfo( SymHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo ) = 0;
@@ -75,6 +86,8 @@ namespace MagoST
 
         virtual bool    FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
                                    std::list<LineNumber>& lines ) = 0;
+        virtual bool    FindFileLines( uint16_t compIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                       std::list<LineNumber>& lines ) = 0;
     };
 
     class DebugStore : public IDebugStore
@@ -122,6 +135,37 @@ namespace MagoST
         uint16_t mTextSegment;
         std::vector<bool> mMarkOffsets;
 
+        // built on first use under the guard, and not changed after that
+        bool                    mLineIndexBuilt;
+        LineRangeIndex          mLineIndex;
+        Guard                   mLineIndexGuard;
+
+        // (compiland << 16 | file) -> lines of all segment instances, sorted by line number;
+        // a table is only added once it's complete
+        typedef std::map<uint32_t, std::vector<LineNumber> > FileLineMap;
+        FileLineMap             mFileLines;
+        Guard                   mFileLinesGuard;
+
+        // (symbol offset, address offset) pairs of one segment in a symbol hash's address table
+        typedef std::pair<DWORD, DWORD> AddrPair;
+        struct AddrSegment
+        {
+            const AddrPair* Pairs;      // into the CV buffer, or into AddrIndex::Sorted
+            DWORD           Count;
+        };
+
+        // the address tables sorted by offset for binary search, built on first use;
+        // segments already in order aren't copied; Built is set under the guard
+        // once the rest is filled in
+        struct AddrIndex
+        {
+            bool                        Built;
+            std::vector<AddrSegment>    Segments;
+            std::vector<AddrPair>       Sorted;
+        };
+        AddrIndex               mAddrIndex[SymHeap_Count];
+        Guard                   mAddrIndexGuard;
+
     public:
         DebugStore();
         virtual ~DebugStore();
@@ -147,6 +191,10 @@ namespace MagoST
         virtual HRESULT GetCurrentSymbol( const EnumNamedSymbolsData& searchHandle, SymHandle& handle );
         virtual HRESULT FindSymbolDone( EnumNamedSymbolsData& handle );
 
+        virtual HRESULT GetSymbolCount( SymbolHeapId heapId, uint32_t& count );
+        virtual HRESULT FindFirstSymbolAt( SymbolHeapId heapId, uint32_t index, EnumNamedSymbolsData& data );
+        virtual HRESULT OpenCopy( IDebugStore*& store );
+
         virtual HRESULT FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff );
 
         virtual HRESULT GetSymbolInfo( SymHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo );
@@ -182,6 +230,8 @@ namespace MagoST
 
         virtual bool    FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
                                    std::list<LineNumber>& lines );
+        virtual bool    FindFileLines( uint16_t compIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                       std::list<LineNumber>& lines );
 
         // for debugging
         HRESULT GetSymbolBytePtr( SymHandle handle, BYTE* bytes, DWORD& size );
@@ -206,7 +256,8 @@ namespace MagoST
         HRESULT SetSymbolScopeForDirEntry( OMFDirEntry* entry, SymbolScope& scope );
 
         HRESULT FindFirstSymHashSymbol( const char* nameChars, size_t nameLen, OMFDirEntry* entry, EnumNamedSymbolsData& data );
-        HRESULT FindSymHashSymbol( WORD segment, DWORD offset, OMFDirEntry* entry, SymHandle& handle, DWORD& symOff );
+        HRESULT FindSymHashSymbol( WORD segment, DWORD offset, SymbolHeapId heapId, SymHandle& handle, DWORD& symOff );
+        void BuildAddrIndex( AddrIndex& index, BYTE* tablePtr );
 
         HRESULT GetSymbolHeapBaseForDirEntry( OMFDirEntry* entry, BYTE*& heapBase );
         HRESULT GetSymHashSymbolHeapBase( OMFDirEntry* entry, BYTE*& heapBase );
@@ -234,20 +285,10 @@ namespace MagoST
             CodeViewSymbol*& newSymbol, 
             OMFDirEntry*& newHeapDir );
 
-        bool FindFileSegment( 
-            WORD seg, 
-            DWORD offset, 
-            uint16_t compIndex, 
-            uint16_t& fileIndex, 
-            FileSegmentInfo& segInfo );
-        bool FindFileSegment( 
-            WORD seg, 
-            DWORD offset, 
-            OMFSourceModule* srcMod, 
-            OMFSourceFile* file, 
-            FileSegmentInfo& segInfo );
-
         bool FindCompilandFileSegmentByOffset( WORD seg, DWORD offset, uint16_t& compIndex, uint16_t& fileIndex, FileSegmentInfo& segInfo );
+        void BuildLineIndex();
+        void AddLineRanges( uint16_t compIndex );
+        const std::vector<LineNumber>& GetFileLineTable( uint16_t compIndex, uint16_t fileIndex );
         bool FindCompilandFileSegmentByLine( uint16_t line, uint16_t compIndex, uint16_t fileIndex, uint16_t firstSegIndex, FileSegmentInfo& segInfo );
         void SetLineNumberFromSegment( uint16_t compIx, uint16_t fileIx, const FileSegmentInfo& segInfo, uint16_t lineIndex, LineNumber& lineNumber );
 
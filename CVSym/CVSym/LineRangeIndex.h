@@ -0,0 +1,101 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+
+// The address ranges of the line number blocks of all source files, sorted by
+// section and start offset, so that the block with the line for an address can
+// be found with a binary search.
+
+class LineRangeIndex
+{
+public:
+    // a contiguous address range covered by one segment instance of a source file
+    struct Range
+    {
+        WORD        Seg;
+        uint16_t    CompIndex;
+        uint16_t    FileIndex;
+        uint16_t    SegInstance;
+        DWORD       Start;
+        DWORD       End;
+        DWORD       MaxEnd;     // highest End of this and all preceding ranges in Seg
+    };
+
+private:
+    std::vector<Range>  mRanges;
+
+    static bool LessByStart( const Range& a, const Range& b )
+    {
+        return (a.Seg < b.Seg) || ((a.Seg == b.Seg) && (a.Start < b.Start));
+    }
+
+public:
+    void Clear()
+    {
+        mRanges.clear();
+    }
+
+    // add the ranges in compiland/file/segment instance order, then sort them
+    void Add( const Range& range )
+    {
+        mRanges.push_back( range );
+    }
+
+    void Sort()
+    {
+        // stable, so that ranges with the same start keep their compiland/file order
+        std::stable_sort( mRanges.begin(), mRanges.end(), LessByStart );
+
+        for ( size_t i = 0; i < mRanges.size(); i++ )
+        {
+            Range&  range = mRanges[i];
+
+            if ( (i == 0) || (mRanges[i - 1].Seg != range.Seg) || (mRanges[i - 1].MaxEnd < range.End) )
+                range.MaxEnd = range.End;
+            else
+                range.MaxEnd = mRanges[i - 1].MaxEnd;
+        }
+    }
+
+    size_t GetCount() const
+    {
+        return mRanges.size();
+    }
+
+    const Range* Find( WORD seg, DWORD offset ) const
+    {
+        Range           key = { seg, 0, 0, 0, offset, 0, 0 };
+        auto            it = std::upper_bound( mRanges.begin(), mRanges.end(), key, LessByStart );
+        const Range*    found = NULL;
+
+        // ranges can overlap, so walk back as long as an earlier range can still
+        // contain the offset, and prefer the first one in compiland/file order
+        while ( it != mRanges.begin() )
+        {
+            --it;
+
+            if ( (it->Seg != seg) || (it->MaxEnd < offset) )
+                break;
+            if ( it->End < offset )
+                continue;
+
+            if ( (found == NULL)
+                || (it->CompIndex < found->CompIndex)
+                || ((it->CompIndex == found->CompIndex) && (it->FileIndex < found->FileIndex))
+                || ((it->CompIndex == found->CompIndex) && (it->FileIndex == found->FileIndex) 
+                    && (it->SegInstance < found->SegInstance)) )
+                found = &*it;
+        }
+
+        return found;
+    }
+};
@@ -98,4 +98,55 @@ public:
             symOffset = offsets[last].first;
         return found;
     }
+
+    static bool IsSorted( const Pair* offsets, DWORD numOffsets )
+    {
+        for ( DWORD i = 1; i < numOffsets; i++ )
+        {
+            if ( offsets[i].second < offsets[i - 1].second )
+                return false;
+        }
+        return true;
+    }
+
+    // Stable, so that the first of equal offsets is still the one found.
+    static void SortByOffset( Pair* offsets, DWORD numOffsets )
+    {
+        std::stable_sort( offsets, offsets + numOffsets,
+            []( const Pair& a, const Pair& b )
+            {
+                return a.second < b.second;
+            } );
+    }
+
+    // Same result as GetSymbolOffset, but the pairs have to be sorted by offset.
+    // An exact match wins, otherwise it's the closest symbol before the offset.
+    static bool FindSymbolOffset( const Pair* offsets, DWORD numOffsets, DWORD offset, uint32_t& symOffset )
+    {
+        if ( numOffsets == 0 )
+            return false;
+
+        // branchless lower bound: first pair that isn't below the offset
+        const Pair* base = offsets;
+        DWORD       len = numOffsets;
+
+        while ( len > 1 )
+        {
+            DWORD   half = len / 2;
+            base = (base[half].second < offset) ? base + half : base;
+            len -= half;
+        }
+        base += (base->second < offset);
+
+        if ( (base < offsets + numOffsets) && (base->second == offset) )
+        {
+            symOffset = base->first;
+            return true;
+        }
+        if ( base == offsets )
+            return false;
+
+        symOffset = base[-1].first;
+        return true;
+    }
 };
@@ -648,6 +648,7 @@ namespace MagoST
             mGlobal( NULL ),
             mFindLineEnumLineNumbers( NULL ),
             mInit( false ),
+            mComInit( false ),
             mCompilandCount( -1 )
     {
         mMachineType = CV_CFL_80386;
@@ -704,6 +705,7 @@ namespace MagoST
         // set it after successfully calling CoInit, 
         // so later CoUninit is only called once for each successful call to CoInit
         mInit = true;
+        mComInit = true;
 
         // Obtain access to the provider
         GUID msdia140 = { 0xe6756135, 0x1e65, 0x4d17, { 0x85, 0x76, 0x61, 0x07, 0x61, 0x39, 0x8c, 0x3c } };
@@ -787,12 +789,42 @@ namespace MagoST
             return cohr;
 
         mInit = true;
+        mComInit = true;
         mSession = session;
         mSession->AddRef();
 
         return initSession();
     }
 
+    HRESULT PDBDebugStore::OpenCopy( IDebugStore*& store )
+    {
+        // a session given to us by the host is all there is
+        if ( mSource == NULL )
+            return E_NOTIMPL;
+
+        // DIA objects aren't meant to be called from several threads at once,
+        // so the copy gets a session of its own on the same PDB. 
+        // COM is set up by the thread that uses it.
+        std::unique_ptr<PDBDebugStore> copy( new PDBDebugStore() );
+        if ( copy.get() == NULL )
+            return E_OUTOFMEMORY;
+
+        HRESULT hr = mSource->openSession( &copy->mSession );
+        if ( FAILED( hr ) )
+            return hr;
+
+        copy->mInit = true;
+        copy->mSource = mSource;
+        copy->mSource->AddRef();
+
+        hr = copy->initSession();
+        if ( FAILED( hr ) )
+            return hr;
+
+        store = copy.release();
+        return S_OK;
+    }
+
     HRESULT PDBDebugStore::initSession()
     {
         // Retrieve a reference to the global scope
@@ -851,8 +883,10 @@ namespace MagoST
             FreeLibrary( mMSDiaDll );
             mMSDiaDll = NULL;
         }
-        CoUninitialize();
+        if ( mComInit )
+            CoUninitialize();
         mInit = false;
+        mComInit = false;
     }
 
     void PDBDebugStore::releaseFindLineEnumLineNumbers()
@@ -868,28 +902,35 @@ namespace MagoST
     HRESULT PDBDebugStore::_symbolById( DWORD id, IDiaSymbol** pSymbol)
     {
         bool useMap = id >= 10'000'000;
-        if ( useMap )
         {
-            auto it = mSymbolCacheMap.find( id );
-            if( it != mSymbolCacheMap.end() )
+            GuardedArea guard( mSymbolCacheGuard );
+
+            if ( useMap )
             {
-                *pSymbol = it->second;
-                (*pSymbol)->AddRef();
-                return S_OK;
+                auto it = mSymbolCacheMap.find( id );
+                if( it != mSymbolCacheMap.end() )
+                {
+                    *pSymbol = it->second;
+                    (*pSymbol)->AddRef();
+                    return S_OK;
+                }
             }
-        }
-        else
-        {
-            if( id < mSymbolCache.size() && mSymbolCache[id] )
+            else
             {
-                *pSymbol = mSymbolCache[id];
-                (*pSymbol)->AddRef();
-                return S_OK;
+                if( id < mSymbolCache.size() && mSymbolCache[id] )
+                {
+                    *pSymbol = mSymbolCache[id];
+                    (*pSymbol)->AddRef();
+                    return S_OK;
+                }
             }
         }
+        // the lock only guards the cache; threads scanning the symbols use their own copy of the store
         HRESULT hr = mSession->symbolById( id, pSymbol );
         if( hr == S_OK && *pSymbol )
         {
+            GuardedArea guard( mSymbolCacheGuard );
+
             if ( useMap )
                 mSymbolCacheMap[id] = *pSymbol;
             else
@@ -985,26 +1026,70 @@ namespace MagoST
             HRESULT hr = mGlobal->findChildren( SymTagNull, wname.get (), nsCaseSensitive, &pEnumSymbols );
             
             if( hr == S_OK && pEnumSymbols )
+                return _firstSymbol( pEnumSymbols, data );
+
+            return E_FAIL;
+        }
+        return E_NOTIMPL;
+    }
+
+    HRESULT PDBDebugStore::_firstSymbol( IDiaEnumSymbols* pEnumSymbols, EnumNamedSymbolsData& data )
+    {
+        PDBStore::EnumNamedSymbolsDataIn& dataIn = (PDBStore::EnumNamedSymbolsDataIn&) data;
+        IDiaSymbol* pSymbol = NULL;
+        DWORD fetched = 0;
+        HRESULT hr = pEnumSymbols->Next( 1, &pSymbol, &fetched );
+        if ( hr == S_OK && pSymbol )
+        {
+            hr = pSymbol->get_symIndexId( &dataIn.id );
+            pSymbol->Release();
+            if( hr == S_OK )
             {
-                IDiaSymbol* pSymbol = NULL;
-                DWORD fetched = 0;
-                hr = pEnumSymbols->Next( 1, &pSymbol, &fetched );
-                if ( hr == S_OK && pSymbol )
-                {
-                    hr = pSymbol->get_symIndexId( &dataIn.id );
-                    pSymbol->Release();
-                    if( hr == S_OK )
-                    {
-                        dataIn.pEnumSymbols = pEnumSymbols;
-                        return S_OK;
-                    }
-                }
-                pEnumSymbols->Release();
+                dataIn.pEnumSymbols = pEnumSymbols;
+                return S_OK;
             }
+        }
+        pEnumSymbols->Release();
+        return E_FAIL;
+    }
 
+    HRESULT PDBDebugStore::GetSymbolCount( SymbolHeapId heapId, uint32_t& count )
+    {
+        if ( heapId != SymHeap_GlobalSymbols )
+            return E_NOTIMPL;
+
+        IDiaEnumSymbols* pEnumSymbols = NULL;
+        HRESULT hr = mGlobal->findChildren( SymTagNull, NULL, nsCaseSensitive, &pEnumSymbols );
+        if ( hr != S_OK || !pEnumSymbols )
+            return E_FAIL;
+
+        LONG symCount = 0;
+        hr = pEnumSymbols->get_Count( &symCount );
+        pEnumSymbols->Release();
+        if ( hr != S_OK || symCount < 0 )
+            return E_FAIL;
+
+        count = (uint32_t) symCount;
+        return S_OK;
+    }
+
+    HRESULT PDBDebugStore::FindFirstSymbolAt( SymbolHeapId heapId, uint32_t index, EnumNamedSymbolsData& data )
+    {
+        if ( heapId != SymHeap_GlobalSymbols )
+            return E_NOTIMPL;
+
+        // the same enumeration as FindFirstSymbol without a name
+        IDiaEnumSymbols* pEnumSymbols = NULL;
+        HRESULT hr = mGlobal->findChildren( SymTagNull, NULL, nsCaseSensitive, &pEnumSymbols );
+        if ( hr != S_OK || !pEnumSymbols )
+            return E_FAIL;
+
+        if ( index > 0 && pEnumSymbols->Skip( index ) != S_OK )
+        {
+            pEnumSymbols->Release();
             return E_FAIL;
         }
-        return E_NOTIMPL;
+        return _firstSymbol( pEnumSymbols, data );
     }
 
 
@@ -1670,25 +1755,8 @@ namespace MagoST
                     else
                         matches = PartialFileNameMatch( fileName, fileNameLen, srcFileName.GetName(), srcFileName.GetLength() );
                 }
-                if( matches )
-                {
-                    IDiaEnumLineNumbers *pEnumLineNumbers = 0;
-                    if( hr == S_OK )
-                        hr = mSession->findLinesByLinenum( pCompiland, pSourceFile, reqLineStart, 0, &pEnumLineNumbers );
-                    
-                    IDiaLineNumber* pLineNumber = NULL;
-                    while( hr == S_OK && pEnumLineNumbers->Next( 1, &pLineNumber, &fetched ) == S_OK )
-                    {
-                        LineNumber line;
-                        setLineNumber( pLineNumber, (uint16_t) lines.size(), line );
-                        if( line.Number <= reqLineEnd && line.NumberEnd >= reqLineStart )
-                            lines.push_back( line );
-                        pLineNumber->Release();
-                    }
-
-                    if( pEnumLineNumbers )
-                        pEnumLineNumbers->Release();
-                }
+                if( matches && hr == S_OK )
+                    hr = findFileLines( pCompiland, pSourceFile, reqLineStart, reqLineEnd, lines );
                 pSourceFile->Release();
             }
             if( pFiles )
@@ -1699,5 +1767,71 @@ namespace MagoST
             pEnumSymbols->Release();
         return lines.size() > 0;
     }
-}
 
+    bool PDBDebugStore::FindFileLines( uint16_t compIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                       std::list<LineNumber>& lines )
+    {
+        if ( (compIndex < 1) || (compIndex > getCompilandCount()) )
+            return false;
+
+        IDiaEnumSymbols *pEnumSymbols = NULL;
+        HRESULT hr = mGlobal->findChildren( SymTagCompiland, NULL, nsNone, &pEnumSymbols );
+
+        IDiaSymbol *pCompiland = NULL;
+        if( hr == S_OK )
+            hr = pEnumSymbols->Item( compIndex - 1, &pCompiland );
+
+        IDiaEnumSourceFiles *pFiles = NULL;
+        if( hr == S_OK )
+            hr = mSession->findFile( pCompiland, NULL, nsNone, &pFiles );
+
+        LONG fileCount = 0;
+        if( hr == S_OK )
+            hr = pFiles->get_Count( &fileCount );
+
+        if( hr == S_OK && fileIndex >= fileCount )
+            hr = E_INVALIDARG;
+
+        IDiaSourceFile *pSourceFile = NULL;
+        if( hr == S_OK )
+            hr = pFiles->Item( fileIndex, &pSourceFile );
+
+        size_t count = lines.size();
+        if( hr == S_OK )
+            hr = findFileLines( pCompiland, pSourceFile, reqLineStart, reqLineEnd, lines );
+
+        if( pSourceFile )
+            pSourceFile->Release();
+        if( pFiles )
+            pFiles->Release();
+        if( pCompiland )
+            pCompiland->Release();
+        if( pEnumSymbols )
+            pEnumSymbols->Release();
+
+        return lines.size() > count;
+    }
+
+    HRESULT PDBDebugStore::findFileLines( IDiaSymbol *pCompiland, IDiaSourceFile *pSourceFile, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                          std::list<LineNumber>& lines )
+    {
+        IDiaEnumLineNumbers *pEnumLineNumbers = 0;
+        HRESULT hr = mSession->findLinesByLinenum( pCompiland, pSourceFile, reqLineStart, 0, &pEnumLineNumbers );
+
+        ULONG fetched;
+        IDiaLineNumber* pLineNumber = NULL;
+        while( hr == S_OK && pEnumLineNumbers->Next( 1, &pLineNumber, &fetched ) == S_OK )
+        {
+            LineNumber line;
+            setLineNumber( pLineNumber, (uint16_t) lines.size(), line );
+            if( line.Number <= reqLineEnd && line.NumberEnd >= reqLineStart )
+                lines.push_back( line );
+            pLineNumber->Release();
+        }
+
+        if( pEnumLineNumbers )
+            pEnumLineNumbers->Release();
+
+        return hr;
+    }
+}
@@ -50,6 +50,10 @@ namespace MagoST
         virtual HRESULT GetCurrentSymbol( const EnumNamedSymbolsData& searchHandle, SymHandle& handle );
         virtual HRESULT FindSymbolDone( EnumNamedSymbolsData& handle );
 
+        virtual HRESULT GetSymbolCount( SymbolHeapId heapId, uint32_t& count );
+        virtual HRESULT FindFirstSymbolAt( SymbolHeapId heapId, uint32_t index, EnumNamedSymbolsData& data );
+        virtual HRESULT OpenCopy( IDebugStore*& store );
+
         virtual HRESULT FindSymbol( SymbolHeapId heapId, WORD segment, DWORD offset, SymHandle& handle, DWORD& symOff );
 
         virtual HRESULT GetSymbolInfo( SymHandle handle, SymInfoData& privateData, ISymbolInfo*& symInfo );
@@ -85,19 +89,25 @@ namespace MagoST
 
         virtual bool    FindLines( bool exactMatch, const char* fileName, size_t fileNameLen, uint16_t reqLineStart, uint16_t reqLineEnd, 
                                    std::list<LineNumber>& );
+        virtual bool    FindFileLines( uint16_t compIndex, uint16_t fileIndex, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                                       std::list<LineNumber>& lines );
 
     private:
         void releaseFindLineEnumLineNumbers();
         HRESULT fillFileSegmentInfo( IDiaEnumLineNumbers *pEnumLineNumbers, FileSegmentInfo& segInfo );
         HRESULT findCompilandAndFile( IDiaSymbol *pCompiland, IDiaSourceFile *pSourceFile, uint16_t& compIndex, uint16_t& fileIndex );
         HRESULT setLineNumber( IDiaLineNumber* pLineNumber, uint16_t lineIndex, LineNumber& lineNumber );
+        HRESULT findFileLines( IDiaSymbol *pCompiland, IDiaSourceFile *pSourceFile, uint16_t reqLineStart, uint16_t reqLineEnd, 
+                               std::list<LineNumber>& lines );
         uint32_t getCompilandCount();
         HRESULT initSession();
         HRESULT MsdiaCoCreateInstance( REFCLSID rclsid, IUnknown* pUnkOuter, REFIID riid, LPVOID* ppv );
 
         HRESULT _symbolById( DWORD id, IDiaSymbol** pSymbol );
+        HRESULT _firstSymbol( IDiaEnumSymbols* pEnumSymbols, EnumNamedSymbolsData& data );
 
         bool mInit;
+        bool mComInit;      // CoUninitialize when closing
         HMODULE mMSDiaDll;
 
         IDiaDataSource  *mSource;
@@ -115,6 +125,7 @@ namespace MagoST
 
         std::vector<RefPtr<IDiaSymbol>> mSymbolCache;
         std::map<DWORD, RefPtr<IDiaSymbol>> mSymbolCacheMap;
+        Guard mSymbolCacheGuard;    // symbols are looked up on more than one thread
 
         friend class PDBSymbolInfo;
     };
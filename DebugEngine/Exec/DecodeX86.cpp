@@ -5,7 +5,13 @@
    See the LICENSE text file for details.
 */
 
-#include "Common.h"
+// not built with the precompiled header, so that it builds outside of Windows
+#include <windows.h>
+#include <stdint.h>
+#include <crtdbg.h>
+#include <algorithm>
+#include <vector>
+#include "Types.h"
 #include "DecodeX86.h"
 
 
@@ -55,6 +61,7 @@ static int ReadPrefixes( uint8_t* mem, int memLen, CpuSizeMode mode, Prefixes& p
     _ASSERT( (mode == Cpu_32) || (mode == Cpu_64) );
 
     int i;
+    int rexPos = -1;
 
     for ( i = 0; i < memLen; i++ )
     {
@@ -80,15 +87,21 @@ static int ReadPrefixes( uint8_t* mem, int memLen, CpuSizeMode mode, Prefixes& p
                 {
                     found = true;
                     prefixes.Pre64.Rex.Byte = mem[i];
+                    rexPos = i;
                 }
             }
 
             if ( !found )
-                return i;
+                goto Done;
             break;
         }
     }
 
+Done:
+    // a REX prefix is ignored unless it comes right before the opcode
+    if ( rexPos != i - 1 )
+        prefixes.Pre64.Rex.Byte = 0;
+
     return i;
 }
 
@@ -286,3 +299,486 @@ InstructionType GetInstructionTypeAndSize( uint8_t* mem, int memLen, CpuSizeMode
 
     return type;
 }
+
+
+// length of the ModRM byte, SIB byte, and displacement; 0 if memory runs out
+static int GetModRmLength( uint8_t* mem, int memLen, bool addr16 )
+{
+    if ( memLen < 1 )
+        return 0;
+
+    int     len = 1;
+    BYTE    mod = (mem[0] >> 6) & 3;
+    BYTE    rm = (mem[0] & 7);
+
+    if ( mod == 3 )
+        return len;
+
+    if ( addr16 )
+    {
+        if ( mod == 2 )
+            len += 2;
+        else if ( mod == 1 )
+            len += 1;
+        else if ( rm == 6 )
+            len += 2;
+        return len;
+    }
+
+    if ( rm == 4 )
+    {
+        if ( memLen < 2 )
+            return 0;
+
+        len += 1;               // SIB
+
+        // no base register
+        if ( (mod == 0) && ((mem[1] & 7) == 5) )
+            len += 4;
+    }
+
+    if ( mod == 2 )
+        len += 4;
+    else if ( mod == 1 )
+        len += 1;
+    else if ( rm == 5 )
+        len += 4;               // disp32, or RIP relative in 64-bit mode
+
+    return len;
+}
+
+// opcodes after 0F, also used by VEX and EVEX encoded instructions in that map
+static InstructionFlow GetTwoByteLayout( uint8_t op, bool& hasModRm, int& immSize )
+{
+    hasModRm = true;
+    immSize = 0;
+
+    switch ( op )
+    {
+    case 0x05: case 0x07: case 0x0B: case 0x34: case 0x35: case 0xAA:
+        // syscall, sysret, ud2, sysenter, sysexit, rsm
+        hasModRm = false;
+        return Flow_Other;
+
+    case 0x06: case 0x08: case 0x09: case 0x0E:
+    case 0x30: case 0x31: case 0x32: case 0x33: case 0x37: case 0x77:
+    case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xA9:
+        hasModRm = false;
+        return Flow_Next;
+
+    case 0x0F:              // 3DNow! has its opcode after the operands
+    case 0x70: case 0x71: case 0x72: case 0x73:
+    case 0xA4: case 0xAC: case 0xBA:
+    case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+        immSize = 1;
+        return Flow_Next;
+
+    case 0x04: case 0x0A: case 0x0C: case 0x24: case 0x25: case 0x26: case 0x27:
+    case 0x36: case 0x39: case 0x3B: case 0x3C: case 0x3D: case 0x3E: case 0x3F:
+    case 0x7A: case 0x7B: case 0xA6: case 0xA7:
+        return Flow_None;
+    }
+
+    if ( (op >= 0x80) && (op <= 0x8F) )
+    {
+        hasModRm = false;
+        return Flow_Branch;
+    }
+
+    if ( (op >= 0xC8) && (op <= 0xCF) )
+    {
+        hasModRm = false;
+        return Flow_Next;
+    }
+
+    return Flow_Next;
+}
+
+// VEX and EVEX encoded instructions; map is 1 for 0F, 2 for 0F 38, 3 for 0F 3A
+static InstructionFlow GetVexLayout( int map, uint8_t op, bool& hasModRm, int& immSize )
+{
+    hasModRm = true;
+    immSize = 0;
+
+    if ( map == 1 )
+    {
+        // vzeroupper and vzeroall
+        if ( op == 0x77 )
+        {
+            hasModRm = false;
+            return Flow_Next;
+        }
+
+        if ( ((op >= 0x70) && (op <= 0x73)) || (op == 0xC2) || ((op >= 0xC4) && (op <= 0xC6)) )
+            immSize = 1;
+        return Flow_Next;
+    }
+    else if ( map == 2 )
+    {
+        return Flow_Next;
+    }
+    else if ( map == 3 )
+    {
+        immSize = 1;
+        return Flow_Next;
+    }
+
+    return Flow_None;
+}
+
+InstructionFlow GetInstructionFlow( uint8_t* mem, int memLen, CpuSizeMode mode, int& size, int32_t& target )
+{
+    _ASSERT( (mode == Cpu_32) || (mode == Cpu_64) );
+
+    InstructionFlow flow = Flow_Next;
+    int             prefixSize = 0;
+    int             remSize = 0;
+    int             opSize = 1;         // opcode bytes, including escapes and VEX prefixes
+    int             modRmSize = 0;
+    int             immSize = 0;        // for branches, this is the displacement
+    int             instSize = 0;
+    bool            hasModRm = false;
+    bool            is64 = (mode == Cpu_64);
+    Prefixes        prefixes = { 0 };
+
+    if ( memLen > MAX_INSTRUCTION_SIZE )
+        memLen = MAX_INSTRUCTION_SIZE;
+
+    prefixSize = ReadPrefixes( mem, memLen, mode, prefixes );
+    if ( prefixSize >= memLen )
+        return Flow_None;
+
+    remSize = memLen - prefixSize;
+    mem = &mem[prefixSize];
+
+    bool    addr16 = !is64 && prefixes.Pre32.AddressSize;
+    bool    rep = prefixes.Pre32.RepF2 || prefixes.Pre32.RepF3;
+    // REX.W overrides the operand size prefix, and 64-bit operands still take 32-bit immediates
+    int     immV = (prefixes.Pre32.OperandSize && !(is64 && prefixes.Pre64.Rex.Bits.W)) ? 2 : 4;
+    BYTE    op = mem[0];
+    BYTE    regOp = (remSize >= 2) ? ((mem[1] >> 3) & 7) : 0;
+    bool    regForm = (remSize >= 2) && ((mem[1] & 0xC0) == 0xC0);
+
+    if ( op == 0x0F )
+    {
+        if ( remSize < 2 )
+            return Flow_None;
+
+        opSize = 2;
+
+        if ( mem[1] == 0x38 )
+        {
+            opSize = 3;
+            hasModRm = true;
+        }
+        else if ( mem[1] == 0x3A )
+        {
+            opSize = 3;
+            hasModRm = true;
+            immSize = 1;
+        }
+        else if ( (mem[1] >= 0x20) && (mem[1] <= 0x23) )
+        {
+            // moves to and from control and debug registers ignore the mod bits
+            immSize = 1;
+        }
+        else
+        {
+            flow = GetTwoByteLayout( mem[1], hasModRm, immSize );
+
+            if ( flow == Flow_Branch )
+                immSize = immV;
+        }
+    }
+    else if ( (op == 0xC5) && (is64 || regForm) )
+    {
+        if ( remSize < 3 )
+            return Flow_None;
+
+        opSize = 3;
+        flow = GetVexLayout( 1, mem[2], hasModRm, immSize );
+    }
+    else if ( (op == 0xC4) && (is64 || regForm) )
+    {
+        if ( remSize < 4 )
+            return Flow_None;
+
+        opSize = 4;
+        flow = GetVexLayout( mem[1] & 0x1F, mem[3], hasModRm, immSize );
+    }
+    else if ( (op == 0x62) && (is64 || regForm) )
+    {
+        if ( remSize < 5 )
+            return Flow_None;
+
+        opSize = 5;
+        flow = GetVexLayout( mem[1] & 3, mem[4], hasModRm, immSize );
+    }
+    else if ( op < 0x40 )
+    {
+        switch ( op & 7 )
+        {
+        case 0: case 1: case 2: case 3:
+            hasModRm = true;
+            break;
+
+        case 4:
+            immSize = 1;
+            break;
+
+        case 5:
+            immSize = immV;
+            break;
+
+        default:
+            // segment pushes and pops, and BCD adjustments; the segment prefixes were already read
+            if ( is64 )
+                return Flow_None;
+            break;
+        }
+    }
+    else
+    {
+        switch ( op )
+        {
+        case 0x60: case 0x61: case 0x82: case 0xCE: case 0xD4: case 0xD5: case 0xD6:
+            if ( is64 )
+                return Flow_None;
+
+            if ( op == 0x82 )
+            {
+                hasModRm = true;
+                immSize = 1;
+            }
+            else if ( (op == 0xD4) || (op == 0xD5) )
+                immSize = 1;
+            else if ( op == 0xCE )
+                flow = Flow_Other;
+            break;
+
+        case 0x62:      // bound
+        case 0x63:
+        case 0x84: case 0x85: case 0x86: case 0x87: case 0x88: case 0x89: case 0x8A: case 0x8B:
+        case 0x8C: case 0x8D: case 0x8E:
+        case 0xC4: case 0xC5:       // les and lds
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+        case 0xD8: case 0xD9: case 0xDA: case 0xDB: case 0xDC: case 0xDD: case 0xDE: case 0xDF:
+        case 0xFE:
+            hasModRm = true;
+            break;
+
+        case 0x8F:
+            // otherwise it's an XOP prefix
+            if ( regOp != 0 )
+                return Flow_None;
+            hasModRm = true;
+            break;
+
+        case 0x68: case 0xA9:
+            immSize = immV;
+            break;
+
+        case 0x6A: case 0xA8: case 0xE4: case 0xE5: case 0xE6: case 0xE7:
+            immSize = 1;
+            break;
+
+        case 0x69: case 0x81:
+            hasModRm = true;
+            immSize = immV;
+            break;
+
+        case 0x6B: case 0x80: case 0x83: case 0xC0: case 0xC1:
+            hasModRm = true;
+            immSize = 1;
+            break;
+
+        case 0x6C: case 0x6D: case 0x6E: case 0x6F:
+        case 0xA4: case 0xA5: case 0xA6: case 0xA7:
+        case 0xAA: case 0xAB: case 0xAC: case 0xAD: case 0xAE: case 0xAF:
+            if ( rep )
+                flow = Flow_Other;
+            break;
+
+        case 0x9A: case 0xEA:
+            if ( is64 )
+                return Flow_None;
+            immSize = immV + 2;
+            flow = Flow_Other;
+            break;
+
+        case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+            if ( is64 )
+                immSize = prefixes.Pre32.AddressSize ? 4 : 8;
+            else
+                immSize = prefixes.Pre32.AddressSize ? 2 : 4;
+            break;
+
+        case 0xC2: case 0xCA:
+            immSize = 2;
+            flow = Flow_Other;
+            break;
+
+        case 0xC3: case 0xCB: case 0xCC: case 0xCF: case 0xF1: case 0xF4:
+            flow = Flow_Other;
+            break;
+
+        case 0xCD:
+            immSize = 1;
+            flow = Flow_Other;
+            break;
+
+        case 0xC6: case 0xC7:
+            // xabort and xbegin
+            if ( regOp != 0 )
+                return Flow_None;
+            hasModRm = true;
+            immSize = (op == 0xC6) ? 1 : immV;
+            break;
+
+        case 0xC8:
+            immSize = 3;
+            break;
+
+        case 0xE0: case 0xE1: case 0xE2: case 0xE3: case 0xEB:
+            immSize = 1;
+            flow = (op == 0xEB) ? Flow_Jump : Flow_Branch;
+            break;
+
+        case 0xE8: case 0xE9:
+            immSize = immV;
+            flow = (op == 0xE8) ? Flow_Other : Flow_Jump;
+            break;
+
+        case 0xF6: case 0xF7:
+            hasModRm = true;
+            if ( (regOp == 0) || (regOp == 1) )
+                immSize = (op == 0xF6) ? 1 : immV;
+            break;
+
+        case 0xFF:
+            if ( regOp == 7 )
+                return Flow_None;
+            hasModRm = true;
+            if ( (regOp >= 2) && (regOp <= 5) )
+                flow = Flow_Other;
+            break;
+
+        default:
+            if ( (op >= 0xB0) && (op <= 0xB7) )
+                immSize = 1;
+            else if ( (op >= 0xB8) && (op <= 0xBF) )
+                immSize = (is64 && prefixes.Pre64.Rex.Bits.W) ? 8 : immV;
+            else if ( (op >= 0x70) && (op <= 0x7F) )
+            {
+                immSize = 1;
+                flow = Flow_Branch;
+            }
+            // the rest are one byte: inc, dec, push, pop, xchg, flags, and port I/O
+            break;
+        }
+    }
+
+    if ( flow == Flow_None )
+        return Flow_None;
+
+    // processors disagree about the size of a displacement with an operand size prefix
+    if ( ((flow == Flow_Branch) || (flow == Flow_Jump) || (op == 0xE8)) && is64 && prefixes.Pre32.OperandSize )
+        return Flow_None;
+
+    if ( hasModRm )
+    {
+        modRmSize = GetModRmLength( &mem[opSize], remSize - opSize, addr16 );
+        if ( modRmSize == 0 )
+            return Flow_None;
+    }
+
+    instSize = opSize + modRmSize + immSize;
+
+    // sanity check, is it longer than available memory?
+    if ( instSize > remSize )
+        return Flow_None;
+
+    if ( (flow == Flow_Branch) || (flow == Flow_Jump) )
+    {
+        uint8_t*    disp = &mem[instSize - immSize];
+
+        // an operand size prefix cuts the instruction pointer down to 16 bits
+        if ( prefixes.Pre32.OperandSize )
+            flow = Flow_Other;
+        else if ( immSize == 1 )
+            target = (int8_t) disp[0];
+        else
+            target = (int32_t) (disp[0] | (disp[1] << 8) | (disp[2] << 16) | ((uint32_t) disp[3] << 24));
+    }
+
+    size = instSize + prefixSize;
+
+    return flow;
+}
+
+bool GetRangeExits( 
+    uint8_t* mem, 
+    uint32_t memLen, 
+    AddressRange range, 
+    CpuSizeMode mode, 
+    std::vector<Address>& starts, 
+    std::vector<Address>& exits )
+{
+    _ASSERT( range.End >= range.Begin );
+
+    uint32_t    rangeSize = (uint32_t) (range.End - range.Begin + 1);
+    std::vector< std::pair<Address, Address> >  branches;
+
+    // the range starts on an instruction, so decoding from there finds all of them
+    for ( uint32_t offset = 0; offset < rangeSize; )
+    {
+        Address         addr = range.Begin + offset;
+        InstructionFlow flow = Flow_None;
+        int             instLen = 0;
+        int32_t         disp = 0;
+        bool            stop = false;
+
+        if ( offset >= memLen )
+            return false;
+
+        flow = GetInstructionFlow( &mem[offset], (int) (memLen - offset), mode, instLen, disp );
+        if ( flow == Flow_None )
+            return false;
+
+        starts.push_back( addr );
+        offset += instLen;
+
+        if ( flow == Flow_Branch || flow == Flow_Jump )
+        {
+            Address target = addr + instLen + disp;
+
+            if ( mode == Cpu_32 )
+                target &= 0xFFFFFFFF;
+
+            if ( target >= range.Begin && target <= range.End )
+                branches.push_back( std::make_pair( addr, target ) );
+            else
+                stop = true;
+        }
+
+        if ( flow == Flow_Other )
+            stop = true;
+        else if ( flow != Flow_Jump && offset >= rangeSize )
+            stop = true;        // falls through to the next range
+
+        if ( stop )
+            exits.push_back( addr );
+    }
+
+    // a branch into the middle of an instruction means we decoded it wrong or it's data
+    for ( size_t i = 0; i < branches.size(); i++ )
+    {
+        if ( !std::binary_search( starts.begin(), starts.end(), branches[i].second ) )
+            exits.push_back( branches[i].first );
+    }
+
+    std::sort( exits.begin(), exits.end() );
+    exits.erase( std::unique( exits.begin(), exits.end() ), exits.end() );
+
+    return true;
+}
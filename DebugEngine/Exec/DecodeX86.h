@@ -25,6 +25,15 @@ enum InstructionType
     Inst_Syscall,
 };
 
+enum InstructionFlow
+{
+    Flow_None,      // couldn't decode it
+    Flow_Next,      // always goes on to the next instruction
+    Flow_Branch,    // a conditional direct branch
+    Flow_Jump,      // an unconditional direct jump
+    Flow_Other,     // calls, returns, indirect jumps, traps, and rep string instructions
+};
+
 
 // IA-32 Intel Architecture: Software Developers Manual
 // Volume 2A: Instruction Set Reference, A-M
@@ -33,3 +42,21 @@ const int   MAX_INSTRUCTION_SIZE = 15;
 
 
 InstructionType GetInstructionTypeAndSize( uint8_t* mem, int memLen, CpuSizeMode mode, int& size );
+
+// Decodes the length of any instruction and how control leaves it. For branches and
+// jumps, target is the displacement from the end of the instruction.
+InstructionFlow GetInstructionFlow( uint8_t* mem, int memLen, CpuSizeMode mode, int& size, int32_t& target );
+
+// Decodes a range that starts on an instruction, and finds the instructions where 
+// control can leave it: calls, returns, and the like, branches out of the range or 
+// into the middle of an instruction, and the last one, if it falls through. 
+// The instructions' addresses are added to starts in order, and exits is sorted.
+// mem holds memLen bytes from the beginning of the range. Returns false if an 
+// instruction in the range can't be decoded.
+bool GetRangeExits( 
+    uint8_t* mem, 
+    uint32_t memLen, 
+    AddressRange range, 
+    CpuSizeMode mode, 
+    std::vector<Address>& starts, 
+    std::vector<Address>& exits );
@@ -490,6 +490,8 @@ HRESULT Exec::DispatchProcessEvent( Process* proc, const DEBUG_EVENT& debugEvent
 
     case UNLOAD_DLL_DEBUG_EVENT:
         {
+            machine->OnUnloadModule( (Address) debugEvent.u.UnloadDll.lpBaseOfDll );
+
             if ( mCallback != NULL )
             {
                 proc->Unlock();
@@ -78,6 +78,7 @@ public:
     virtual void    OnStopped( uint32_t threadId ) = 0;
     virtual HRESULT OnCreateThread( Thread* thread ) = 0;
     virtual HRESULT OnExitThread( uint32_t threadId ) = 0;
+    virtual void    OnUnloadModule( Address baseAddress ) = 0;
     virtual HRESULT OnException( 
         uint32_t threadId, 
         const EXCEPTION_DEBUG_INFO* exceptRec, 
@@ -13,6 +13,7 @@
 #include "Process.h"
 #include "Thread.h"
 #include "ThreadX86.h"
+#include <algorithm>
 #include <memory>
 
 class Breakpoint;
@@ -24,6 +25,26 @@ class BPAddressTable : public std::map< Address, Breakpoint* >
 typedef BPAddressTable::iterator BPIterator;
 
 
+struct DecodedInst
+{
+    InstructionType Type;
+    int             Size;
+};
+
+// Instructions decoded for stepping. They're only kept while a range step runs.
+// Whenever the debuggee runs on its own, it can change its code: a JIT compiler
+// writes new code, code modifies itself, or memory is freed and allocated again
+// for other code. During a range step, the code of the range is assumed to change
+// only when we write to it, or when a module is unloaded and something else is
+// put in its place.
+
+class DecodedInstTable : public std::map< Address, DecodedInst >
+{
+};
+
+const size_t    MaxDecodedInsts = 4096;
+
+
 const uint8_t   BreakpointInstruction = 0xCC;
 const uint32_t  STATUS_WX86_SINGLE_STEP = 0x4000001E;
 const uint32_t  STATUS_WX86_BREAKPOINT = 0x4000001F;
@@ -158,6 +179,7 @@ MachineX86Base::MachineX86Base()
     mProcess( NULL ),
     mhProcess( NULL ),
     mAddrTable( NULL ),
+    mInstTable( NULL ),
     mStoppedThreadId( 0 ),
     mStoppedOnException( false ),
     mStopped( false ),
@@ -182,6 +204,7 @@ MachineX86Base::~MachineX86Base()
     }
 
     delete mAddrTable;
+    delete mInstTable;
 
     for ( ThreadMap::iterator it = mThreads.begin();
         it != mThreads.end();
@@ -211,11 +234,13 @@ void MachineX86Base::Release()
 HRESULT MachineX86Base::Init()
 {
     std::unique_ptr< BPAddressTable > addrTable( new BPAddressTable() );
+    std::unique_ptr< DecodedInstTable > instTable( new DecodedInstTable() );
 
-    if ( addrTable.get() == NULL )
+    if ( (addrTable.get() == NULL) || (instTable.get() == NULL) )
         return E_OUTOFMEMORY;
 
     mAddrTable = addrTable.release();
+    mInstTable = instTable.release();
 
     return S_OK;
 }
@@ -262,6 +287,9 @@ HRESULT MachineX86Base::WriteMemory(
     if ( mStoppedThreadId == 0 )
         return E_WRONG_STATE;
 
+    // even if the write fails, part of it might have been done
+    ForgetInstructions( address, length );
+
     return WriteCleanMemory( address, length, lengthWritten, buffer );
 }
 
@@ -610,10 +638,28 @@ HRESULT MachineX86Base::OnContinue()
     mStoppedThreadId = 0;
     mCurThread = NULL;
 
+    if ( !IsRangeStepping() )
+        mInstTable->clear();
+
 Error:
     return hr;
 }
 
+bool MachineX86Base::IsRangeStepping()
+{
+    for ( ThreadMap::iterator it = mThreads.begin();
+        it != mThreads.end();
+        it++ )
+    {
+        ExpectedEvent*  event = it->second->GetTopExpected();
+
+        if ( (event != NULL) && (event->Range != NULL) )
+            return true;
+    }
+
+    return false;
+}
+
 HRESULT MachineX86Base::SuspendOtherThreads( UINT32 threadId )
 {
     _ASSERT( !mIsolatedThread );
@@ -677,6 +723,14 @@ HRESULT MachineX86Base::Rewind()
     return ChangeCurrentPC( -1 );
 }
 
+void    MachineX86Base::OnUnloadModule( Address baseAddress )
+{
+    UNREFERENCED_PARAMETER( baseAddress );
+
+    // we don't know how big the module was, and unloading is rare
+    mInstTable->clear();
+}
+
 void    MachineX86Base::OnDestroyProcess()
 {
     mhProcess = NULL;
@@ -753,6 +807,13 @@ HRESULT MachineX86Base::RunAllActions( bool cancel, MachineResult& result )
             goto Error;
     }
 
+    if ( event->Range != NULL && event->Range->ExitCount > 0 )
+    {
+        hr = RemoveRangeExits( event->Range );
+        if ( FAILED( hr ) )
+            goto Error;
+    }
+
     if ( event->ResumeThreads )
     {
         hr = ResumeOtherThreads( mStoppedThreadId );
@@ -1023,6 +1084,30 @@ Error:
     return hr;
 }
 
+static bool IsRangeExit( RangeStep* rangeStep, Address address )
+{
+    if ( rangeStep == NULL )
+        return false;
+
+    for ( int i = 0; i < rangeStep->ExitCount; i++ )
+    {
+        if ( rangeStep->Exits[i] == address )
+            return true;
+    }
+
+    return false;
+}
+
+static bool IsRangeStart( RangeStep* rangeStep, Address address )
+{
+    if ( (address < rangeStep->DecodedRange.Begin) || (address > rangeStep->DecodedRange.End) )
+        return false;
+
+    Address offset = address - rangeStep->DecodedRange.Begin;
+
+    return (rangeStep->DecodedStarts[offset / 8] & (1 << (offset % 8))) != 0;
+}
+
 HRESULT MachineX86Base::DispatchSingleStep( const EXCEPTION_DEBUG_INFO* exceptRec, MachineResult& result )
 {
     UNREFERENCED_PARAMETER( exceptRec );
@@ -1069,7 +1154,8 @@ HRESULT    MachineX86Base::DispatchBreakpoint( const EXCEPTION_DEBUG_INFO* excep
 
     ExpectedEvent* event = mCurThread->GetTopExpected();
 
-    if ( event != NULL && event->Code == Expect_BP && event->BPAddress == exceptAddr )
+    if ( event != NULL && event->Code == Expect_BP 
+        && (event->BPAddress == exceptAddr || IsRangeExit( event->Range, exceptAddr )) )
     {
         if ( !embeddedBP )
         {
@@ -1093,6 +1179,15 @@ HRESULT    MachineX86Base::DispatchBreakpoint( const EXCEPTION_DEBUG_INFO* excep
         return S_OK;
     }
 
+    // the BP was removed after the thread hit it, like the exits of a range step 
+    // that another thread finished, so run the original instruction
+    if ( bp == NULL )
+    {
+        Rewind();
+        result = MacRes_HandledContinue;
+        return S_OK;
+    }
+
     if ( bp->IsUser() )
     {
         Rewind();
@@ -1101,6 +1196,9 @@ HRESULT    MachineX86Base::DispatchBreakpoint( const EXCEPTION_DEBUG_INFO* excep
         return S_OK;
     }
 
+    // Another thread hit an internal BP, like an exit of a range step. SetContinue 
+    // steps it over the BP with the other threads suspended, so that the stepping 
+    // thread can't pass the exit while it's unpatched.
     Rewind();
     result = MacRes_HandledContinue;
     return S_OK;
@@ -1138,6 +1236,16 @@ HRESULT MachineX86Base::ReadInstruction(
     InstructionType instType = Inst_None;
     CpuSizeMode     cpu = Is64Bit() ? Cpu_64 : Cpu_32;
 
+    // range steps and loops come back to the same instructions over and over
+    DecodedInstTable::iterator it = mInstTable->find( curAddress );
+
+    if ( it != mInstTable->end() )
+    {
+        size = it->second.Size;
+        type = it->second.Type;
+        return S_OK;
+    }
+
     // this unpatches all BPs in the buffer
     hr = ReadCleanMemory( curAddress, MAX_INSTRUCTION_SIZE, lenRead, lenUnreadable, mem );
     if ( FAILED( hr ) )
@@ -1147,11 +1255,33 @@ HRESULT MachineX86Base::ReadInstruction(
     if ( instType == Inst_None )
         return E_UNEXPECTED;
 
+    if ( mInstTable->size() >= MaxDecodedInsts )
+        mInstTable->clear();
+
+    DecodedInst     inst = { instType, instLen };
+    mInstTable->insert( DecodedInstTable::value_type( curAddress, inst ) );
+
     size = instLen;
     type = instType;
     return S_OK;
 }
 
+void MachineX86Base::ForgetInstructions( Address address, uint32_t length )
+{
+    if ( length == 0 )
+        return;
+
+    // an instruction that starts a little before the range can reach into it
+    Address startAddr = (address > MAX_INSTRUCTION_SIZE - 1) ? address - (MAX_INSTRUCTION_SIZE - 1) : 0;
+    Address endAddr = address + length;
+
+    DecodedInstTable::iterator first = mInstTable->lower_bound( startAddr );
+    DecodedInstTable::iterator last = 
+        (endAddr < address) ? mInstTable->end() : mInstTable->lower_bound( endAddr );
+
+    mInstTable->erase( first, last );
+}
+
 Breakpoint* MachineX86Base::FindBP( Address address )
 {
     BPIterator      bpIt = mAddrTable->find( address );
@@ -1622,9 +1752,21 @@ HRESULT MachineX86Base::SetStepInstructionCore( Motion motion, RangeStepPtr& ran
         }
         else
         {
-            hr = DontPassBP( motion, pc, instType, instLen, notifier, rangeStep );
-            if ( FAILED( hr ) )
-                goto Error;
+            hr = S_FALSE;
+
+            if ( instType == Inst_Other && rangeStep.Get() != NULL )
+            {
+                hr = SetRunRange( motion, pc, notifier, rangeStep );
+                if ( FAILED( hr ) )
+                    goto Error;
+            }
+
+            if ( hr == S_FALSE )
+            {
+                hr = DontPassBP( motion, pc, instType, instLen, notifier, rangeStep );
+                if ( FAILED( hr ) )
+                    goto Error;
+            }
         }
     }
 
@@ -1632,6 +1774,144 @@ Error:
     return hr;
 }
 
+// Instead of stepping each instruction in the range, sets BPs on the instructions 
+// where control can leave it, and lets the thread run. Branches that stay in the 
+// range don't stop the thread, so loops cost no more than straight code.
+// Returns S_FALSE if the range can't be run, and the caller should step instead.
+
+HRESULT MachineX86Base::SetRunRange( 
+    Motion motion, 
+    Address pc, 
+    int notifier, 
+    RangeStepPtr& rangeStep )
+{
+    _ASSERT( rangeStep.Get() != NULL );
+    _ASSERT( rangeStep->ExitCount == 0 );
+
+    HRESULT         hr = S_OK;
+    AddressRange    range = rangeStep->InThunk ? rangeStep->ThunkRange : rangeStep->Range;
+    ExpectedEvent*  event = NULL;
+    std::vector<Address>    exits;
+
+    if ( (range.End < range.Begin) || (range.End - range.Begin >= MaxRunRangeSize) 
+        || (pc < range.Begin) || (pc > range.End) )
+        return S_FALSE;
+
+    if ( !rangeStep->Decoded 
+        || (rangeStep->DecodedRange.Begin != range.Begin) 
+        || (rangeStep->DecodedRange.End != range.End) )
+        DecodeRunRange( range, rangeStep.Get() );
+
+    if ( !rangeStep->Runnable || !IsRangeStart( rangeStep.Get(), pc ) )
+        return S_FALSE;
+
+    exits.assign( rangeStep->DecodedExits, rangeStep->DecodedExits + rangeStep->DecodedExitCount );
+
+    // stepping passes over other BPs in the range, so this has to stop at them too
+    for ( BPIterator it = mAddrTable->lower_bound( range.Begin ); 
+        (it != mAddrTable->end()) && (it->first <= range.End); 
+        it++ )
+    {
+        if ( IsRangeStart( rangeStep.Get(), it->first ) )
+            exits.push_back( it->first );
+    }
+
+    std::sort( exits.begin(), exits.end() );
+    exits.erase( std::unique( exits.begin(), exits.end() ), exits.end() );
+
+    if ( std::binary_search( exits.begin(), exits.end(), pc )
+        || exits.size() > (size_t) MaxRangeExits )
+        return S_FALSE;
+
+    event = mCurThread->PushExpected( Expect_BP, notifier );
+    if ( event == NULL )
+    {
+        hr = E_FAIL;
+        goto Error;
+    }
+
+    for ( size_t i = 0; i < exits.size(); i++ )
+    {
+        hr = SetBreakpointInternal( exits[i], false );
+        if ( FAILED( hr ) )
+            goto Error;
+
+        rangeStep->Exits[rangeStep->ExitCount] = exits[i];
+        rangeStep->ExitCount++;
+    }
+
+    event->Motion = motion;
+    event->Range = rangeStep.Detach();
+
+Error:
+    if ( FAILED( hr ) )
+    {
+        RemoveRangeExits( rangeStep.Get() );
+        if ( event != NULL )
+            mCurThread->PopExpected();
+    }
+    return hr;
+}
+
+// Decodes the range once for the whole range step, and keeps where its instructions 
+// start and the exits that don't depend on BPs. A range that can't be run is kept 
+// too, so that stepping through it doesn't decode it at each instruction.
+
+void MachineX86Base::DecodeRunRange( AddressRange range, RangeStep* rangeStep )
+{
+    HRESULT         hr = S_OK;
+    CpuSizeMode     cpu = Is64Bit() ? Cpu_64 : Cpu_32;
+    uint32_t        rangeSize = (uint32_t) (range.End - range.Begin + 1);
+    uint32_t        lenRead = 0;
+    uint32_t        lenUnreadable = 0;
+    std::vector<uint8_t>    mem( rangeSize + MAX_INSTRUCTION_SIZE - 1 );
+    std::vector<Address>    starts;
+    std::vector<Address>    exits;
+
+    rangeStep->Decoded = true;
+    rangeStep->Runnable = false;
+    rangeStep->DecodedRange = range;
+    rangeStep->DecodedExitCount = 0;
+    memset( rangeStep->DecodedStarts, 0, sizeof rangeStep->DecodedStarts );
+
+    // this unpatches all BPs in the buffer
+    hr = ReadCleanMemory( range.Begin, (uint32_t) mem.size(), lenRead, lenUnreadable, &mem[0] );
+    if ( FAILED( hr ) )
+        return;
+
+    if ( !GetRangeExits( &mem[0], lenRead, range, cpu, starts, exits ) 
+        || exits.size() > (size_t) MaxRangeExits )
+        return;
+
+    for ( size_t i = 0; i < starts.size(); i++ )
+    {
+        Address offset = starts[i] - range.Begin;
+
+        rangeStep->DecodedStarts[offset / 8] |= (uint8_t) (1 << (offset % 8));
+    }
+
+    for ( size_t i = 0; i < exits.size(); i++ )
+        rangeStep->DecodedExits[i] = exits[i];
+
+    rangeStep->DecodedExitCount = (int) exits.size();
+    rangeStep->Runnable = true;
+}
+
+HRESULT MachineX86Base::RemoveRangeExits( RangeStep* rangeStep )
+{
+    HRESULT hr = S_OK;
+
+    for ( int i = 0; i < rangeStep->ExitCount; i++ )
+    {
+        HRESULT hrRemove = RemoveBreakpointInternal( rangeStep->Exits[i], false );
+        if ( FAILED( hrRemove ) )
+            hr = hrRemove;
+    }
+
+    rangeStep->ExitCount = 0;
+    return hr;
+}
+
 HRESULT MachineX86Base::GetThreadContext( 
     uint32_t threadId, 
     uint32_t features, 
@@ -1693,13 +1973,15 @@ HRESULT MachineX86Base::ReadCleanMemory(
 
         // unpatch all BPs from the memory area we're returning
 
-        for ( BPAddressTable::iterator it = mAddrTable->begin();
-            it != mAddrTable->end();
+        BPAddressTable::iterator    itEnd = mAddrTable->upper_bound( endAddr );
+
+        for ( BPAddressTable::iterator it = mAddrTable->lower_bound( startAddr );
+            it != itEnd;
             it++ )
         {
             Breakpoint* bp = it->second;
 
-            if ( bp->IsPatched() && (it->first >= startAddr) && (it->first <= endAddr) )
+            if ( bp->IsPatched() )
             {
                 Address offset = it->first - startAddr;
                 buffer[ offset ] = bp->GetOriginalInstructionByte();
@@ -1731,13 +2013,15 @@ HRESULT MachineX86Base::WriteCleanMemory(
     Address startAddr = address;
     Address endAddr = address + length - 1;
 
-    for ( BPAddressTable::iterator it = mAddrTable->begin();
-        it != mAddrTable->end();
-        it++ )
+    // the table is ordered by address, so only look at the BPs in the range
+    BPAddressTable::iterator    itBegin = mAddrTable->lower_bound( startAddr );
+    BPAddressTable::iterator    itEnd = mAddrTable->upper_bound( endAddr );
+
+    for ( BPAddressTable::iterator it = itBegin; it != itEnd; it++ )
     {
         Breakpoint* bp = it->second;
 
-        if ( bp->IsPatched() && (it->first >= startAddr) && (it->first <= endAddr) )
+        if ( bp->IsPatched() )
         {
             Address offset = it->first - startAddr;
 
@@ -1759,15 +2043,11 @@ HRESULT MachineX86Base::WriteCleanMemory(
     if ( lengthWritten != length )
         return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
 
-    endAddr = address + lengthWritten - 1;
-
-    for ( BPAddressTable::iterator it = mAddrTable->begin();
-        it != mAddrTable->end();
-        it++ )
+    for ( BPAddressTable::iterator it = itBegin; it != itEnd; it++ )
     {
         Breakpoint* bp = it->second;
 
-        if ( bp->IsPatched() && (it->first >= startAddr) && (it->first <= endAddr) )
+        if ( bp->IsPatched() )
         {
             bp->SetOriginalInstructionByte( bp->GetTempInstructionByte() );
         }
@@ -11,6 +11,7 @@
 
 class BPAddressTable;
 class Breakpoint;
+class DecodedInstTable;
 class Thread;
 class ThreadX86Base;
 struct RangeStep;
@@ -31,6 +32,7 @@ class MachineX86Base : public IMachine
     Process*        mProcess;
     HANDLE          mhProcess;
     BPAddressTable* mAddrTable;
+    DecodedInstTable* mInstTable;
     uint32_t        mStoppedThreadId;
     bool            mStoppedOnException;
     bool            mStopped;
@@ -90,6 +92,7 @@ public:
     virtual void    OnStopped( uint32_t threadId );
     virtual HRESULT OnCreateThread( Thread* thread );
     virtual HRESULT OnExitThread( uint32_t threadId );
+    virtual void    OnUnloadModule( Address baseAddress );
     virtual HRESULT OnException( uint32_t threadId, const EXCEPTION_DEBUG_INFO* exceptRec, MachineResult& result );
     virtual HRESULT OnContinue();
     virtual void    OnDestroyProcess();
@@ -148,6 +151,8 @@ private:
         Address address, 
         InstructionType& type, 
         int& size );
+    void    ForgetInstructions( Address address, uint32_t length );
+    bool    IsRangeStepping();
 
     HRESULT PassBP( Address pc, 
         InstructionType instType, 
@@ -225,6 +230,9 @@ private:
         RangeStepPtr& rangeStep );
 
     HRESULT SetStepInstructionCore( Motion motion, RangeStepPtr& rangeStep, int notifier );
+    HRESULT SetRunRange( Motion motion, Address pc, int notifier, RangeStepPtr& rangeStep );
+    void    DecodeRunRange( AddressRange range, RangeStep* rangeStep );
+    HRESULT RemoveRangeExits( RangeStep* rangeStep );
 
     HRESULT SuspendOtherThreads( UINT32 threadId );
     HRESULT ResumeOtherThreads( UINT32 threadId );
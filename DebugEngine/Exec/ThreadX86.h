@@ -37,11 +37,26 @@ enum NotifyAction
     NotifyStepOut
 };
 
+const int       MaxRangeExits = 32;
+// longer ranges are stepped one instruction at a time
+const uint32_t  MaxRunRangeSize = 4096;
+
 struct RangeStep
 {
     AddressRange    Range;
     AddressRange    ThunkRange;
     bool            InThunk;
+    // BPs set on the instructions where a thread running through the range can leave it
+    int             ExitCount;
+    Address         Exits[MaxRangeExits];
+    // the thread comes back into the range after each exit, so it's decoded only once
+    bool            Decoded;
+    bool            Runnable;
+    AddressRange    DecodedRange;
+    int             DecodedExitCount;
+    Address         DecodedExits[MaxRangeExits];
+    // a bit for each byte in the range where an instruction starts
+    uint8_t         DecodedStarts[MaxRunRangeSize / 8];
 };
 
 struct ExpectedEvent
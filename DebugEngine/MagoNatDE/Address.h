@@ -0,0 +1,20 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace Mago
+{
+    typedef uint64_t Address64;
+
+    struct AddressRange64
+    {
+        Address64 Begin;
+        Address64 End;
+    };
+}
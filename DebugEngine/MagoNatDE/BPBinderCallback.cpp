@@ -28,6 +28,7 @@ namespace Mago
         PendingBreakpoint* pendingBP, 
         BPDocumentContext* docContext )
         :   mBinder( binder ),
+            mResolvedLines( NULL ),
             mPendingBP( pendingBP ),
             mDocContext( docContext ),
             mBoundBPCount( 0 ),
@@ -81,16 +82,18 @@ namespace Mago
         return true;
     }
 
-    HRESULT BPBinderCallback::BindToModule( Module* mod, Program* prog )
+    HRESULT BPBinderCallback::BindToModule( Module* mod, Program* prog, const std::list<MagoST::LineNumber>* lines )
     {
         _ASSERT( mod != NULL );
         _ASSERT( prog != NULL );
 
         mCurProg = prog;
         prog->QueryInterface( __uuidof( IDebugProgram2 ), (void**) &mCurProgInterface );
+        mResolvedLines = lines;
 
         AcceptModule( mod );
 
+        mResolvedLines = NULL;
         mCurProg.Release();
         mCurProgInterface.Release();
         return S_OK;
@@ -108,7 +111,10 @@ namespace Mago
         if ( binding->BoundBPs.size() > 0 )
             return true;
 
-        mBinder->Bind( mod, binding, this, err );
+        if ( mResolvedLines != NULL )
+            mBinder->BindLines( mod, binding, this, *mResolvedLines, err );
+        else
+            mBinder->Bind( mod, binding, this, err );
 
         // we got some new bound BPs
         if ( binding->BoundBPs.size() > 0 )
@@ -53,6 +53,25 @@ namespace Mago
     public:
         virtual ~BPBinder () {}
         virtual void Bind( Module* mod, ModuleBinding* binding, BPBoundBPMaker* maker, Error& err ) = 0;
+
+        // binders that resolve source lines can hand their request to ISession::BindLines, 
+        // so that a module's lines are looked up once for all pending BPs
+        virtual bool GetFileLineRequest( MagoST::FileLineRequest& request )
+        {
+            UNREFERENCED_PARAMETER( request );
+            return false;
+        }
+
+        virtual void BindLines( 
+            Module* mod, 
+            ModuleBinding* binding, 
+            BPBoundBPMaker* maker, 
+            const std::list<MagoST::LineNumber>& lines, 
+            Error& err )
+        {
+            UNREFERENCED_PARAMETER( lines );
+            Bind( mod, binding, maker, err );
+        }
     };
 
     class BPBinderCallback : public ProgramCallback, public ModuleCallback, public BPBoundBPMaker
@@ -66,6 +85,7 @@ namespace Mago
         CComPtr<IDebugProgram2>         mCurProgInterface;
         RefPtr<ErrorBreakpoint> mLastErrorBP;
         BPBinder*               mBinder;
+        const std::list<MagoST::LineNumber>*    mResolvedLines;
 
     public:
         BPBinderCallback( 
@@ -81,7 +101,7 @@ namespace Mago
         bool AcceptProgram( Program* prog );
         bool AcceptModule( Module* mod );
 
-        HRESULT BindToModule( Module* mod, Program* prog );
+        HRESULT BindToModule( Module* mod, Program* prog, const std::list<MagoST::LineNumber>* lines = NULL );
 
     private:
         virtual HRESULT MakeDocContext( MagoST::ISession* session, uint16_t compIx, uint16_t fileIx, const MagoST::LineNumber& lineNumber );
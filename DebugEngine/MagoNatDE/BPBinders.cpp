@@ -20,7 +20,8 @@ namespace Mago
 
     BPCodeFileLineBinder::BPCodeFileLineBinder(
         IDebugBreakpointRequest2* request )
-        :   mReqLineStart( 0 ),
+        :   mU8FilenameLen( 0 ),
+            mReqLineStart( 0 ),
             mReqLineEnd( 0 )
     {
         _ASSERT( request != NULL );
@@ -40,26 +41,60 @@ namespace Mago
         // AD7 lines are 0-based, DIA ones are 1-based
         mReqLineStart = posBegin.dwLine + 1;
         mReqLineEnd = posEnd.dwLine + 1;
+
+        // convert once, instead of every time we bind to a module
+        if ( mFilename != NULL )
+        {
+            hr = Utf16To8( mFilename, mFilename.Length(), mU8Filename.m_p, mU8FilenameLen );
+            if ( FAILED( hr ) )
+                mU8FilenameLen = 0;
+        }
     }
 
     void BPCodeFileLineBinder::Bind( Module* mod, ModuleBinding* binding, BPBoundBPMaker* maker, Error& err )
     {
-        HRESULT                 hr = S_OK;
-        CAutoVectorPtr<char>    u8FileName;
-        size_t                  u8FileNameLen = 0;
-
         PutDocError( err );
 
-        hr = Utf16To8( mFilename, wcslen( mFilename ), u8FileName.m_p, u8FileNameLen );
-        if ( FAILED( hr ) )
+        if ( mU8Filename == NULL )
             return;
 
         bool    foundExact = false;
         
-        foundExact = BindToFile( true, u8FileName, u8FileNameLen, mod, binding, maker, err );
+        foundExact = BindToFile( true, mU8Filename, mU8FilenameLen, mod, binding, maker, err );
 
         if ( !foundExact )
-            BindToFile( false, u8FileName, u8FileNameLen, mod, binding, maker, err );
+            BindToFile( false, mU8Filename, mU8FilenameLen, mod, binding, maker, err );
+    }
+
+    bool BPCodeFileLineBinder::GetFileLineRequest( MagoST::FileLineRequest& request )
+    {
+        if ( mU8Filename == NULL )
+            return false;
+        if ( (mReqLineStart > USHRT_MAX) || (mReqLineEnd > USHRT_MAX) )
+            return false;
+
+        request.FileName = mU8Filename;
+        request.FileNameLen = mU8FilenameLen;
+        request.LineStart = (uint16_t) mReqLineStart;
+        request.LineEnd = (uint16_t) mReqLineEnd;
+        return true;
+    }
+
+    void BPCodeFileLineBinder::BindLines( 
+        Module* mod, 
+        ModuleBinding* binding, 
+        BPBoundBPMaker* maker, 
+        const std::list<MagoST::LineNumber>& lines, 
+        Error& err )
+    {
+        RefPtr<MagoST::ISession>    session;
+
+        PutDocError( err );
+
+        if ( !mod->GetSymbolSession( session ) )
+            return;
+
+        AddBoundBPs( session, lines, mod, binding, maker, err );
     }
 
     bool BPCodeFileLineBinder::BindToFile( 
@@ -71,7 +106,6 @@ namespace Mago
         BPBoundBPMaker* maker, 
         Error& err )
     {
-        HRESULT                     hr = S_OK;
         RefPtr<MagoST::ISession>    session;
 
         if ( !mod->GetSymbolSession( session ) )
@@ -81,7 +115,20 @@ namespace Mago
         if( !session->FindLines( exactMatch, fileName, fileNameLen, mReqLineStart, mReqLineEnd, lines ) )
             return false;
 
-        for( std::list<MagoST::LineNumber>::iterator it = lines.begin(); it != lines.end(); ++it )
+        return AddBoundBPs( session, lines, mod, binding, maker, err );
+    }
+
+    bool BPCodeFileLineBinder::AddBoundBPs( 
+        MagoST::ISession* session, 
+        const std::list<MagoST::LineNumber>& lines, 
+        Module* mod, 
+        ModuleBinding* binding, 
+        BPBoundBPMaker* maker, 
+        Error& err )
+    {
+        HRESULT                     hr = S_OK;
+
+        for( std::list<MagoST::LineNumber>::const_iterator it = lines.begin(); it != lines.end(); ++it )
         {
             PutLineError( err );
 
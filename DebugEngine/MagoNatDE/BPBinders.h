@@ -15,6 +15,8 @@ namespace Mago
     class BPCodeFileLineBinder : public BPBinder
     {
         CComBSTR            mFilename;
+        CAutoVectorPtr<char>    mU8Filename;
+        size_t              mU8FilenameLen;
         DWORD               mReqLineStart;
         DWORD               mReqLineEnd;
 
@@ -22,12 +24,26 @@ namespace Mago
         BPCodeFileLineBinder( IDebugBreakpointRequest2* request );
 
         virtual void Bind( Module* mod, ModuleBinding* binding, BPBoundBPMaker* maker, Error& err );
+        virtual bool GetFileLineRequest( MagoST::FileLineRequest& request );
+        virtual void BindLines( 
+            Module* mod, 
+            ModuleBinding* binding, 
+            BPBoundBPMaker* maker, 
+            const std::list<MagoST::LineNumber>& lines, 
+            Error& err );
 
     private:
         void PutDocError( Error& err );
         void PutLineError( Error& err );
 
         bool BindToFile( bool exactMatch, const char* fileName, size_t fileNameLen, Module* mod, ModuleBinding* binding, BPBoundBPMaker* maker, Error& err );
+        bool AddBoundBPs( 
+            MagoST::ISession* session, 
+            const std::list<MagoST::LineNumber>& lines, 
+            Module* mod, 
+            ModuleBinding* binding, 
+            BPBoundBPMaker* maker, 
+            Error& err );
     };
 
 
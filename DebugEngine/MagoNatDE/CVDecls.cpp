@@ -798,7 +798,6 @@ namespace Mago
         HRESULT             hr = S_OK;
         MagoST::TypeHandle  childTH = { 0 };
         MagoST::TypeIndex   flistIndex = 0;
-        MagoST::TypeHandle  flistHandle = { 0 };
         CAutoVectorPtr<char>    u8Name;
         size_t                  u8NameLen = 0;
 
@@ -809,54 +808,10 @@ namespace Mago
         if ( !mSymInfo->GetFieldList( flistIndex ) )
             return E_NOT_FOUND;
 
-        for ( ; ; )
-        {
-            if ( !mSession->GetTypeFromTypeIndex( flistIndex, flistHandle ) )
-                return E_NOT_FOUND;
-
-            hr = mSession->FindChildType( flistHandle, u8Name, u8NameLen, childTH );
-            if ( hr == S_OK )
-                break;
-
-            MagoST::TypeScope       scope = { 0 };
-            MagoST::TypeHandle      baseTH = { 0 };
-            MagoST::SymInfoData     baseInfoData = { 0 };
-            MagoST::ISymbolInfo*    baseInfo = NULL;
-            MagoST::TypeIndex       baseClassTI = 0;
-            MagoST::TypeHandle      baseClassTH = { 0 };
-            MagoST::SymInfoData     baseClassInfoData = { 0 };
-            MagoST::ISymbolInfo*    baseClassInfo = NULL;
-
-            hr = mSession->SetChildTypeScope( flistHandle, scope );
-            if ( hr != S_OK )
-                return E_NOT_FOUND;
-
-            // base classes are first in the field list
-            bool hasNext = mSession->NextType( scope, baseTH );
-            mSession->EndTypeScope( scope );
-            if ( !hasNext )
-                return E_NOT_FOUND;
-
-            hr = mSession->GetTypeInfo( baseTH, baseInfoData, baseInfo );
-            if ( hr != S_OK )
-                return E_NOT_FOUND;
-
-            if ( baseInfo->GetSymTag() != MagoST::SymTagBaseClass )
-                return E_NOT_FOUND;
-
-            if ( !baseInfo->GetType( baseClassTI ) )
-                return E_NOT_FOUND;
-
-            if ( !mSession->GetTypeFromTypeIndex( baseClassTI, baseClassTH ) )
-                return E_NOT_FOUND;
-
-            hr = mSession->GetTypeInfo( baseClassTH, baseClassInfoData, baseClassInfo );
-            if ( hr != S_OK )
-                return E_NOT_FOUND;
-
-            if ( !baseClassInfo->GetFieldList( flistIndex ) )
-                return E_NOT_FOUND;
-        }
+        // the session keeps a table of the members, including those of base classes
+        hr = mSession->FindMemberType( flistIndex, u8Name, u8NameLen, childTH );
+        if ( hr != S_OK )
+            return E_NOT_FOUND;
 
         if ( mSymInfo->GetSymTag() == MagoST::SymTagEnum )
         {
@@ -347,27 +347,24 @@ namespace Mago
     BSTR CodeContext::GetFunctionName()
     {
         HRESULT hr = S_OK;
-        MagoST::SymInfoData         infoData = { 0 };
-        MagoST::ISymbolInfo*        symInfo = NULL;
         RefPtr<MagoST::ISession>    session;
-        SymString                   pstrName;
+        std::string                 name;
+        uint32_t                    symOff = 0;
         CComBSTR                    bstrName;
 
-        hr = FindFunction();
-        if ( FAILED( hr ) )
+        if ( mModule == NULL )
             return NULL;
 
         if ( !mModule->GetSymbolSession( session ) )
             return NULL;
 
-        hr = session->GetSymbolInfo( mFuncSH, infoData, symInfo );
+        // the same symbol FindFunction finds, but the session caches the name,
+        // which saves a lot when disassembly is symbolized
+        hr = session->FindGlobalSymbolNameByAddr( mAddr, false, name, symOff );
         if ( FAILED( hr ) )
             return NULL;
 
-        if ( !symInfo->GetName( pstrName ) )
-            return NULL;
-
-        hr = Utf8To16( pstrName.GetName(), pstrName.GetLength(), bstrName.m_str );
+        hr = Utf8To16( name.data(), name.size(), bstrName.m_str );
         if ( FAILED( hr ) )
             return NULL;
 
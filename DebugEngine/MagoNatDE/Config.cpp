@@ -265,6 +265,16 @@ bool readMagoOptions()
     else
         gOptions.callDebuggerUseMagoGC = true;
 
+    if ( GetRegValue( hKey, L"useSymbolCache", &val ) == S_OK )
+        gOptions.useSymbolCache = val != 0;
+    else
+        gOptions.useSymbolCache = true;
+
+    if ( GetRegValue( hKey, L"cacheGlobalsOnLoad", &val ) == S_OK )
+        gOptions.cacheGlobalsOnLoad = val != 0;
+    else
+        gOptions.cacheGlobalsOnLoad = false;
+
     MagoEE::gShowVTable = gOptions.showVTable;
     MagoEE::gMaxArrayLength = gOptions.maxArrayElements;
     MagoEE::gHideReferencePointers = gOptions.hideReferencePointers;
@@ -283,3 +293,19 @@ bool readMagoOptions()
 }
 
 static bool initMagoOption = readMagoOptions();
+
+bool GetSymbolCacheDir( std::wstring& dir )
+{
+    if ( !gOptions.useSymbolCache )
+        return false;
+
+    wchar_t tempPath[MAX_PATH] = L"";
+    DWORD   len = GetTempPath( _countof( tempPath ), tempPath );
+
+    if ( (len == 0) || (len >= _countof( tempPath )) )
+        return false;
+
+    dir = tempPath;
+    dir.append( L"MagoSymbolCache" );
+    return true;
+}
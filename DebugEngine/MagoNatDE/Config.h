@@ -60,12 +60,17 @@ struct MagoOptions
     bool callDebuggerUseMagoGC;
     uint8_t callPropertyMethods;
     int  maxArrayElements;
+    bool useSymbolCache;
+    bool cacheGlobalsOnLoad;
 };
 
 extern MagoOptions gOptions;
 
 bool readMagoOptions();
 
+// returns false if symbol indexes shouldn't be cached on disk
+bool GetSymbolCacheDir( std::wstring& dir );
+
 const wchar_t* GetString( DWORD strId );
 bool GetString( DWORD strId, CString& str );
 
@@ -693,7 +693,7 @@ namespace Mago
         for ( int j = 0; j < MAX_AA_SEARCH_NODES; bucketIndex = ( bucketIndex + ++j ) % bb.buckets.length )
         {
             uint64_t    bucketHash;
-            HRESULT hr = ReadAddress( bb.buckets.ptr, 2 * bucketIndex, bucketHash );
+            HRESULT hr = ReadBucket_V1( bb.buckets.ptr, bucketIndex, bucketHash, aaAAddr );
             if ( FAILED( hr ) )
                 return hr;
 
@@ -703,10 +703,6 @@ namespace Mago
             if ( bucketHash != hash )
                 continue;
 
-            hr = ReadAddress( bb.buckets.ptr, 2 * bucketIndex + 1, aaAAddr );
-            if ( FAILED( hr ) )
-                return hr;
-
             MagoEE::DataValue nodeKey = { 0 };
             bool     found = false;
 
@@ -972,6 +968,38 @@ namespace Mago
         return S_OK;
     }
 
+    HRESULT DRuntime::ReadBucket_V1( Address64 baseAddr, uint64_t index, uint64_t& hash, uint64_t& entry )
+    {
+        // the hash and the entry pointer are read together
+        HRESULT hr = S_OK;
+        uint64_t addr = baseAddr + (index * 2 * mPtrSize);
+
+        if ( mPtrSize == 4 )
+        {
+            uint32_t    bucket32[2];
+
+            hr = ReadMemory( addr, sizeof bucket32, bucket32 );
+            if ( FAILED( hr ) )
+                return hr;
+
+            hash = bucket32[0];
+            entry = bucket32[1];
+        }
+        else
+        {
+            uint64_t    bucket64[2];
+
+            hr = ReadMemory( addr, sizeof bucket64, bucket64 );
+            if ( FAILED( hr ) )
+                return hr;
+
+            hash = bucket64[0];
+            entry = bucket64[1];
+        }
+
+        return S_OK;
+    }
+
     HRESULT DRuntime::ReadDArray( Address64 addr, DArray64& darray )
     {
         HRESULT hr = S_OK;
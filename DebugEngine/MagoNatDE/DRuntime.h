@@ -102,6 +102,7 @@ namespace Mago
         HRESULT ReadTypeInfoStruct( Address64 addr, TypeInfo_Struct64& ti );
         HRESULT ReadTypeInfoClass( Address64 addr, TypeInfo_Class64& ti );
         HRESULT ReadAddress( Address64 baseAddr, uint64_t index, uint64_t& ptrValue );
+        HRESULT ReadBucket_V1( Address64 baseAddr, uint64_t index, uint64_t& hash, uint64_t& entry );
         HRESULT ReadDArray( Address64 addr, DArray64& darray );
         HRESULT ReadThrowable( Address64 addr, Throwable64& throwable );
 
@@ -162,6 +162,19 @@ namespace Mago
             buffer );
     }
 
+    HRESULT DebuggerProxy::ReadMemoryBatch( 
+        ICoreProcess* process, 
+        uint32_t count, 
+        MemoryReadRange* ranges, 
+        uint8_t* buffer )
+    {
+        if ( process->GetProcessType() != CoreProcess_Local )
+            return E_FAIL;
+
+        // there's no round trip to save
+        return ReadMemoryRanges( this, process, count, ranges, buffer );
+    }
+
     HRESULT DebuggerProxy::WriteMemory( 
         ICoreProcess* process, 
         Address64 address,
@@ -53,6 +53,12 @@ namespace Mago
             uint32_t& lengthUnreadable, 
             uint8_t* buffer );
 
+        HRESULT ReadMemoryBatch( 
+            ICoreProcess* process, 
+            uint32_t count, 
+            MemoryReadRange* ranges, 
+            uint8_t* buffer );
+
         HRESULT WriteMemory( 
             ICoreProcess* process, 
             Address64 address,
@@ -542,7 +542,7 @@ namespace Mago
 
         archData = program->GetCoreProcess()->GetArchData();
 
-        hr = mInstCache.Init( program, debugger, archData->GetPointerSize() );
+        hr = mInstCache.Init( program, archData->GetPointerSize() );
         if ( FAILED( hr ) )
             return hr;
 
@@ -12,6 +12,7 @@
 #include "EventCallback.h"
 #include "Events.h"
 #include "PendingBreakpoint.h"
+#include "Module.h"
 #include "ComEnumWithCount.h"
 #include "BpResolutionLocation.h"
 #include "DRuntime.h"
@@ -68,6 +69,7 @@ namespace Mago
 
     void Engine::FinalRelease()
     {
+        mSymbolLoader.Shutdown();
     }
 
 
@@ -734,6 +736,7 @@ Error:
         if ( mProgs.size() > 0 )
             return;
 
+        mSymbolLoader.Shutdown();
         mDebugger.Shutdown();
         mRemoteDebugger->Shutdown();
         // TODO: this should probably be guarded, too
@@ -779,6 +782,12 @@ Error:
         pendingBP->Dispose();
     }
 
+    bool Engine::HasPendingBPs()
+    {
+        GuardedArea guard( mPendingBPGuard );
+        return mBPs.size() > 0;
+    }
+
     DWORD Engine::GetNextBPId()
     {
         mLastBPId++;
@@ -814,19 +823,62 @@ Error:
         mBindBPGuard.Leave();
     }
 
+    SymbolLoader& Engine::GetSymbolLoader()
+    {
+        return mSymbolLoader;
+    }
+
     HRESULT Engine::BindPendingBPsToModule( Module* mod, Program* prog )
     {
         _ASSERT( mod != NULL );
 
         HRESULT     hr = S_OK;
         GuardedArea guard( mPendingBPGuard );
+        RefPtr<MagoST::ISession>            session;
+        std::vector<PendingBreakpoint*>     lineBPs;
+        std::vector<MagoST::FileLineRequest> requests;
+        std::vector<std::list<MagoST::LineNumber>> lines;
+
+        // gather the file/line BPs, so the module's line info is searched once for all of them
+
+        if ( mod->GetSymbolSession( session ) )
+        {
+            for ( BPMap::iterator it = mBPs.begin();
+                it != mBPs.end();
+                it++ )
+            {
+                MagoST::FileLineRequest request = { 0 };
+
+                if ( it->second->GetFileLineRequest( request ) )
+                {
+                    lineBPs.push_back( it->second.Get() );
+                    requests.push_back( request );
+                }
+            }
+
+            if ( requests.size() > 0 )
+                session->BindLines( requests, lines );
+
+            // fall back to binding each BP on its own
+            if ( lines.size() != requests.size() )
+                lineBPs.clear();
+        }
+
+        // lineBPs is in the same order as mBPs
+        size_t      lineIndex = 0;
 
         for ( BPMap::iterator it = mBPs.begin();
             it != mBPs.end();
             it++ )
         {
             // TODO: what about error code?
-            it->second->BindToModule( mod, prog );
+            if ( (lineIndex < lineBPs.size()) && (lineBPs[lineIndex] == it->second.Get()) )
+            {
+                it->second->BindToModule( mod, prog, &lines[lineIndex] );
+                lineIndex++;
+            }
+            else
+                it->second->BindToModule( mod, prog );
         }
 
         return hr;
@@ -14,6 +14,7 @@
 #include "DebuggerProxy.h"
 #include "RemoteDebuggerProxy.h"
 #include "ExceptionTable.h"
+#include "SymbolLoader.h"
 
 enum LAUNCH_FLAGS_MAGO
 {
@@ -50,6 +51,7 @@ namespace Mago
         Guard               mPendingBPGuard;
         Guard               mExceptionGuard;
         EngineExceptionTable    mExceptionInfos;
+        SymbolLoader        mSymbolLoader;
 
     public:
         Engine();
@@ -134,6 +136,7 @@ namespace Mago
         void DeleteProgram( Program* prog );
         HRESULT AddPendingBP( PendingBreakpoint* pendingBP );
         void OnPendingBPDelete( PendingBreakpoint* pendingBP );
+        bool HasPendingBPs();
         DWORD GetNextModuleId();
         void ForeachProgram( ProgramCallback* callback );
 
@@ -150,6 +153,8 @@ namespace Mago
         void BeginBindBP();
         void EndBindBP();
 
+        SymbolLoader& GetSymbolLoader();
+
     private:
         HRESULT EnsurePollThreadRunning();
         void ShutdownIfNeeded();
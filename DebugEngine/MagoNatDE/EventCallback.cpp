@@ -79,6 +79,10 @@ namespace Mago
 
         ad7Callback = program->GetCallback();
 
+        // the program stays stopped until it's told to run, so memory can be cached
+        if ( eventBase->IsStopping() )
+            program->EnableMemoryCache( true );
+
         hr = eventBase->Send( ad7Callback, ad7Engine, ad7Prog, ad7Thread );
 
         return hr;
@@ -167,9 +171,24 @@ namespace Mago
 
     void EventCallback::OnModuleLoad( DWORD uniquePid, ICoreModule* module )
     {
+        RefPtr<Program>             prog;
+        RefPtr<Module>              mod;
+
         mEngine->BeginBindBP();
         OnModuleLoadInternal( uniquePid, module );
         mEngine->EndBindBP();
+
+        // Once the loader breakpoint was hit, a module runs its initializers as soon as 
+        // we return. So, wait for its symbols, if a BP might have to be bound in there.
+        // Before that, OnLoadComplete waits for all the modules.
+
+        if ( mEngine->FindProgram( uniquePid, prog )
+            && prog->GetLoadComplete()
+            && mEngine->HasPendingBPs()
+            && prog->FindModule( module->GetImageBase(), mod ) )
+        {
+            WaitForModuleSymbols( prog, mod );
+        }
     }
 
     void EventCallback::OnModuleUnload( DWORD uniquePid, Address64 baseAddr )
@@ -200,27 +219,82 @@ namespace Mago
         if ( FAILED( hr ) )
             return;
 
-        hr = mod->LoadSymbols( false );
-        // later we'll check if symbols were loaded
+        // Symbols are read on the loader threads, so the module load event can go out now. 
+        // Pending BPs are bound to the module when its symbols are ready.
 
-        prog->UpdateAAVersion( mod.Get() );
+        bool        queued = false;
 
-        hr = mEngine->BindPendingBPsToModule( mod.Get(), prog.Get() );
+        hr = mod->BeginLoadSymbols();
+        if ( SUCCEEDED( hr ) )
+            hr = mEngine->GetSymbolLoader().QueueLoad( uniquePid, mod, this );
+
+        if ( SUCCEEDED( hr ) )
+        {
+            queued = true;
+        }
+        else
+        {
+            // later we'll check if symbols were loaded
+            mod->LoadSymbols( false );
+            mod->EndLoadSymbols();
+        }
 
         hr = MakeCComObject( event );
-        if ( FAILED( hr ) )
+        if ( SUCCEEDED( hr ) )
+            hr = mod->QueryInterface( __uuidof( IDebugModule2 ), (void**) &mod2 );
+
+        if ( SUCCEEDED( hr ) )
+        {
+            // TODO: message
+            event->Init( mod2, NULL, true );
+
+            SendEvent( event.Get(), prog.Get(), NULL );
+        }
+
+        if ( !queued )
+            OnSymbolsLoadedInternal( prog, mod );
+    }
+
+    void EventCallback::OnSymbolsLoaded( DWORD uniquePid, Module* mod )
+    {
+        _ASSERT( mod != NULL );
+
+        RefPtr<Program>             prog;
+
+        mEngine->BeginBindBP();
+
+        if ( mEngine->FindProgram( uniquePid, prog ) )
+            OnSymbolsLoadedInternal( prog, mod );
+
+        mEngine->EndBindBP();
+    }
+
+    void EventCallback::OnSymbolsLoadedInternal( Program* prog, Module* mod )
+    {
+        Log::LogMessage( "EventCallback::OnSymbolsLoaded\n" );
+
+        // The caller holds the bind BP guard, which keeps the module from being unloaded 
+        // while we bind to it. Both a loader thread and the debug event thread can get 
+        // here for the same module, so only the first one does the work.
+
+        if ( mod->GetSymbolsBound() )
             return;
 
-        hr = mod->QueryInterface( __uuidof( IDebugModule2 ), (void**) &mod2 );
-        if ( FAILED( hr ) )
+        HRESULT     hr = S_OK;
+        RefPtr<Module>              curMod;
+
+        // it might have been unloaded while its symbols were loading
+        if ( !prog->FindModule( mod->GetAddress(), curMod ) || (curMod.Get() != mod) )
+        {
+            mod->SetSession( NULL );
             return;
+        }
 
-        // TODO: message
-        event->Init( mod2, NULL, true );
+        mod->SetSymbolsBound();
 
-        SendEvent( event.Get(), prog.Get(), NULL );
+        prog->UpdateAAVersion( mod );
 
-        //-------------------------
+        hr = mEngine->BindPendingBPsToModule( mod, prog );
 
         RefPtr<SymbolSearchEvent>       symEvent;
         CComPtr<IDebugModule3>          mod3;
@@ -247,7 +321,41 @@ namespace Mago
 
         symEvent->Init( mod3, msg.m_str, flags );
 
-        hr = SendEvent( symEvent.Get(), prog.Get(), NULL );
+        hr = SendEvent( symEvent.Get(), prog, NULL );
+    }
+
+    class PendingSymbolsCallback : public ModuleCallback
+    {
+    public:
+        std::vector< RefPtr<Module> >   Modules;
+
+        bool AcceptModule( Module* mod )
+        {
+            Modules.push_back( mod );
+            return true;
+        }
+    };
+
+    void EventCallback::WaitForPendingSymbols( Program* prog )
+    {
+        PendingSymbolsCallback  callback;
+
+        prog->ForeachModule( &callback );
+
+        for ( size_t i = 0; i < callback.Modules.size(); i++ )
+        {
+            WaitForModuleSymbols( prog, callback.Modules[i] );
+        }
+    }
+
+    void EventCallback::WaitForModuleSymbols( Program* prog, Module* mod )
+    {
+        // don't hold the bind BP guard while waiting, the loader threads need it
+        mod->WaitForSymbols();
+
+        mEngine->BeginBindBP();
+        OnSymbolsLoadedInternal( prog, mod );
+        mEngine->EndBindBP();
     }
 
     void EventCallback::OnModuleUnloadInternal( DWORD uniquePid, Address64 baseAddr )
@@ -346,6 +454,11 @@ namespace Mago
         if ( !prog->FindThread( threadId, thread ) )
             return;
 
+        // the static DLLs run their initializers after this, 
+        // so make sure that all modules have their symbols and BPs
+        prog->SetLoadComplete();
+        WaitForPendingSymbols( prog );
+
         hr = MakeCComObject( event );
         if ( FAILED( hr ) )
             return;
@@ -392,6 +505,8 @@ namespace Mago
         if ( !prog->FindThread( threadId, thread ) )
             return RunMode_Break;
 
+        WaitForPendingSymbols( prog );
+
         prog->NotifyException( firstChance, exceptRec );
 
         hr = MakeCComObject( event );
@@ -568,6 +683,8 @@ namespace Mago
         if ( !prog->FindThread( threadId, thread ) )
             return RunMode_Run;
 
+        WaitForPendingSymbols( prog );
+
         runMode = OnBreakpointInternal( prog, thread, address, embedded );
 
         // If we stopped because of a regular BP before reaching the entry point, 
@@ -602,6 +719,8 @@ namespace Mago
         if ( !prog->FindThread( threadId, thread ) )
             return;
 
+        WaitForPendingSymbols( prog );
+
         hr = MakeCComObject( event );
         if ( FAILED( hr ) )
             return;
@@ -632,6 +751,8 @@ namespace Mago
         if ( !prog->FindModuleContainingAddress( address, mod ) )
             return ProbeRunMode_Run;
 
+        WaitForModuleSymbols( prog, mod );
+
         if ( !mod->GetSymbolSession( session ) )
             return ProbeRunMode_Run;
 
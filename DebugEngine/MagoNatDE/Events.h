@@ -18,6 +18,8 @@ namespace Mago
             IDebugEngine2* engine, 
             IDebugProgram2* program, 
             IDebugThread2* thread ) = 0;
+
+        virtual bool IsStopping() = 0;
     };
 
     template <class T, enum_EVENTATTRIBUTES TAttr = EVENT_ASYNCHRONOUS>
@@ -52,6 +54,11 @@ namespace Mago
         {
             return callback->Event( engine, NULL, program, thread, (IDebugEvent2*) this, __uuidof( T ), TAttr );
         }
+
+        virtual bool IsStopping()
+        {
+            return (TAttr & EVENT_STOPPING) != 0;
+        }
     };
 
     class EngineCreateEvent : public EventImpl<IDebugEngineCreateEvent2>
@@ -90,28 +90,48 @@ namespace Mago
         if ( FAILED( hr ) )
             return hr;
 
-        hr = MagoEE::ParseText( pszCode, mModuleContext->GetTypeEnv(), mModuleContext->GetStringTable(), parsedExpr.Ref() );
+        hr = ParseBoundText( pszCode, nRadix, parsedExpr );
         if ( FAILED( hr ) )
         {
             MagoEE::EED::GetErrorString( hr, *pbstrError );
             return hr;
         }
 
-        MagoEE::EvalOptions options = MagoEE::EvalOptions::defaults;
-        options.Radix = (uint8_t) nRadix;
+        hr = expr->Init( parsedExpr, pszCode, this );
+        if ( FAILED( hr ) )
+            return hr;
 
-        hr = parsedExpr->Bind( options, this );
+        *ppExpr = expr.Detach();
+        return S_OK;
+    }
+
+    HRESULT ExprContext::ParseBoundText( 
+            LPCOLESTR text,
+            UINT radix,
+            RefPtr<MagoEE::IEEDParsedExpr>& parsedExpr )
+    {
+        HRESULT hr = S_OK;
+        ModuleContext::BoundExprKey     key;
+
+        // binding only looks up symbols, and the values are read when evaluating,
+        // so an expression bound in the same scope can be used again
+        MakeBoundExprKey( text, radix, key );
+
+        if ( mModuleContext->FindBoundExpr( key, parsedExpr ) )
+            return S_OK;
+
+        hr = MagoEE::ParseText( text, mModuleContext->GetTypeEnv(), mModuleContext->GetStringTable(), parsedExpr.Ref() );
         if ( FAILED( hr ) )
-        {
-            MagoEE::EED::GetErrorString( hr, *pbstrError );
             return hr;
-        }
 
-        hr = expr->Init( parsedExpr, pszCode, this );
+        MagoEE::EvalOptions options = MagoEE::EvalOptions::defaults;
+        options.Radix = (uint8_t) radix;
+
+        hr = parsedExpr->Bind( options, this );
         if ( FAILED( hr ) )
             return hr;
 
-        *ppExpr = expr.Detach();
+        mModuleContext->AddBoundExpr( key, parsedExpr );
         return S_OK;
     }
 
@@ -874,10 +894,8 @@ namespace Mago
         uint32_t        len = sizeToRead;
         uint32_t        lenRead = 0;
         uint32_t        lenUnreadable = 0;
-        IDebuggerProxy* debuggerProxy = mProgram->GetDebuggerProxy();
 
-        hr = debuggerProxy->ReadMemory(
-            mProgram->GetCoreProcess(),
+        hr = mProgram->ReadMemory(
             (Address64) addr,
             len,
             lenRead,
@@ -900,10 +918,8 @@ namespace Mago
         HRESULT         hr = S_OK;
         uint32_t        len = sizeToWrite;
         uint32_t        lenWritten = 0;
-        IDebuggerProxy* debuggerProxy = mProgram->GetDebuggerProxy();
 
-        hr = debuggerProxy->WriteMemory(
-            mProgram->GetCoreProcess(),
+        hr = mProgram->WriteMemory(
             (Address64) addr,
             len,
             lenWritten,
@@ -972,6 +988,24 @@ namespace Mago
         uint16_t    sec = 0;
         uint32_t    offset = 0;
         uint32_t    symOff = 0;
+
+        if ( pType == nullptr )
+        {
+            // only the name, which the session caches
+            std::string name;
+            HRESULT hr = session->FindGlobalSymbolNameByAddr( addr, exact, name, symOff );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if( pOffset )
+                *pOffset = symOff;
+            else if ( symOff != 0 )
+                return E_NOT_FOUND;
+
+            symName = MagoEE::to_wstring( name.data(), name.size() );
+            return S_OK;
+        }
+
         HRESULT hr = session->FindGlobalSymbolByAddr( addr, exact, symHandle, sec, offset, symOff );
         if ( FAILED( hr ) )
             return hr;
@@ -1050,8 +1084,7 @@ namespace Mago
         if ( !mModuleContext || mModuleContext->mModule != module )
         {
             mModuleContext = nullptr;
-            MakeCComObject( mModuleContext );
-            HRESULT hr = mModuleContext->Init( module, thread->GetProgram() );
+            HRESULT hr = module->GetModuleContext( thread->GetProgram(), mModuleContext );
             if( FAILED( hr ) )
                 return hr;
         }
@@ -1094,6 +1127,63 @@ namespace Mago
         return S_OK;
     }
 
+    bool ModuleContext::FindBoundExpr( const BoundExprKey& key, RefPtr<MagoEE::IEEDParsedExpr>& parsedExpr )
+    {
+        GuardedArea guard( mBoundExprGuard );
+
+        auto it = mBoundExprMap.find( key );
+        if ( it == mBoundExprMap.end() )
+            return false;
+
+        mBoundExprs.splice( mBoundExprs.begin(), mBoundExprs, it->second );
+        parsedExpr = it->second->second;
+        return true;
+    }
+
+    void ModuleContext::AddBoundExpr( const BoundExprKey& key, MagoEE::IEEDParsedExpr* parsedExpr )
+    {
+        GuardedArea guard( mBoundExprGuard );
+
+        auto it = mBoundExprMap.find( key );
+        if ( it != mBoundExprMap.end() )
+        {
+            mBoundExprs.splice( mBoundExprs.begin(), mBoundExprs, it->second );
+            it->second->second = parsedExpr;
+            return;
+        }
+
+        if ( mBoundExprMap.size() >= MaxBoundExprs )
+        {
+            mBoundExprMap.erase( mBoundExprs.back().first );
+            mBoundExprs.pop_back();
+        }
+
+        mBoundExprs.push_front( BoundExprItem( key, parsedExpr ) );
+        mBoundExprMap[key] = mBoundExprs.begin();
+    }
+
+    // only the handle's fields, so that padding a session didn't fill in doesn't matter
+    static void AppendSymHandle( std::string& scope, const MagoST::SymHandle& handle )
+    {
+        scope.append( (const char*) &handle.unused1, sizeof handle.unused1 );
+        scope.append( (const char*) &handle.unused2, sizeof handle.unused2 );
+    }
+
+    void ExprContext::MakeBoundExprKey( LPCOLESTR text, UINT radix, ModuleContext::BoundExprKey& key )
+    {
+        std::string&    scope = key.second;
+        uint8_t         radixByte = (uint8_t) radix;
+
+        key.first = text;
+
+        // binding only sees the radix as a byte
+        scope.append( (const char*) &radixByte, sizeof radixByte );
+        AppendSymHandle( scope, mFuncSH );
+
+        for ( auto it = mBlockSH.begin(); it != mBlockSH.end(); it++ )
+            AppendSymHandle( scope, *it );
+    }
+
     Thread* ExprContext::GetThread()
     {
         return mThread.Get();
@@ -58,6 +58,22 @@ namespace Mago
                  std::pair<RefPtr<MagoEE::Type>, MagoEE::Address>> mDebugFuncCache;
         std::map<MagoST::TypeIndex, RefPtr<MagoEE::Type>> mTypeCache;
 
+    public:
+        // expression text, then the radix and scope it was bound in
+        typedef std::pair<std::wstring, std::string>    BoundExprKey;
+
+    private:
+        typedef std::pair<BoundExprKey, RefPtr<MagoEE::IEEDParsedExpr>> BoundExprItem;
+        typedef std::list<BoundExprItem>                BoundExprList;
+
+        static const size_t MaxBoundExprs = 256;
+
+        // bound expressions, most recently used first, so that watches aren't parsed
+        // and bound again each time they're refreshed
+        BoundExprList                   mBoundExprs;
+        std::map<BoundExprKey, BoundExprList::iterator> mBoundExprMap;
+        Guard                           mBoundExprGuard;
+
         DECLARE_NOT_AGGREGATABLE(ModuleContext)
         BEGIN_COM_MAP(ModuleContext)
         END_COM_MAP()
@@ -71,6 +87,9 @@ namespace Mago
     public:
         HRESULT Init( Module* module, Program* program );
 
+        bool FindBoundExpr( const BoundExprKey& key, RefPtr<MagoEE::IEEDParsedExpr>& parsedExpr );
+        void AddBoundExpr( const BoundExprKey& key, MagoEE::IEEDParsedExpr* parsedExpr );
+
         // IValueBinder implementations forwarded from ExprContext
         virtual HRESULT FindObjectType( MagoEE::Declaration* decl, const wchar_t* name, MagoEE::Type*& type );
         virtual HRESULT FindDebugFunc(const wchar_t* name, MagoEE::ITypeStruct* ts, MagoEE::Type*& type, MagoEE::Address& fnaddr);
@@ -255,6 +274,12 @@ namespace Mago
             BSTR* pbstrError,
             UINT* pichError );
 
+        // parses and binds the text in this scope, or finds it bound already
+        HRESULT ParseBoundText(
+            LPCOLESTR text,
+            UINT radix,
+            RefPtr<MagoEE::IEEDParsedExpr>& parsedExpr );
+
         HRESULT Evaluate(
             MagoEE::Declaration* decl,
             MagoEE::DataObject& resultObj);
@@ -329,6 +354,8 @@ namespace Mago
         HRESULT FindLocalSymbol( const char* name, size_t nameLen, MagoST::SymHandle& localSH );
         HRESULT FindGlobalSymbol( const char* name, size_t nameLen, MagoEE::Declaration*& decl, uint32_t findFlags );
         HRESULT FindClosureSymbol( const char* name, size_t nameLen, MagoEE::Declaration*& decl );
+
+        void MakeBoundExprKey( LPCOLESTR text, UINT radix, ModuleContext::BoundExprKey& key );
     };
 
 }
@@ -8,6 +8,9 @@
 #pragma once
 
 
+struct LaunchInfo;
+
+
 namespace Mago
 {
     class IRegisterSet;
@@ -15,6 +18,18 @@ namespace Mago
     class ICoreThread;
 
 
+    struct MemoryReadRange
+    {
+        Address64   Begin;
+        uint32_t    Length;
+
+        // filled in by the read, like the arguments of ReadMemory
+        HRESULT     Result;
+        uint32_t    LengthRead;
+        uint32_t    LengthUnreadable;
+    };
+
+
     class IDebuggerProxy
     {
     public:
@@ -34,6 +49,14 @@ namespace Mago
             uint32_t& lengthUnreadable, 
             uint8_t* buffer ) = 0;
 
+        // Reads the ranges into the buffer, one after the other.
+        // A range that can't be read doesn't stop the others.
+        virtual HRESULT ReadMemoryBatch( 
+            ICoreProcess* process, 
+            uint32_t count, 
+            MemoryReadRange* ranges, 
+            uint8_t* buffer ) = 0;
+
         virtual HRESULT WriteMemory( 
             ICoreProcess* process, 
             Address64 address,
@@ -65,4 +88,98 @@ namespace Mago
             uint32_t& sizeRead, 
             uint8_t* pdata ) = 0;
     };
+
+
+    // for debugger proxies that can only read one range at a time
+    inline HRESULT ReadMemoryRanges( 
+        IDebuggerProxy* debugger, 
+        ICoreProcess* process, 
+        uint32_t count, 
+        MemoryReadRange* ranges, 
+        uint8_t* buffer )
+    {
+        uint8_t* dest = buffer;
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            ranges[i].LengthRead = 0;
+            ranges[i].LengthUnreadable = 0;
+            ranges[i].Result = debugger->ReadMemory( 
+                process, 
+                ranges[i].Begin, 
+                ranges[i].Length, 
+                ranges[i].LengthRead, 
+                ranges[i].LengthUnreadable, 
+                dest );
+
+            dest += ranges[i].Length;
+        }
+
+        return S_OK;
+    }
+
+
+    // For debugger proxies that read many ranges in one call, but only so many at a time.
+    // Calls readBatch( count, ranges, length, buffer ) with as many ranges as fit in maxCount
+    // and maxLength. A range too big for a batch is read on its own.
+    //
+    // readBatch returns E_NOTIMPL if the other end can't read batches. Then noBatch is set,
+    // and these ranges and all the ranges after them are read one at a time.
+    template <class ReadBatch>
+    HRESULT ReadMemoryInBatches( 
+        IDebuggerProxy* debugger, 
+        ICoreProcess* process, 
+        uint32_t count, 
+        MemoryReadRange* ranges, 
+        uint8_t* buffer, 
+        uint32_t maxCount, 
+        uint32_t maxLength, 
+        bool& noBatch, 
+        ReadBatch readBatch )
+    {
+        uint32_t    first = 0;
+        uint8_t*    firstBuf = buffer;
+
+        while ( first < count )
+        {
+            if ( noBatch )
+                return ReadMemoryRanges( debugger, process, count - first, &ranges[first], firstBuf );
+
+            uint32_t    end = first;
+            uint32_t    length = 0;
+
+            while ( (end < count) 
+                && (end - first < maxCount)
+                && (ranges[end].Length <= maxLength - length) )
+            {
+                length += ranges[end].Length;
+                end++;
+            }
+
+            if ( end == first )
+            {
+                HRESULT hr = ReadMemoryRanges( debugger, process, 1, &ranges[first], firstBuf );
+                if ( FAILED( hr ) )
+                    return hr;
+
+                firstBuf += ranges[first].Length;
+                first++;
+                continue;
+            }
+
+            HRESULT hr = readBatch( end - first, &ranges[first], length, firstBuf );
+            if ( hr == E_NOTIMPL )
+            {
+                noBatch = true;
+                continue;
+            }
+            if ( FAILED( hr ) )
+                return hr;
+
+            firstBuf += length;
+            first = end;
+        }
+
+        return S_OK;
+    }
 }
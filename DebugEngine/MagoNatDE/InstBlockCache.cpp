@@ -0,0 +1,121 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// not built with the precompiled header, so that it builds outside of Windows
+#include <windows.h>
+#include <stdint.h>
+#include <crtdbg.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <Guard.h>
+#include "Address.h"
+#include "InstBlockCache.h"
+
+
+namespace Mago
+{
+    Address64 InstBlock::Align( Address64 addr )
+    {
+        return (addr / BlockSize) * BlockSize;
+    }
+
+    Address64 InstBlock::GetLimit()
+    {
+        return Address + BlockSize;
+    }
+
+    bool InstBlock::Contains( Address64 addr )
+    {
+        return (addr >= Address) && ((addr - Address) < BlockSize);
+    }
+
+
+    //------------------------------------------------------------------------
+    //  InstBlockCache
+    //------------------------------------------------------------------------
+
+    std::shared_ptr<InstBlock> InstBlockCache::Find( Address64 baseAddr )
+    {
+        GuardedArea guard( mGuard );
+
+        BlockMap::iterator it = mBlockMap.find( baseAddr );
+        if ( it == mBlockMap.end() )
+            return std::shared_ptr<InstBlock>();
+
+        mBlocks.splice( mBlocks.begin(), mBlocks, it->second );
+        return *it->second;
+    }
+
+    std::shared_ptr<InstBlock> InstBlockCache::Add( Address64 baseAddr )
+    {
+        _ASSERT( InstBlock::Align( baseAddr ) == baseAddr );
+
+        std::shared_ptr<InstBlock>  block( new InstBlock() );
+
+        block->Address = baseAddr;
+        block->MapAnchor = 0;
+        block->State = BlockState_Invalid;
+
+        GuardedArea guard( mGuard );
+
+        BlockMap::iterator it = mBlockMap.find( baseAddr );
+        if ( it != mBlockMap.end() )
+        {
+            mBlocks.erase( it->second );
+            mBlockMap.erase( it );
+        }
+        else if ( mBlocks.size() >= MaxBlocks )
+        {
+            mBlockMap.erase( mBlocks.back()->Address );
+            mBlocks.pop_back();
+        }
+
+        mBlocks.push_front( block );
+        mBlockMap[baseAddr] = mBlocks.begin();
+
+        return block;
+    }
+
+    void InstBlockCache::Invalidate( Address64 address, uint32_t length )
+    {
+        GuardedArea guard( mGuard );
+
+        Address64   end = address + length;
+
+        if ( end < address )
+            end = (Address64) -1;
+
+        for ( BlockList::iterator it = mBlocks.begin(); it != mBlocks.end(); )
+        {
+            InstBlock*  block = it->get();
+
+            if ( (block->Address < end) && (block->GetLimit() > address) )
+            {
+                mBlockMap.erase( block->Address );
+                it = mBlocks.erase( it );
+            }
+            else
+                it++;
+        }
+    }
+
+    void InstBlockCache::Clear()
+    {
+        GuardedArea guard( mGuard );
+
+        mBlocks.clear();
+        mBlockMap.clear();
+    }
+
+    size_t InstBlockCache::GetCount()
+    {
+        GuardedArea guard( mGuard );
+
+        return mBlocks.size();
+    }
+}
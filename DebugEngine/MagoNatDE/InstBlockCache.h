@@ -0,0 +1,82 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+
+namespace Mago
+{
+    enum BlockState
+    {
+        BlockState_Invalid,
+        BlockState_Loaded,
+        BlockState_Mapped,
+    };
+
+
+    // Inst holds a sequence of instructions
+    // Map holds instruction length and location information
+    //  For each byte that starts an instruction in Inst, there's a corresponding
+    //  byte at the same offset in Map set to the length of the instruction.
+    //  All other bytes are zero.
+    //  Instructions are decoded up to the anchor of the disassembly stream that
+    //  mapped the block, so the map is only good for streams with that anchor.
+
+    struct InstBlock
+    {
+        static const uint32_t  BlockSize = 4096;
+
+        Address64   Address;
+        Address64   MapAnchor;
+        BlockState  State;
+        BYTE        Inst[ BlockSize ];
+        BYTE        Map[ BlockSize ];
+
+        Address64 GetLimit();
+        bool Contains( Address64 addr );
+
+        static Address64 Align( Address64 addr );
+    };
+
+
+    // The instruction blocks read and mapped for all the disassembly streams of 
+    // a program, by block base. When a new block is needed, the least recently 
+    // used one is dropped. A stream keeps the blocks it's using alive, even if
+    // they're dropped here.
+    //
+    // The blocks are only good while the program is stopped, so the program
+    // clears them when it stops and when it runs.
+
+    class InstBlockCache
+    {
+    public:
+        static const size_t     MaxBlocks = 32;
+
+    private:
+        typedef std::list< std::shared_ptr<InstBlock> >                 BlockList;
+        typedef std::unordered_map< Address64, BlockList::iterator >    BlockMap;
+
+        Guard           mGuard;
+        BlockList       mBlocks;        // most recently used first
+        BlockMap        mBlockMap;
+
+    public:
+        // returns NULL if the block isn't here
+        std::shared_ptr<InstBlock> Find( Address64 baseAddr );
+
+        // returns a new invalid block for the base, that replaces any block there was
+        std::shared_ptr<InstBlock> Add( Address64 baseAddr );
+
+        void    Invalidate( Address64 address, uint32_t length );
+        void    Clear();
+        size_t  GetCount();
+    };
+}
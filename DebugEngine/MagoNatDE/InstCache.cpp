@@ -8,7 +8,6 @@
 #include "Common.h"
 #include "InstCache.h"
 #include "Program.h"
-#include "IDebuggerProxy.h"
 #include "ICoreProcess.h"
 
 #include <algorithm>
@@ -17,22 +16,6 @@
 
 namespace Mago
 {
-    Address64 InstBlock::Align( Address64 addr )
-    {
-        return (addr / BlockSize) * BlockSize;
-    }
-
-    Address64 InstBlock::GetLimit()
-    {
-        return Address + BlockSize;
-    }
-
-    bool InstBlock::Contains( Address64 addr )
-    {
-        return (addr >= Address) && ((addr - Address) < BlockSize);
-    }
-
-
     //------------------------------------------------------------------------
     //  InstReader
     //------------------------------------------------------------------------
@@ -244,31 +227,20 @@ namespace Mago
 
 
     InstCache::InstCache()
-        :   mDebugger( NULL ),
-            mAnchorAddr( 0 ),
+        :   mAnchorAddr( 0 ),
             mPtrSize( 0 )
     {
     }
 
-    HRESULT InstCache::Init( Program* program, IDebuggerProxy* debugger, int ptrSize )
+    HRESULT InstCache::Init( Program* program, int ptrSize )
     {
         _ASSERT( program != NULL );
-        _ASSERT( debugger != NULL );
-
-        for ( int i = 0; i < _countof( mBlockCache ); i++ )
-        {
-            mBlockCache[i].reset( new InstBlock() );
-            if ( mBlockCache[i].get() == NULL )
-                return E_OUTOFMEMORY;
-
-            // mark it as unused
-            mBlockCache[i]->Address = 0;
-            mBlockCache[i]->State = BlockState_Invalid;
-        }
 
+        mAnchorBlock.reset();
+        mSideBlock.reset();
+        mOtherBlocks.clear();
         mPtrSize = ptrSize;
         mProg = program;
-        mDebugger = debugger;
 
         return S_OK;
     }
@@ -288,8 +260,6 @@ namespace Mago
 
         bool    anchorFound = false;
         bool    sideFound = false;
-        int     anchorIndex = -1;
-        int     sideIndex = -1;
 
         if ( (leftBase < anchorBase) 
             && (instAway < ((intptr_t) (anchorBase - addr) / MaxInstructionSize)) )
@@ -304,18 +274,23 @@ namespace Mago
 
         // now we know if user wants instructions that span two pages
 
-        FindBlocks( anchorBase, sideBase, anchorFound, sideFound, anchorIndex, sideIndex );
+        FindBlocks( anchorBase, sideBase, anchorFound, sideFound );
 
         // load the instruction data
 
+        if ( !anchorFound || ((sideBase != 0) && !sideFound) )
+        {
+            PrefetchBlocks( anchorBase, sideBase, instAway );
+        }
+
         if ( !anchorFound )
         {
-            ReadInstData( anchorBase, anchorIndex );
+            ReadInstData( mAnchorBlock.get() );
         }
 
         if ( (sideBase != 0) && !sideFound )
         {
-            ReadInstData( sideBase, sideIndex );
+            ReadInstData( mSideBlock.get() );
         }
 
         // calculate the maximum number of instructions we can get
@@ -325,7 +300,7 @@ namespace Mago
 
         if ( sideFound || (sideBase != 0) )
         {
-            if ( sideBase < anchorBase )
+            if ( mSideBlock->Address < anchorBase )
                 baseOnLeft = leftBase;
             else
                 limitOnRight = rightLimit;
@@ -342,28 +317,38 @@ namespace Mago
             instAwayAvail = std::min( instAwayAvail, instAway );
         }
 
-        // map data
+        // map data; a block can also have been loaded before without being mapped,
+        // or mapped by a stream with another anchor
 
-        if ( !anchorFound || ((sideBase != 0) && !sideFound) )
+        if ( (mAnchorBlock->State == BlockState_Loaded)
+            || ((mSideBlock != NULL) && (mSideBlock->State == BlockState_Loaded)) )
         {
-            MapInstData( addr );
+            MapInstData( addr, sideBase );
         }
 
         return S_OK;
     }
 
     // Builds the instruction map for the blocks around the given address.
+    // If a side block is given, then it's mapped with the anchor block. 
+    // Otherwise, the block on the left is preferred over the one on the right.
 
-    void InstCache::MapInstData( Address64 anchorAddr )
+    void InstCache::MapInstData( Address64 anchorAddr, Address64 sideBase )
     {
+        Address64   anchorBase = InstBlock::Align( anchorAddr );
         InstBlock*  anchorBlock = GetBlockContaining( anchorAddr );
-        InstBlock*  leftBlock = GetBlockContaining( anchorAddr - InstBlock::BlockSize );
-        InstBlock*  rightBlock = GetBlockContaining( anchorAddr + InstBlock::BlockSize );
+        InstBlock*  leftBlock = NULL;
+        InstBlock*  rightBlock = NULL;
         InstBlock*  sideBlock = NULL;
         InstBlock*  blocks[2] = { NULL };
 
         if ( anchorBlock == NULL )
             return;
+
+        if ( (sideBase == 0) || (sideBase < anchorBase) )
+            leftBlock = GetBlockContaining( anchorAddr - InstBlock::BlockSize );
+        if ( (sideBase == 0) || (sideBase > anchorBase) )
+            rightBlock = GetBlockContaining( anchorAddr + InstBlock::BlockSize );
         if ( (leftBlock != NULL) && (leftBlock->Address >= anchorBlock->Address) )
             leftBlock = NULL;
         if ( (rightBlock != NULL) && (rightBlock->Address <= anchorBlock->Address) )
@@ -450,7 +435,10 @@ namespace Mago
         }
 
         for ( uint32_t i = 0; i < blockCount; i++ )
+        {
             blocks[i]->State = BlockState_Mapped;
+            blocks[i]->MapAnchor = mAnchorAddr;
+        }
 
         for ( instLen = reader.Decode(); instLen != 0; instLen = reader.Decode() )
         {
@@ -487,104 +475,140 @@ namespace Mago
         Address64 anchorBase, 
         Address64 sideBase, 
         bool& anchorFound, 
-        bool& sideFound, 
-        int& anchorIndex,
-        int& sideIndex )
+        bool& sideFound )
     {
         _ASSERT( anchorBase != 0 );
         _ASSERT( sideBase != anchorBase );
 
-        anchorIndex = GetBlockIndexContaining( anchorBase );
+        InstBlockCache& cache = mProg->GetInstBlockCache();
+
+        // the blocks of the last load aren't used anymore
+        mOtherBlocks.clear();
+        mSideBlock.reset();
+
+        mAnchorBlock = cache.Find( anchorBase );
 
         if ( sideBase != 0 )
-            sideIndex = GetBlockIndexContaining( sideBase );
+            mSideBlock = cache.Find( sideBase );
         else
         {
-            sideIndex = -1;
-
             // try left first
-            sideBase = anchorBase - InstBlock::BlockSize;
-            if ( sideBase < anchorBase )
-                sideIndex = GetBlockIndexContaining( sideBase );
+            Address64   leftBase = anchorBase - InstBlock::BlockSize;
+            Address64   rightBase = anchorBase + InstBlock::BlockSize;
 
-            if ( sideIndex < 0 )
-            {
-                // then right
-                sideBase = anchorBase + InstBlock::BlockSize;
-                if ( sideBase > anchorBase )
-                    sideIndex = GetBlockIndexContaining( sideBase );
-            }
+            if ( leftBase < anchorBase )
+                mSideBlock = cache.Find( leftBase );
+
+            // then right
+            if ( (mSideBlock == NULL) && (rightBase > anchorBase) )
+                mSideBlock = cache.Find( rightBase );
         }
 
-        anchorFound = anchorIndex >= 0;
-        sideFound = sideIndex >= 0;
+        anchorFound = mAnchorBlock != NULL;
+        sideFound = mSideBlock != NULL;
 
-        if ( !anchorFound && !sideFound )
-        {
-            anchorIndex = 0;
-            sideIndex = 1;
-        }
-        else if ( !anchorFound )
-        {
-            anchorIndex = (sideIndex + 1) % 2;
-        }
-        else if ( !sideFound )
-        {
-            sideIndex = (anchorIndex + 1) % 2;
-        }
-        // else, both were found, and the indexes were set already
+        if ( !anchorFound )
+            mAnchorBlock = cache.Add( anchorBase );
+
+        if ( !sideFound && (sideBase != 0) )
+            mSideBlock = cache.Add( sideBase );
+
+        // the maps stop at the anchor, so they have to be made again for another one
+
+        mAnchorBlock = CopyToRemap( mAnchorBlock );
+
+        if ( mSideBlock != NULL )
+            mSideBlock = CopyToRemap( mSideBlock );
     }
 
-    int InstCache::GetBlockIndexContaining( Address64 addr )
+    std::shared_ptr<InstBlock> InstCache::CopyToRemap( const std::shared_ptr<InstBlock>& block )
     {
-        for ( int i = 0; i < _countof( mBlockCache ); i++ )
+        if ( (block->State != BlockState_Mapped) || (block->MapAnchor == mAnchorAddr) )
+            return block;
+
+        // the stream that mapped the block can still be using it, so leave it alone
+        std::shared_ptr<InstBlock>  copy = mProg->GetInstBlockCache().Add( block->Address );
+
+        memcpy( copy->Inst, block->Inst, sizeof copy->Inst );
+        copy->State = BlockState_Loaded;
+
+        return copy;
+    }
+
+    void InstCache::PrefetchBlocks( Address64 anchorBase, Address64 sideBase, int instAway )
+    {
+        Address64   base = anchorBase;
+        Address64   limit = anchorBase + InstBlock::BlockSize;
+
+        if ( sideBase != 0 )
         {
-            if ( mBlockCache[i]->Contains( addr ) )
-                return i;
+            if ( sideBase < base )
+                base = sideBase;
+            else
+                limit = sideBase + InstBlock::BlockSize;
         }
 
-        return -1;
+        // the next block in the direction the user is going is likely to be wanted soon
+        if ( (instAway < 0) && (base - InstBlock::BlockSize < base) )
+            base -= InstBlock::BlockSize;
+        else if ( (instAway >= 0) && (limit + InstBlock::BlockSize > limit) )
+            limit += InstBlock::BlockSize;
+
+        if ( limit <= base )
+            return;
+
+        mProg->PrefetchMemory( base, (uint32_t) (limit - base) );
     }
 
     InstBlock* InstCache::GetBlockContaining( Address64 addr )
     {
-        int i = GetBlockIndexContaining( addr );
-        _ASSERT( i < (int) _countof( mBlockCache ) );
+        Address64   baseAddr = InstBlock::Align( addr );
 
-        if ( i < 0 )
+        if ( (mAnchorBlock != NULL) && (mAnchorBlock->Address == baseAddr) )
+            return mAnchorBlock.get();
+
+        if ( (mSideBlock != NULL) && (mSideBlock->Address == baseAddr) )
+            return mSideBlock.get();
+
+        for ( size_t i = 0; i < mOtherBlocks.size(); i++ )
+        {
+            if ( mOtherBlocks[i]->Address == baseAddr )
+                return mOtherBlocks[i].get();
+        }
+
+        std::shared_ptr<InstBlock>  block = mProg->GetInstBlockCache().Find( baseAddr );
+
+        if ( block == NULL )
             return NULL;
 
-        return mBlockCache[i].get();
+        // keep it alive until the next load, even if the program's cache drops it
+        mOtherBlocks.push_back( block );
+        return block.get();
     }
 
-    HRESULT InstCache::ReadInstData( Address64 baseAddr, int cacheIndex )
+    HRESULT InstCache::ReadInstData( InstBlock* block )
     {
-        _ASSERT( (cacheIndex >= 0) && (cacheIndex < _countof( mBlockCache )) );
-        _ASSERT( InstBlock::Align( baseAddr ) == baseAddr );
+        _ASSERT( block != NULL );
+        _ASSERT( InstBlock::Align( block->Address ) == block->Address );
 
         HRESULT                 hr = S_OK;
-        RefPtr<ICoreProcess>    proc;
         uint32_t                lenRead = 0;
         uint32_t                lenUnreadable = 0;
 
-        mBlockCache[cacheIndex]->Address = baseAddr;
-        mBlockCache[cacheIndex]->State = BlockState_Invalid;
-
-        proc = mProg->GetCoreProcess();
+        block->State = BlockState_Invalid;
 
-        hr = mDebugger->ReadMemory( 
-            proc, 
-            baseAddr, 
+        hr = mProg->ReadMemory( 
+            block->Address, 
             InstBlock::BlockSize, 
             lenRead, 
             lenUnreadable, 
-            mBlockCache[cacheIndex]->Inst );
+            block->Inst );
         if ( FAILED( hr ) )
             return hr;
         if ( lenRead != InstBlock::BlockSize )
             return E_FAIL;
 
-        mBlockCache[cacheIndex]->State = BlockState_Loaded;
+        block->State = BlockState_Loaded;
 
         return S_OK;
     }
@@ -9,6 +9,7 @@
 
 #include <udis86.h>
 #include <memory>
+#include "InstBlockCache.h"
 
 
 namespace Mago
@@ -17,37 +18,6 @@ namespace Mago
 
 
     class Program;
-    class IDebuggerProxy;
-
-
-    enum BlockState
-    {
-        BlockState_Invalid,
-        BlockState_Loaded,
-        BlockState_Mapped,
-    };
-
-
-    // Inst holds a sequence of instructions
-    // Map holds instruction length and location information
-    //  For each byte that starts an instruction in Inst, there's a corresponding
-    //  byte at the same offset in Map set to the length of the instruction.
-    //  All other bytes are zero.
-
-    struct InstBlock
-    {
-        static const uint32_t  BlockSize = 4096;
-
-        Address64   Address;
-        BlockState  State;
-        BYTE        Inst[ BlockSize ];
-        BYTE        Map[ BlockSize ];
-
-        Address64 GetLimit();
-        bool Contains( Address64 addr );
-
-        static Address64 Align( Address64 addr );
-    };
 
 
     class InstReader
@@ -83,18 +53,24 @@ namespace Mago
     };
 
 
+    // Gets the blocks of a disassembly stream from the program's InstBlockCache, 
+    // so that scrolling back and forth doesn't read and map them again, and 
+    // streams disassembling at the same stop share them. It holds on to the 
+    // blocks of the last load, so that they stay alive while they're used.
+
     class InstCache
     {
         RefPtr<Program>             mProg;
-        IDebuggerProxy*             mDebugger;
         Address64                   mAnchorAddr;
-        std::unique_ptr<InstBlock>  mBlockCache[2];
+        std::shared_ptr<InstBlock>  mAnchorBlock;
+        std::shared_ptr<InstBlock>  mSideBlock;
+        std::vector< std::shared_ptr<InstBlock> >   mOtherBlocks;
         uint32_t                    mPtrSize;
 
     public:
         InstCache();
 
-        HRESULT Init( Program* program, IDebuggerProxy* debugger, int ptrSize );
+        HRESULT Init( Program* program, int ptrSize );
         void SetAnchor( Address64 anchorAddr );
 
         HRESULT LoadBlocks( Address64 addr, int instAway, int& instAwayAvail );
@@ -102,34 +78,38 @@ namespace Mago
         InstBlock* GetBlockContaining( Address64 addr );
 
     private:
-        // Looks in the cache for an anchor block and a side block right next to it.
-        // If a side block is not given (its base is 0), then this function 
-        // looks for whatever block is supposed to be right next to it on either side.
+        // Looks in the program's cache for an anchor block and a side block right 
+        // next to it. If a side block is not given (its base is 0), then this 
+        // function looks for whatever block is supposed to be right next to it 
+        // on either side.
         //
-        // Returns whether the anchor block and a side block were found and what 
-        // their cache indexes are. The indexes will always be valid. Each will
-        // be set to either the index where the block was found or where the 
-        // block should be put, if it wasn't found.
+        // Returns whether the anchor block and a side block were found. Blocks 
+        // that weren't found are added to the cache, to be read. Blocks that were
+        // mapped for another anchor are swapped for copies, to be mapped again.
 
         void FindBlocks( 
             Address64 anchorBase, 
             Address64 sideBase, 
             bool& anchorFound, 
-            bool& sideFound, 
-            int& anchorIndex,
-            int& sideIndex );
+            bool& sideFound );
+
+        // Returns the block, or if it was mapped for another anchor, a copy of 
+        // its instructions marked as only loaded. The copy replaces it in the 
+        // program's cache.
+
+        std::shared_ptr<InstBlock> CopyToRemap( const std::shared_ptr<InstBlock>& block );
 
-        // Returns the cache index of the block containing the given address, 
-        // or -1 if not found.
+        // Reads the blocks that will be wanted next along with the ones wanted now,
+        // all in one read.
 
-        int GetBlockIndexContaining( Address64 addr );
+        void PrefetchBlocks( Address64 anchorBase, Address64 sideBase, int instAway );
 
-        // Reads a block of instruction data into the given cache index.
+        // Reads a block of instruction data.
         // On success, it marks the block as loaded, otherwise as invalid.
 
-        HRESULT ReadInstData( Address64 baseAddr, int cacheIndex );
+        HRESULT ReadInstData( InstBlock* block );
 
-        void MapInstData( Address64 anchorAddr );
+        void MapInstData( Address64 anchorAddr, Address64 sideBase );
         void MapInstData( uint32_t blockCount, InstBlock** blocks, Address64 startAddr, Address64 endAddr );
     };
 }
@@ -8,16 +8,14 @@
 #include "Common.h"
 #include "MemoryBytes.h"
 #include "CodeContext.h"
-#include "IDebuggerProxy.h"
-#include "ICoreProcess.h"
+#include "Program.h"
 
 
 namespace Mago
 {
     MemoryBytes::MemoryBytes()
         :   mAddr( 0 ),
-            mSize( 0 ),
-            mDebugger( NULL )
+            mSize( 0 )
     {
     }
 
@@ -52,8 +50,7 @@ namespace Mago
 
         memCxt->GetAddress( addr );
 
-        hr = mDebugger->ReadMemory( 
-            mProc,
+        hr = mProg->ReadMemory( 
             addr,
             dwCount,
             lenRead,
@@ -90,8 +87,7 @@ namespace Mago
 
         memCxt->GetAddress( addr );
 
-        hr = mDebugger->WriteMemory( 
-            mProc,
+        hr = mProg->WriteMemory( 
             addr,
             dwCount,
             lenWritten,
@@ -116,14 +112,12 @@ namespace Mago
     //////////////////////////////////////////////////////////// 
     // MemoryBytes
 
-    void MemoryBytes::Init( Address64 addr, uint64_t size, IDebuggerProxy* debugger, ICoreProcess* proc )
+    void MemoryBytes::Init( Address64 addr, uint64_t size, Program* prog )
     {
-        _ASSERT( debugger != NULL );
-        _ASSERT( proc != NULL );
+        _ASSERT( prog != NULL );
 
         mAddr = addr;
         mSize = size;
-        mDebugger = debugger;
-        mProc = proc;
+        mProg = prog;
     }
 }
@@ -10,8 +10,7 @@
 
 namespace Mago
 {
-    class IDebuggerProxy;
-    class ICoreProcess;
+    class Program;
 
 
     class MemoryBytes : 
@@ -20,8 +19,7 @@ namespace Mago
     {
         Address64               mAddr;
         uint64_t                mSize;
-        IDebuggerProxy*         mDebugger;
-        RefPtr<ICoreProcess>    mProc;
+        RefPtr<Program>         mProg;
 
     public:
         MemoryBytes();
@@ -50,6 +48,6 @@ namespace Mago
             UINT64* pqwSize );
 
     public:
-        void Init( Address64 addr, uint64_t size, IDebuggerProxy* debugger, ICoreProcess* proc );
+        void Init( Address64 addr, uint64_t size, Program* prog );
     };
 }
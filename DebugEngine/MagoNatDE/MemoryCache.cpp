@@ -0,0 +1,265 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// not built with the precompiled header, so that it builds outside of Windows
+#include <windows.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <crtdbg.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <Guard.h>
+#include "Address.h"
+#include "MemoryCache.h"
+#include "IDebuggerProxy.h"
+
+
+namespace Mago
+{
+    MemoryCache::MemoryCache()
+        :   mEnabled( false )
+    {
+    }
+
+    void MemoryCache::Enable( bool enable )
+    {
+        GuardedArea guard( mGuard );
+
+        mEnabled = enable;
+        mPages.clear();
+    }
+
+    bool MemoryCache::IsEnabled()
+    {
+        return mEnabled;
+    }
+
+    HRESULT MemoryCache::ReadMemory(
+        IDebuggerProxy* debugger,
+        ICoreProcess* process,
+        Address64 address,
+        uint32_t length,
+        uint32_t& lengthRead,
+        uint32_t& lengthUnreadable,
+        uint8_t* buffer )
+    {
+        _ASSERT( debugger != NULL );
+
+        GuardedArea guard( mGuard );
+
+        Address64   firstPage = address & ~(Address64) (PageSize - 1);
+        Address64   end = address + length;
+
+        // big reads are usually done once, and would push out everything else
+        if ( !mEnabled || (length > MaxCachedRead) || (end < address) )
+            return debugger->ReadMemory( process, address, length, lengthRead, lengthUnreadable, buffer );
+
+        // like the debugger proxy, return the readable bytes at the start,
+        // then the unreadable bytes up to the next readable ones
+
+        uint32_t    readLen = 0;
+        uint32_t    unreadableLen = 0;
+
+        // GetPage does just as well with one page
+        FillPages( debugger, process, firstPage, end, 2 );
+
+        for ( Address64 pageAddr = firstPage; pageAddr < end; pageAddr += PageSize )
+        {
+            Page*   page = NULL;
+            HRESULT hr = GetPage( debugger, process, pageAddr, page );
+
+            // let the debugger proxy sort out what it can't do one page at a time
+            if ( hr != S_OK )
+                return debugger->ReadMemory( process, address, length, lengthRead, lengthUnreadable, buffer );
+
+            Address64   start = pageAddr < address ? address : pageAddr;
+            Address64   stop = pageAddr + PageSize > end ? end : pageAddr + PageSize;
+            uint32_t    chunkLen = (uint32_t) (stop - start);
+
+            if ( page->Readable )
+            {
+                if ( unreadableLen > 0 )
+                    break;
+
+                memcpy( buffer + readLen, page->Bytes + (start - pageAddr), chunkLen );
+                readLen += chunkLen;
+            }
+            else
+            {
+                unreadableLen += chunkLen;
+            }
+        }
+
+        lengthRead = readLen;
+        lengthUnreadable = unreadableLen;
+        return S_OK;
+    }
+
+    void MemoryCache::Prefetch(
+        IDebuggerProxy* debugger,
+        ICoreProcess* process,
+        Address64 address,
+        uint32_t length )
+    {
+        _ASSERT( debugger != NULL );
+
+        GuardedArea guard( mGuard );
+
+        Address64   firstPage = address & ~(Address64) (PageSize - 1);
+        Address64   end = address + length;
+
+        if ( !mEnabled || (length == 0) || (length > MaxCachedRead) || (end < address) )
+            return;
+
+        FillPages( debugger, process, firstPage, end, 1 );
+    }
+
+    void MemoryCache::Invalidate( Address64 address, uint32_t length )
+    {
+        GuardedArea guard( mGuard );
+
+        if ( length == 0 )
+            return;
+
+        Address64   firstPage = address & ~(Address64) (PageSize - 1);
+        Address64   lastPage = (address + length - 1) & ~(Address64) (PageSize - 1);
+
+        if ( lastPage < firstPage )
+        {
+            mPages.clear();
+            return;
+        }
+
+        for ( Address64 pageAddr = firstPage; ; pageAddr += PageSize )
+        {
+            mPages.erase( pageAddr );
+
+            if ( pageAddr == lastPage )
+                break;
+        }
+    }
+
+    void MemoryCache::FillPages( 
+        IDebuggerProxy* debugger, 
+        ICoreProcess* process, 
+        Address64 firstPage, 
+        Address64 end, 
+        uint32_t minMissingCount )
+    {
+        // a read that isn't page aligned touches one more page than it has
+        MemoryReadRange ranges[MaxCachedRead / PageSize + 1];
+        uint32_t        rangeCount = 0;
+        uint32_t        missingCount = 0;
+
+        for ( Address64 pageAddr = firstPage; pageAddr < end; pageAddr += PageSize )
+        {
+            if ( mPages.find( pageAddr ) != mPages.end() )
+                continue;
+
+            if ( (rangeCount > 0) 
+                && (ranges[rangeCount - 1].Begin + ranges[rangeCount - 1].Length == pageAddr) )
+            {
+                ranges[rangeCount - 1].Length += PageSize;
+            }
+            else
+            {
+                _ASSERT( rangeCount < _countof( ranges ) );
+                ranges[rangeCount].Begin = pageAddr;
+                ranges[rangeCount].Length = PageSize;
+                rangeCount++;
+            }
+
+            missingCount++;
+        }
+
+        if ( (missingCount == 0) || (missingCount < minMissingCount) )
+            return;
+
+        std::vector<uint8_t>    bytes( missingCount * PageSize );
+        uint32_t                offset = 0;
+
+        // anything not filled here is read again one page at a time by GetPage
+        HRESULT hr = debugger->ReadMemoryBatch( process, rangeCount, ranges, &bytes[0] );
+        if ( FAILED( hr ) )
+            return;
+
+        if ( mPages.size() + missingCount > MaxPages )
+            mPages.clear();
+
+        for ( uint32_t i = 0; i < rangeCount; i++ )
+        {
+            const MemoryReadRange&  range = ranges[i];
+
+            for ( uint32_t pageOffset = 0; 
+                SUCCEEDED( range.Result ) && (pageOffset < range.Length); 
+                pageOffset += PageSize )
+            {
+                bool    readable = false;
+
+                if ( pageOffset + PageSize <= range.LengthRead )
+                    readable = true;
+                else if ( (pageOffset >= range.LengthRead) 
+                    && (pageOffset + PageSize <= range.LengthRead + range.LengthUnreadable) )
+                    readable = false;
+                else
+                    continue;
+
+                std::unique_ptr<Page>   page( new Page() );
+
+                page->Readable = readable;
+                if ( readable )
+                    memcpy( page->Bytes, &bytes[offset + pageOffset], PageSize );
+
+                mPages[range.Begin + pageOffset] = std::move( page );
+            }
+
+            offset += range.Length;
+        }
+    }
+
+    HRESULT MemoryCache::GetPage( IDebuggerProxy* debugger, ICoreProcess* process, Address64 pageAddr, Page*& page )
+    {
+        PageMap::iterator it = mPages.find( pageAddr );
+
+        if ( it != mPages.end() )
+        {
+            page = it->second.get();
+            return S_OK;
+        }
+
+        std::unique_ptr<Page>   newPage( new Page() );
+        uint32_t                lenRead = 0;
+        uint32_t                lenUnreadable = 0;
+
+        HRESULT hr = debugger->ReadMemory(
+            process,
+            pageAddr,
+            PageSize,
+            lenRead,
+            lenUnreadable,
+            newPage->Bytes );
+        if ( FAILED( hr ) )
+            return hr;
+
+        // memory is protected by whole pages, anything else isn't cached
+        if ( lenRead == PageSize )
+            newPage->Readable = true;
+        else if ( (lenRead == 0) && (lenUnreadable == PageSize) )
+            newPage->Readable = false;
+        else
+            return S_FALSE;
+
+        if ( mPages.size() >= MaxPages )
+            mPages.clear();
+
+        page = newPage.get();
+        mPages[pageAddr] = std::move( newPage );
+        return S_OK;
+    }
+}
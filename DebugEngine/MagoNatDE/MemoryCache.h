@@ -0,0 +1,83 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+
+namespace Mago
+{
+    class IDebuggerProxy;
+    class ICoreProcess;
+
+
+    // Pages of debuggee memory, read through the debugger proxy while the program
+    // is stopped. The debuggee can't change its memory then, so the pages stay
+    // valid until it runs again, or until we write to it ourselves.
+    //
+    // While disabled, reads go straight to the debugger proxy.
+    //
+    // The pages missing for one read are asked for together, with neighboring
+    // pages joined into one range, which saves round trips to a remote agent.
+
+    class MemoryCache
+    {
+    public:
+        static const uint32_t   PageSize = 0x1000;
+        static const size_t     MaxPages = 1024;
+        static const uint32_t   MaxCachedRead = 16 * PageSize;
+
+    private:
+        struct Page
+        {
+            bool        Readable;
+            uint8_t     Bytes[PageSize];
+        };
+
+        typedef std::unordered_map<Address64, std::unique_ptr<Page>> PageMap;
+
+        Guard           mGuard;
+        bool            mEnabled;
+        PageMap         mPages;
+
+    public:
+        MemoryCache();
+
+        // enabling or disabling drops all pages
+        void    Enable( bool enable );
+        bool    IsEnabled();
+
+        HRESULT ReadMemory(
+            IDebuggerProxy* debugger,
+            ICoreProcess* process,
+            Address64 address,
+            uint32_t length,
+            uint32_t& lengthRead,
+            uint32_t& lengthUnreadable,
+            uint8_t* buffer );
+
+        // reads the missing pages of a range ahead of time, if the cache is enabled
+        void    Prefetch(
+            IDebuggerProxy* debugger,
+            ICoreProcess* process,
+            Address64 address,
+            uint32_t length );
+
+        void    Invalidate( Address64 address, uint32_t length );
+
+    private:
+        void    FillPages( 
+            IDebuggerProxy* debugger, 
+            ICoreProcess* process, 
+            Address64 firstPage, 
+            Address64 end, 
+            uint32_t minMissingCount );
+        HRESULT GetPage( IDebuggerProxy* debugger, ICoreProcess* process, Address64 pageAddr, Page*& page );
+    };
+}
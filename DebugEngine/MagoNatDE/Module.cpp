@@ -9,6 +9,7 @@
 #include "Module.h"
 #include "DiaLoadCallback.h"
 #include "ICoreProcess.h"
+#include "ExprContext.h"
 
 
 namespace Mago
@@ -17,7 +18,9 @@ namespace Mago
 
     Module::Module()
         :   mId( 0 ),
-            mLoadIndex( 0 )
+            mLoadIndex( 0 ),
+            mSymbolsBound( false ),
+            mDisposed( false )
     {
     }
 
@@ -192,6 +195,11 @@ namespace Mago
         if ( FAILED( hr ) )
             return hr;
 
+        std::wstring    cacheDir;
+
+        if ( GetSymbolCacheDir( cacheDir ) )
+            dataSource->SetSymbolCacheDir( cacheDir.c_str() );
+
         hr = dataSource->InitDebugInfo( mCoreMod->GetPath(), mCoreMod->GetSymbolSearchPath() );
         if ( FAILED( hr ) )
             return hr;
@@ -261,6 +269,11 @@ namespace Mago
         // these have to be closed when we're told to close
         // all other resources can be left open
 
+        {
+            GuardedArea guard( mSessionGuard );
+            mDisposed = true;
+        }
+
         SetSession( NULL );
     }
 
@@ -331,8 +344,42 @@ namespace Mago
 
     void    Module::SetSession( MagoST::ISession* session )
     {
+        RefPtr<ModuleContext>   oldContext;
+
         GuardedArea guard( mSessionGuard );
         mSession = session;
+
+        // it holds a reference to this module, so let it go after unlocking
+        oldContext.Attach( mModuleContext.Detach() );
+    }
+
+    HRESULT Module::GetModuleContext( Program* program, RefPtr<ModuleContext>& context )
+    {
+        GuardedArea guard( mSessionGuard );
+
+        if ( mModuleContext == NULL )
+        {
+            RefPtr<ModuleContext>   newContext;
+
+            HRESULT hr = MakeCComObject( newContext );
+            if ( FAILED( hr ) )
+                return hr;
+
+            hr = newContext->Init( this, program );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if ( mDisposed )
+            {
+                context = newContext;
+                return S_OK;
+            }
+
+            mModuleContext = newContext;
+        }
+
+        context = mModuleContext;
+        return S_OK;
     }
 
     bool    Module::Contains( Address64 addr )
@@ -340,4 +387,37 @@ namespace Mago
         Address64 modAddr = GetAddress();
         return (addr >= modAddr) && ((addr - modAddr) < GetSize());
     }
+
+    HRESULT Module::BeginLoadSymbols()
+    {
+        _ASSERT( mhSymbolsLoaded.IsEmpty() );
+
+        mhSymbolsLoaded = CreateEvent( NULL, TRUE, FALSE, NULL );
+        if ( mhSymbolsLoaded.IsEmpty() )
+            return GetLastHr();
+
+        return S_OK;
+    }
+
+    void    Module::EndLoadSymbols()
+    {
+        if ( !mhSymbolsLoaded.IsEmpty() )
+            SetEvent( mhSymbolsLoaded );
+    }
+
+    void    Module::WaitForSymbols()
+    {
+        if ( !mhSymbolsLoaded.IsEmpty() )
+            WaitForSingleObject( mhSymbolsLoaded, INFINITE );
+    }
+
+    bool    Module::GetSymbolsBound()
+    {
+        return mSymbolsBound;
+    }
+
+    void    Module::SetSymbolsBound()
+    {
+        mSymbolsBound = true;
+    }
 }
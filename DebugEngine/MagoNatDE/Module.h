@@ -11,6 +11,8 @@
 namespace Mago
 {
     class ICoreModule;
+    class ModuleContext;
+    class Program;
 
 
     class Module : 
@@ -23,7 +25,17 @@ namespace Mago
         RefPtr<MagoST::ISession>    mSession;
         CComBSTR                    mLoadedSymPath;
         CComBSTR                    mSearchText;
+        HandlePtr                   mhSymbolsLoaded;    // made when symbols load in the background
+        bool                        mSymbolsBound;      // protected by the engine's bind BP guard
         Guard                       mSessionGuard;
+        bool                        mDisposed;          // protected by the session guard
+
+        // Shared by expression contexts, and made with the session. The context refers 
+        // back to this module and to the program, which refers to this module, so these 
+        // cycles last until SetSession lets the context go: on a symbol load or reload, 
+        // and in Dispose, which the program calls when the module unloads and when the 
+        // program itself is disposed.
+        RefPtr<ModuleContext>       mModuleContext;
 
     public:
         Module();
@@ -80,7 +92,23 @@ namespace Mago
         HRESULT LoadSymbols( bool sendEvent );
         bool    Contains( Address64 addr );
 
+        // Background symbol loading. Begin is called before handing the module to the loader, 
+        // End when the load finished, whether it succeeded or not. Wait returns right away 
+        // if the module's symbols were never loaded in the background.
+        HRESULT BeginLoadSymbols();
+        void    EndLoadSymbols();
+        void    WaitForSymbols();
+
+        // whether pending BPs were bound and the symbol event sent after loading
+        bool    GetSymbolsBound();
+        void    SetSymbolsBound();
+
         RefPtr<MagoST::ISession>    GetSession();
         void    SetSession( MagoST::ISession* session );
+
+        // The context is dropped when the session changes or the module is disposed,
+        // which throws out the expressions bound with the old symbols. After that, 
+        // each call makes a context that isn't kept, so the cycle isn't made again.
+        HRESULT GetModuleContext( Program* program, RefPtr<ModuleContext>& context );
     };
 }
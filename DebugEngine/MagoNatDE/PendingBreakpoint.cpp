@@ -338,7 +338,7 @@ namespace Mago
         return hr;
     }
 
-    HRESULT MakeBinder( IDebugBreakpointRequest2* bpRequest, unique_ptr<BPBinder>& binder )
+    HRESULT MakeBinder( IDebugBreakpointRequest2* bpRequest, UniquePtr<BPBinder>& binder )
     {
         BP_LOCATION_TYPE    locType = 0;
 
@@ -346,25 +346,39 @@ namespace Mago
 
         if ( locType == BPLT_CODE_FILE_LINE )
         {
-            binder.reset( new BPCodeFileLineBinder( bpRequest ) );
+            binder.Attach( new BPCodeFileLineBinder( bpRequest ) );
         }
         else if ( locType == BPLT_CODE_ADDRESS )
         {
-            binder.reset( new BPCodeAddressBinder( bpRequest ) );
+            binder.Attach( new BPCodeAddressBinder( bpRequest ) );
         }
         else if ( locType == BPLT_CODE_CONTEXT )
         {
-            binder.reset( new BPCodeAddressBinder( bpRequest ) );
+            binder.Attach( new BPCodeAddressBinder( bpRequest ) );
         }
         else
             return E_FAIL;
 
-        if ( binder.get() == NULL )
+        if ( binder.Get() == NULL )
             return E_OUTOFMEMORY;
 
         return S_OK;
     }
 
+    HRESULT PendingBreakpoint::GetBinder( BPBinder*& binder )
+    {
+        // the request doesn't change, so neither does the binder made from it
+        if ( mBinder.Get() == NULL )
+        {
+            HRESULT hr = MakeBinder( mBPRequest, mBinder );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        binder = mBinder.Get();
+        return S_OK;
+    }
+
     // The job of Bind:
     // - Generate bound or error breakpoints
     // - Establish the document context
@@ -379,15 +393,14 @@ namespace Mago
             return E_BP_DELETED;
 
         HRESULT                 hr = S_OK;
-        BpRequestInfo           reqInfo;
-		unique_ptr<BPBinder>    binder;
+        BPBinder*               binder = NULL;
 
-        hr = MakeBinder( mBPRequest, binder );
+        hr = GetBinder( binder );
         if ( FAILED( hr ) )
             return hr;
 
         // generate bound and error breakpoints
-        BPBinderCallback        callback( binder.get(), this, mDocContext.Get() );
+        BPBinderCallback        callback( binder, this, mDocContext.Get() );
         mEngine->ForeachProgram( &callback );
 
         if ( mDocContext.Get() == NULL )
@@ -452,7 +465,25 @@ namespace Mago
         return hr;
     }
 
-    HRESULT PendingBreakpoint::BindToModule( Module* mod, Program* prog )
+    bool PendingBreakpoint::GetFileLineRequest( MagoST::FileLineRequest& request )
+    {
+        GuardedArea             guard( mBoundBPGuard );
+
+        if ( mDeleted )
+            return false;
+        if ( (mState.flags & PBPSF_VIRTUALIZED) == 0 )
+            return false;
+
+        BPBinder*               binder = NULL;
+
+        if ( FAILED( GetBinder( binder ) ) )
+            return false;
+
+        // the request points into the binder, which lives as long as this BP
+        return binder->GetFileLineRequest( request );
+    }
+
+    HRESULT PendingBreakpoint::BindToModule( Module* mod, Program* prog, const std::list<MagoST::LineNumber>* lines )
     {
         GuardedArea             guard( mBoundBPGuard );
 
@@ -462,16 +493,15 @@ namespace Mago
             return E_FAIL;
 
         HRESULT                 hr = S_OK;
-        BpRequestInfo           reqInfo;
-		unique_ptr<BPBinder>    binder;
+        BPBinder*               binder = NULL;
 
-        hr = MakeBinder( mBPRequest, binder );
+        hr = GetBinder( binder );
         if ( FAILED( hr ) )
             return hr;
 
         // generate bound and error breakpoints
-        BPBinderCallback        callback( binder.get(), this, mDocContext.Get() );
-        callback.BindToModule( mod, prog );
+        BPBinderCallback        callback( binder, this, mDocContext.Get() );
+        callback.BindToModule( mod, prog, lines );
 
         if ( mDocContext.Get() == NULL )
         {
@@ -14,6 +14,7 @@ namespace Mago
     class BPDocumentContext;
     class BoundBreakpoint;
     class ErrorBreakpoint;
+    class BPBinder;
 
 
     struct ModuleBinding
@@ -41,6 +42,7 @@ namespace Mago
         RefPtr<BPDocumentContext>               mDocContext;    // optional
         BindingMap                              mBindings;
         DWORD                                   mLastBPId;
+        UniquePtr<BPBinder>                     mBinder;        // made on first bind
         Guard                                   mBoundBPGuard;
 
     public:
@@ -85,7 +87,8 @@ namespace Mago
         HRESULT EnumCodeContexts( IEnumDebugCodeContexts2** ppEnum );
         DWORD   GetNextBPId();
 
-        HRESULT BindToModule( Module* mod, Program* prog );
+        bool    GetFileLineRequest( MagoST::FileLineRequest& request );
+        HRESULT BindToModule( Module* mod, Program* prog, const std::list<MagoST::LineNumber>* lines = NULL );
         HRESULT UnbindFromModule( Module* mod, Program* prog );
         HRESULT EnumBoundBreakpoints( ModuleBinding* binding, IEnumDebugBoundBreakpoints2** ppEnum );
 
@@ -95,5 +98,6 @@ namespace Mago
         HRESULT SendUnboundEvent( BoundBreakpoint* boundBP, Program* prog );
 
         HRESULT BindToAllModules();
+        HRESULT GetBinder( BPBinder*& binder );
     };
 }
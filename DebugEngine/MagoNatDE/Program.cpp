@@ -56,6 +56,7 @@ namespace Mago
     Program::Program()
     :   mProgId( GUID_NULL ),
         mAttached( false ),
+        mLoadComplete( false ),
         mPassExceptionToDebuggee( true ),
         mCanPassExceptionToDebuggee( true ),
         mDebugger( NULL ),
@@ -100,6 +101,8 @@ namespace Mago
     {
         HRESULT hr = S_OK;
 
+        EnableMemoryCache( false );
+
         hr = mDebugger->Terminate( mCoreProc.Get() );
         _ASSERT( hr == S_OK );
 
@@ -167,22 +170,14 @@ namespace Mago
         if ( FAILED( hr ) )
             return hr;
 
-        bool    foundExact = BindCodeContextsToFile( 
-            true, 
-            u8FileName, 
-            u8FileNameLen, 
-            (uint16_t) startPos.dwLine, 
-            (uint16_t) endPos.dwLine, 
-            bindings );
-
-        if ( !foundExact )
-            foundExact = BindCodeContextsToFile( 
-            false, 
-            u8FileName, 
-            u8FileNameLen, 
-            (uint16_t) startPos.dwLine, 
-            (uint16_t) endPos.dwLine, 
-            bindings );
+        MagoST::FileLineRequest request = { 0 };
+
+        request.FileName = u8FileName;
+        request.FileNameLen = u8FileNameLen;
+        request.LineStart = (uint16_t) startPos.dwLine;
+        request.LineEnd = (uint16_t) endPos.dwLine;
+
+        BindCodeContextsToFile( request, bindings );
 
         InterfaceArray<IDebugCodeContext2>  codeContextArray( bindings.size() );
         int i = 0;
@@ -211,15 +206,14 @@ namespace Mago
     }
 
     bool Program::BindCodeContextsToFile( 
-        bool exactMatch, 
-        const char* fileName, 
-        size_t fileNameLen, 
-        uint16_t reqLineStart, 
-        uint16_t reqLineEnd,
+        const MagoST::FileLineRequest& request,
         std::list<AddressBinding>& bindings )
     {
         GuardedArea guard( mModGuard );
 
+        std::vector<MagoST::FileLineRequest>        requests( 1, request );
+        std::vector<std::list<MagoST::LineNumber>>  lines;
+
         for ( ModuleMap::iterator it = mModMap.begin();
             it != mModMap.end();
             it++ )
@@ -230,11 +224,11 @@ namespace Mago
             if ( !mod->GetSymbolSession( session ) )
                 continue;
 
-            std::list<MagoST::LineNumber> lines;
-            if( !session->FindLines( exactMatch, fileName, fileNameLen, reqLineStart, reqLineEnd, lines ) )
+            // BindLines tries an exact file name match before a partial one
+            if ( !session->BindLines( requests, lines ) || (lines.size() != 1) )
                 continue;
 
-            for( std::list<MagoST::LineNumber>::iterator lit = lines.begin(); lit != lines.end(); ++lit )
+            for( std::list<MagoST::LineNumber>::iterator lit = lines[0].begin(); lit != lines[0].end(); ++lit )
             {
                 MagoEE::Address addr = session->GetVAFromSecOffset( lit->Section, lit->Offset );
                 if ( addr == 0 )
@@ -264,7 +258,7 @@ namespace Mago
         if ( FAILED( hr ) )
             return hr;
 
-        memBytes->Init( addr, size, mDebugger, mCoreProc );
+        memBytes->Init( addr, size, this );
 
         *ppMemoryBytes = memBytes.Detach();
         return S_OK;
@@ -340,11 +334,15 @@ namespace Mago
 
     HRESULT Program::Execute()
     {
+        EnableMemoryCache( false );
+
         return mDebugger->Execute( GetCoreProcess(), !mPassExceptionToDebuggee );
     }
 
     HRESULT Program::Continue( IDebugThread2 *pThread )
     {
+        EnableMemoryCache( false );
+
         return mDebugger->Continue( GetCoreProcess(), !mPassExceptionToDebuggee );
     }
 
@@ -355,6 +353,8 @@ namespace Mago
 
         HRESULT hr = S_OK;
 
+        EnableMemoryCache( false );
+
         hr = StepInternal( pThread, sk, step );
         if ( FAILED( hr ) )
         {
@@ -530,6 +530,16 @@ namespace Mago
         mAttached = true;
     }
 
+    bool Program::GetLoadComplete()
+    {
+        return mLoadComplete;
+    }
+
+    void Program::SetLoadComplete()
+    {
+        mLoadComplete = true;
+    }
+
     void Program::SetPassExceptionToDebuggee( bool value )
     {
         if ( mCanPassExceptionToDebuggee )
@@ -853,4 +863,48 @@ namespace Mago
     {
         mEntryPoint = address;
     }
+
+    HRESULT Program::ReadMemory( 
+        Address64 address,
+        uint32_t length, 
+        uint32_t& lengthRead, 
+        uint32_t& lengthUnreadable, 
+        uint8_t* buffer )
+    {
+        return mMemCache.ReadMemory( mDebugger, mCoreProc, address, length, lengthRead, lengthUnreadable, buffer );
+    }
+
+    HRESULT Program::WriteMemory( 
+        Address64 address,
+        uint32_t length, 
+        uint32_t& lengthWritten, 
+        uint8_t* buffer )
+    {
+        // drop the pages even if the write fails, it might have been partly done
+        mMemCache.Invalidate( address, length );
+        mInstBlocks.Invalidate( address, length );
+
+        return mDebugger->WriteMemory( mCoreProc, address, length, lengthWritten, buffer );
+    }
+
+    void Program::PrefetchMemory( Address64 address, uint32_t length )
+    {
+        mMemCache.Prefetch( mDebugger, mCoreProc, address, length );
+    }
+
+    void Program::EnableMemoryCache( bool enable )
+    {
+        mMemCache.Enable( enable );
+        mInstBlocks.Clear();
+    }
+
+    bool Program::IsMemoryCacheEnabled()
+    {
+        return mMemCache.IsEnabled();
+    }
+
+    InstBlockCache& Program::GetInstBlockCache()
+    {
+        return mInstBlocks;
+    }
 }
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include "MemoryCache.h"
+#include "InstBlockCache.h"
+
 
 namespace Mago
 {
@@ -37,6 +40,7 @@ namespace Mago
         CComBSTR                        mName;
         RefPtr<ICoreProcess>            mCoreProc;
         bool                            mAttached;
+        bool                            mLoadComplete;
         bool                            mPassExceptionToDebuggee;
         bool                            mCanPassExceptionToDebuggee;
         IDebuggerProxy*                 mDebugger;
@@ -52,6 +56,8 @@ namespace Mago
         RefPtr<Module>                  mProgMod;
         RefPtr<Thread>                  mProgThread;
         UniquePtr<DRuntime>             mDRuntime;
+        MemoryCache                     mMemCache;
+        InstBlockCache                  mInstBlocks;
 
     public:
         Program();
@@ -118,6 +124,8 @@ namespace Mago
 
         bool        GetAttached();
         void        SetAttached();
+        bool        GetLoadComplete();
+        void        SetLoadComplete();
         void        SetPassExceptionToDebuggee( bool value );
         bool        CanPassExceptionToDebuggee();
         void        NotifyException( bool firstChance, const EXCEPTION_RECORD64* exceptRec );
@@ -143,6 +151,24 @@ namespace Mago
         void        SetEntryPoint( Address64 address );
         void        UpdateAAVersion( Module* mod );
 
+        // memory reads are cached while the program is stopped
+        HRESULT     ReadMemory( 
+            Address64 address,
+            uint32_t length, 
+            uint32_t& lengthRead, 
+            uint32_t& lengthUnreadable, 
+            uint8_t* buffer );
+        HRESULT     WriteMemory( 
+            Address64 address,
+            uint32_t length, 
+            uint32_t& lengthWritten, 
+            uint8_t* buffer );
+        void        PrefetchMemory( Address64 address, uint32_t length );
+        // stopping or running drops the cached memory and instruction blocks
+        void        EnableMemoryCache( bool enable );
+        bool        IsMemoryCacheEnabled();
+        InstBlockCache& GetInstBlockCache();
+
     private:
         HRESULT     StepInternal( IDebugThread2* pThread, STEPKIND sk, STEPUNIT step );
 
@@ -153,11 +179,7 @@ namespace Mago
         };
 
         bool        BindCodeContextsToFile( 
-            bool exactMatch, 
-            const char* fileName, 
-            size_t fileNameLen, 
-            uint16_t reqStartLine, 
-            uint16_t reqEndLine,
+            const MagoST::FileLineRequest& request,
             std::list<AddressBinding>& bindings );
     };
 }
@@ -294,7 +294,8 @@ Error:
     RemoteDebuggerProxy::RemoteDebuggerProxy()
         :   mRefCount( 0 ),
             mSessionGuid( GUID_NULL ),
-            mEventPhysicalTid( 0 )
+            mEventPhysicalTid( 0 ),
+            mNoReadBatch( false )
     {
         mhContext[0] = NULL;
         mhContext[1] = NULL;
@@ -671,6 +672,99 @@ Error:
         return hr;
     }
 
+    HRESULT RemoteDebuggerProxy::ReadMemoryBatch( 
+        ICoreProcess* process, 
+        uint32_t count, 
+        MemoryReadRange* ranges, 
+        uint8_t* buffer )
+    {
+        _ASSERT( process != NULL );
+        if ( process == NULL || (count > 0 && (ranges == NULL || buffer == NULL)) )
+            return E_INVALIDARG;
+
+        if ( process->GetProcessType() != CoreProcess_Remote )
+            return E_INVALIDARG;
+
+        std::vector<MagoRemote_MemoryRange> cmdRanges;
+        std::vector<MagoRemote_MemoryRead>  cmdReads;
+        uint32_t                            pid = process->GetPid();
+
+        // send as many ranges in each call as the agent takes
+        return ReadMemoryInBatches( 
+            this, 
+            process, 
+            count, 
+            ranges, 
+            buffer, 
+            MagoRemote_MaxReadBatchCount, 
+            MagoRemote_MaxReadBatchLength, 
+            mNoReadBatch, 
+            [&]( uint32_t batchCount, MemoryReadRange* batch, uint32_t length, uint8_t* batchBuf )
+        {
+            cmdRanges.resize( batchCount );
+            cmdReads.resize( batchCount );
+
+            for ( uint32_t i = 0; i < batchCount; i++ )
+            {
+                cmdRanges[i].Address = batch[i].Begin;
+                cmdRanges[i].Length = batch[i].Length;
+            }
+
+            HRESULT hr = ReadMemoryBatchNoException( 
+                pid,
+                batchCount,
+                &cmdRanges[0],
+                &cmdReads[0],
+                length,
+                batchBuf );
+
+            // the agent is older than the command, it won't know it next time either
+            if ( hr == HRESULT_FROM_WIN32( RPC_S_PROCNUM_OUT_OF_RANGE ) )
+                return E_NOTIMPL;
+
+            if ( FAILED( hr ) )
+                return hr;
+
+            for ( uint32_t i = 0; i < batchCount; i++ )
+            {
+                batch[i].Result = cmdReads[i].Result;
+                batch[i].LengthRead = cmdReads[i].LengthRead;
+                batch[i].LengthUnreadable = cmdReads[i].LengthUnreadable;
+            }
+
+            return S_OK;
+        } );
+    }
+
+    HRESULT RemoteDebuggerProxy::ReadMemoryBatchNoException( 
+        uint32_t pid, 
+        uint32_t count, 
+        MagoRemote_MemoryRange* cmdRanges, 
+        MagoRemote_MemoryRead* cmdReads, 
+        uint32_t length, 
+        uint8_t* buffer )
+    {
+        HRESULT hr = S_OK;
+
+        __try
+        {
+            hr = MagoRemoteCmd_ReadMemoryBatch( 
+                GetContextHandle(),
+                pid,
+                count,
+                cmdRanges,
+                cmdReads,
+                length,
+                buffer );
+        }
+        __except ( CommonRpcExceptionFilter( RpcExceptionCode() ) )
+        {
+            hr = HRESULT_FROM_WIN32( RpcExceptionCode() );
+        }
+
+        return hr;
+    }
+
     HRESULT RemoteDebuggerProxy::WriteMemory( 
         ICoreProcess* process, 
         Address64 address,
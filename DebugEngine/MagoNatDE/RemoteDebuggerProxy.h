@@ -14,6 +14,8 @@
 typedef void* HCTXCMD;
 typedef struct MagoRemote_LaunchInfo MagoRemote_LaunchInfo;
 typedef struct MagoRemote_ProcInfo MagoRemote_ProcInfo;
+typedef struct MagoRemote_MemoryRange MagoRemote_MemoryRange;
+typedef struct MagoRemote_MemoryRead MagoRemote_MemoryRead;
 
 
 namespace Mago
@@ -32,6 +34,7 @@ namespace Mago
         HCTXCMD                 mhContext[2];
         DWORD                   mEventPhysicalTid;
         std::wstring            mSymbolSearchPath;
+        bool                    mNoReadBatch;       // the agent doesn't have ReadMemoryBatch
 
     public:
         RemoteDebuggerProxy();
@@ -62,6 +65,12 @@ namespace Mago
             uint32_t& lengthUnreadable, 
             uint8_t* buffer );
 
+        HRESULT ReadMemoryBatch( 
+            ICoreProcess* process, 
+            uint32_t count, 
+            MemoryReadRange* ranges, 
+            uint8_t* buffer );
+
         HRESULT WriteMemory( 
             ICoreProcess* process, 
             Address64 address,
@@ -137,5 +146,12 @@ namespace Mago
         HRESULT AttachNoException( 
             uint32_t pid, 
             MagoRemote_ProcInfo& cmdProcInfo );
+        HRESULT ReadMemoryBatchNoException( 
+            uint32_t pid, 
+            uint32_t count, 
+            MagoRemote_MemoryRange* cmdRanges, 
+            MagoRemote_MemoryRead* cmdReads, 
+            uint32_t length, 
+            uint8_t* buffer );
     };
 }
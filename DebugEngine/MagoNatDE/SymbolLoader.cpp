@@ -0,0 +1,187 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "SymbolLoader.h"
+#include "Module.h"
+#include "EventCallback.h"
+#include <process.h>
+
+
+namespace Mago
+{
+    SymbolLoader::SymbolLoader()
+        :   mThreadCount( 0 ),
+            mShutdown( false )
+    {
+        memset( mhThreads, 0, sizeof mhThreads );
+    }
+
+    SymbolLoader::~SymbolLoader()
+    {
+        Shutdown();
+    }
+
+    HRESULT SymbolLoader::QueueLoad( DWORD uniquePid, Module* mod, EventCallback* callback )
+    {
+        _ASSERT( mod != NULL );
+        _ASSERT( callback != NULL );
+
+        HRESULT hr = S_OK;
+
+        {
+            GuardedArea guard( mJobGuard );
+
+            if ( mShutdown )
+                return E_FAIL;
+
+            hr = StartThreads();
+            if ( FAILED( hr ) )
+                return hr;
+
+            mJobs.push_back( Job() );
+            mJobs.back().UniquePid = uniquePid;
+            mJobs.back().Mod = mod;
+            mJobs.back().Callback = callback;
+        }
+
+        ReleaseSemaphore( mhJobSemaphore, 1, NULL );
+        return S_OK;
+    }
+
+    void SymbolLoader::Shutdown()
+    {
+        JobList dropped;
+
+        {
+            GuardedArea guard( mJobGuard );
+
+            mShutdown = true;
+            dropped.swap( mJobs );
+        }
+
+        if ( mThreadCount > 0 )
+        {
+            ReleaseSemaphore( mhJobSemaphore, mThreadCount, NULL );
+            WaitForMultipleObjects( mThreadCount, mhThreads, TRUE, INFINITE );
+
+            for ( int i = 0; i < mThreadCount; i++ )
+            {
+                CloseHandle( mhThreads[i] );
+                mhThreads[i] = NULL;
+            }
+
+            mThreadCount = 0;
+        }
+
+        // don't leave anyone waiting on symbols that won't come
+        for ( JobList::iterator it = dropped.begin(); it != dropped.end(); it++ )
+        {
+            it->Mod->EndLoadSymbols();
+        }
+
+        // the engine can start debugging again, so allow restarting the threads
+        GuardedArea guard( mJobGuard );
+        mShutdown = false;
+    }
+
+    HRESULT SymbolLoader::StartThreads()
+    {
+        if ( mThreadCount > 0 )
+            return S_OK;
+
+        if ( mhJobSemaphore.IsEmpty() )
+        {
+            mhJobSemaphore = CreateSemaphore( NULL, 0, LONG_MAX, NULL );
+            if ( mhJobSemaphore.IsEmpty() )
+                return GetLastHr();
+        }
+
+        SYSTEM_INFO sysInfo = { 0 };
+        int         threadCount = 0;
+
+        GetSystemInfo( &sysInfo );
+
+        // reading debug info is mostly I/O, so a few threads are enough
+        threadCount = std::min<int>( sysInfo.dwNumberOfProcessors, MaxThreads );
+        if ( threadCount < 1 )
+            threadCount = 1;
+
+        for ( int i = 0; i < threadCount; i++ )
+        {
+            HANDLE  hThread = (HANDLE) _beginthreadex(
+                NULL,
+                0,
+                LoaderProc,
+                this,
+                0,
+                NULL );
+            if ( hThread == NULL )
+                break;
+
+            mhThreads[mThreadCount++] = hThread;
+        }
+
+        if ( mThreadCount == 0 )
+            return GetLastHr();
+
+        return S_OK;
+    }
+
+    bool SymbolLoader::TakeJob( Job& job )
+    {
+        GuardedArea guard( mJobGuard );
+
+        if ( mShutdown || mJobs.empty() )
+            return false;
+
+        job = mJobs.front();
+        mJobs.pop_front();
+        return true;
+    }
+
+    void SymbolLoader::RunJobs()
+    {
+        for ( ; ; )
+        {
+            WaitForSingleObject( mhJobSemaphore, INFINITE );
+
+            if ( mShutdown )
+                break;
+
+            Job     job;
+
+            if ( !TakeJob( job ) )
+                continue;
+
+            // later we'll check if symbols were loaded
+            job.Mod->LoadSymbols( false );
+            job.Mod->EndLoadSymbols();
+
+            job.Callback->OnSymbolsLoaded( job.UniquePid, job.Mod );
+
+            // build the global name indexes now, so that the first expression doesn't wait
+            RefPtr<MagoST::ISession>    session;
+
+            if ( gOptions.cacheGlobalsOnLoad && job.Mod->GetSymbolSession( session ) )
+                session->CacheGlobals();
+        }
+    }
+
+    unsigned int SymbolLoader::LoaderProc( void* param )
+    {
+        _ASSERT( param != NULL );
+
+        SymbolLoader*   pThis = (SymbolLoader*) param;
+
+        CoInitializeEx( NULL, COINIT_MULTITHREADED );
+        pThis->RunJobs();
+        CoUninitialize();
+
+        return 0;
+    }
+}
@@ -0,0 +1,59 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace Mago
+{
+    class Module;
+    class EventCallback;
+
+
+    // Opens the symbol sessions of loaded modules on a small pool of threads,
+    // so that the debug event thread doesn't have to wait for debug info to be read.
+    // When a module's symbols are ready, the event callback is told on the worker thread.
+    // With the cacheGlobalsOnLoad option, the worker then builds the session's global name indexes.
+
+    class SymbolLoader
+    {
+        static const int    MaxThreads = 4;
+
+        struct Job
+        {
+            DWORD                   UniquePid;
+            RefPtr<Module>          Mod;
+            RefPtr<EventCallback>   Callback;
+        };
+
+        typedef std::list<Job>  JobList;
+
+        HANDLE              mhThreads[MaxThreads];
+        int                 mThreadCount;
+        HandlePtr           mhJobSemaphore;
+        JobList             mJobs;
+        volatile bool       mShutdown;
+        Guard               mJobGuard;
+
+    public:
+        SymbolLoader();
+        ~SymbolLoader();
+
+        // the module's symbols have to be marked as pending before calling this
+        HRESULT QueueLoad( DWORD uniquePid, Module* mod, EventCallback* callback );
+
+        // stops the worker threads; jobs that haven't started are dropped
+        void    Shutdown();
+
+    private:
+        HRESULT StartThreads();
+        bool    TakeJob( Job& job );
+        void    RunJobs();
+
+        static unsigned int __stdcall LoaderProc( void* param );
+    };
+}
@@ -15,6 +15,8 @@
 #include "IDebuggerProxy.h"
 #include "RegisterSet.h"
 #include "ArchData.h"
+#include "ArchDataX86.h"
+#include "ArchDataX64.h"
 #include "ICoreProcess.h"
 
 
@@ -246,6 +248,8 @@ namespace Mago
         // make sure our StepOut method knows that we don't know the caller's PC
         mCallerPC = 0;
 
+        PrefetchStack( topRegSet );
+
         hr = BuildCallstack( topRegSet, callstack );
         if ( FAILED( hr ) )
             return hr;
@@ -383,6 +387,22 @@ namespace Mago
 
     //------------------------------------------------------------------------
 
+    void Thread::PrefetchStack( IRegisterSet* topRegSet )
+    {
+        // The stack walk and the locals of the top frames are read from near the stack
+        // pointer. Ask for those pages together, instead of one read at a time after
+        // another, which costs a round trip each with a remote agent.
+
+        ArchData*       archData = mProg->GetCoreProcess()->GetArchData();
+        int             spRegId = (archData->GetPointerSize() == 8) ? RegX64_RSP : RegX86_ESP;
+        RegisterValue   spValue;
+
+        if ( FAILED( topRegSet->GetValue( spRegId, spValue ) ) )
+            return;
+
+        mProg->PrefetchMemory( (Address64) spValue.GetInt(), StackPrefetchSize );
+    }
+
     HRESULT Thread::BuildCallstack( IRegisterSet* topRegSet, Callstack& callstack )
     {
         Log::LogMessage( "Thread::BuildCallstack\n" );
@@ -473,12 +493,9 @@ namespace Mago
         HRESULT     hr = S_OK;
         uint32_t    lenRead = 0;
         uint32_t    lenUnreadable = 0;
-        RefPtr<ICoreProcess>    proc;
-
-        pThis->mProg->GetCoreProcess( proc.Ref() );
 
-        hr = pThis->mDebugger->ReadMemory( 
-            proc.Get(), 
+        // through the program, so that the pages read are kept while stopped
+        hr = pThis->mProg->ReadMemory( 
             (Address64) lpBaseAddress, 
             nSize, 
             lenRead, 
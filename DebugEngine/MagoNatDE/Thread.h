@@ -77,6 +77,9 @@ namespace Mago
         HRESULT Step( ICoreProcess* coreProc, STEPKIND sk, STEPUNIT step, bool handleException );
 
     private:
+        static const uint32_t StackPrefetchSize = 0x4000;
+
+        void    PrefetchStack( IRegisterSet* topRegSet );
         HRESULT BuildCallstack( IRegisterSet* topRegSet, Callstack& callstack );
         HRESULT AddCallstackFrame( IRegisterSet* regSet, Callstack& callstack );
         HRESULT MakeEnumFrameInfoFromCallstack( 
@@ -180,16 +180,11 @@ public:
 typedef UniquePtrBase<uint8_t*, NULL, HeapDeleter> HeapPtr;
 
 
-namespace Mago
-{
-    typedef uint64_t Address64;
+#include "Address.h"
 
-    struct AddressRange64
-    {
-        Address64 Begin;
-        Address64 End;
-    };
 
+namespace Mago
+{
     // 2 chars a byte in hex, and 2 for 0x prefix
     const size_t MaxAddrStringLength = (sizeof Address64 * 2) + 2;
 
@@ -627,6 +627,49 @@ HRESULT MagoRemoteCmd_ReadMemory(
     return hr;
 }
 
+HRESULT MagoRemoteCmd_ReadMemoryBatch( 
+    /* [in] */ HCTXCMD hContext,
+    /* [in] */ unsigned int pid,
+    /* [in] */ unsigned int count,
+    /* [in][size_is] */ const MagoRemote_MemoryRange *ranges,
+    /* [out][size_is] */ MagoRemote_MemoryRead *reads,
+    /* [in] */ unsigned int length,
+    /* [out][size_is] */ byte *buffer)
+{
+    if ( hContext == NULL || ranges == NULL || reads == NULL || buffer == NULL )
+        return E_INVALIDARG;
+
+    if ( count > MagoRemote_MaxReadBatchCount || length > MagoRemote_MaxReadBatchLength )
+        return E_INVALIDARG;
+
+    CmdContext*         context = (CmdContext*) hContext;
+    RefPtr<IProcess>    process;
+    unsigned int        offset = 0;
+
+    memset( reads, 0, count * sizeof *reads );
+
+    if ( !context->Session->FindProcess( pid, process.Ref() ) )
+        return E_NOT_FOUND;
+
+    for ( unsigned int i = 0; i < count; i++ )
+    {
+        if ( ranges[i].Length > length - offset )
+            return E_INVALIDARG;
+
+        reads[i].Result = context->Session->ExecThread.ReadMemory( 
+            process.Get(),
+            (Address) ranges[i].Address,
+            ranges[i].Length,
+            reads[i].LengthRead,
+            reads[i].LengthUnreadable,
+            buffer + offset );
+
+        offset += ranges[i].Length;
+    }
+
+    return S_OK;
+}
+
 HRESULT MagoRemoteCmd_WriteMemory( 
     /* [in] */ HCTXCMD hContext,
     /* [in] */ unsigned int pid,
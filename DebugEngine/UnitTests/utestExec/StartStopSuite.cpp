@@ -38,6 +38,7 @@ StartStopSuite::StartStopSuite()
     TEST_ADD( StartStopSuite::TestAttach );
     TEST_ADD( StartStopSuite::TestAsyncBreak );
     TEST_ADD( StartStopSuite::TestMultiProcess );
+    TEST_ADD( StartStopSuite::TestReadMemoryManyBPs );
 }
 
 void StartStopSuite::setup()
@@ -1060,3 +1061,114 @@ void StartStopSuite::TestMultiProcess()
         AssertProcessFinished( pid );
     }
 }
+
+void StartStopSuite::TestReadMemoryManyBPs()
+{
+    Exec    exec;
+
+    TEST_ASSERT_RETURN( SUCCEEDED( exec.Init( mCallback ) ) );
+
+    LaunchInfo  info = { 0 };
+    wchar_t     cmdLine[ MAX_PATH ] = L"";
+    RefPtr<IProcess>    proc;
+
+    swprintf_s( cmdLine, L"\"%s\"", SleepingDebuggee );
+
+    info.CommandLine = cmdLine;
+    info.Exe = SleepingDebuggee;
+
+    TEST_ASSERT_RETURN( SUCCEEDED( exec.Launch( &info, proc.Ref() ) ) );
+
+    bool        sawLoadCompleted = false;
+    uint32_t    pid = proc->GetId();
+
+    for ( ; !mCallback->GetProcessExited(); )
+    {
+        HRESULT hr = exec.WaitForEvent( DefaultTimeoutMillis );
+
+        // this should happen after process exit
+        if ( hr == E_TIMEOUT )
+            break;
+
+        TEST_ASSERT_RETURN( SUCCEEDED( hr ) );
+        TEST_ASSERT_RETURN( SUCCEEDED( exec.DispatchEvent() ) );
+
+        if ( proc->IsStopped() )
+        {
+            if ( !sawLoadCompleted && mCallback->GetLoadCompleted() )
+            {
+                sawLoadCompleted = true;
+
+                ReadWithManyBPs( exec, proc.Get() );
+
+                TEST_ASSERT_RETURN( SUCCEEDED( exec.Terminate( proc.Get() ) ) );
+            }
+            else
+            {
+                TEST_ASSERT_RETURN( SUCCEEDED( exec.Continue( proc, true ) ) );
+            }
+        }
+    }
+
+    TEST_ASSERT( mCallback->GetLoadCompleted() );
+    TEST_ASSERT( mCallback->GetProcessExited() );
+
+    AssertProcessFinished( pid );
+}
+
+// Measures small reads while many BPs are set. Only the BPs in the range read 
+// should be looked at, and none of them should show through.
+
+void StartStopSuite::ReadWithManyBPs( Exec& exec, IProcess* process )
+{
+    const uint32_t  BPCount = 10000;
+    const uint32_t  ReadCount = 100000;
+    const uint32_t  ReadSize = 4;
+
+    // put the BPs in zeroed memory of our own, so that the debuggee never runs them
+    void*   mem = VirtualAllocEx( process->GetHandle(), NULL, BPCount, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
+    TEST_ASSERT_RETURN( mem != NULL );
+
+    Address         baseAddr = (Address) mem;
+    LARGE_INTEGER   freq = { 0 };
+    LARGE_INTEGER   start = { 0 };
+    LARGE_INTEGER   end = { 0 };
+
+    for ( uint32_t i = 0; i < BPCount; i++ )
+    {
+        TEST_ASSERT_RETURN( SUCCEEDED( exec.SetBreakpoint( process, baseAddr + i ) ) );
+    }
+
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &start );
+
+    for ( uint32_t i = 0; i < ReadCount; i++ )
+    {
+        uint8_t     buffer[ReadSize] = { 0 };
+        uint32_t    lenRead = 0;
+        uint32_t    lenUnreadable = 0;
+        Address     addr = baseAddr + (i * 7919) % (BPCount - ReadSize);
+
+        HRESULT hr = exec.ReadMemory( process, addr, ReadSize, lenRead, lenUnreadable, buffer );
+        TEST_ASSERT_RETURN( SUCCEEDED( hr ) );
+        TEST_ASSERT_RETURN( lenRead == ReadSize );
+
+        for ( uint32_t j = 0; j < ReadSize; j++ )
+        {
+            TEST_ASSERT_RETURN( buffer[j] == 0 );
+        }
+    }
+
+    QueryPerformanceCounter( &end );
+
+    printf( "  %u reads of %u bytes with %u BPs: %.2f us each\n", 
+        ReadCount, ReadSize, BPCount,
+        (end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart / ReadCount );
+
+    for ( uint32_t i = 0; i < BPCount; i++ )
+    {
+        TEST_ASSERT_RETURN( SUCCEEDED( exec.RemoveBreakpoint( process, baseAddr + i ) ) );
+    }
+
+    VirtualFreeEx( process->GetHandle(), mem, 0, MEM_RELEASE );
+}
@@ -35,8 +35,10 @@ private:
     void TestAttach();
     void TestAsyncBreak();
     void TestMultiProcess();
+    void TestReadMemoryManyBPs();
 
     void TestDetachCore( bool detachWhileRunning );
+    void ReadWithManyBPs( Exec& exec, IProcess* process );
 
     void TryOptions( bool newConsole );
     void BuildEnv( wchar_t* env, int envSize, 
@@ -35,6 +35,7 @@ struct WantedAction
     bool        CanStepInFunction;
     int         FunctionIndex;
     uintptr_t   BPAddressOffset;
+    uintptr_t   RangeLength;
 };
 
 struct Step
@@ -136,6 +137,7 @@ StepOneThreadSuite::StepOneThreadSuite()
     TEST_ADD( StepOneThreadSuite::StepInstructionInSourceHaveSource );
     TEST_ADD( StepOneThreadSuite::StepInstructionInSourceNoSource );
     TEST_ADD( StepOneThreadSuite::StepInstructionOverInterruptedByBP );
+    TEST_ADD( StepOneThreadSuite::StepRangeOverLoops );
 }
 
 void StepOneThreadSuite::setup()
@@ -275,6 +277,27 @@ void StepOneThreadSuite::StepInstructionOverInterruptedByBP()
     RunDebuggee( steps, _countof( steps ) );
 }
 
+void StepOneThreadSuite::StepRangeOverLoops()
+{
+    // the rep string instruction and the loop in the first range run without 
+    // stopping at each instruction, and the second range steps over a call
+    Step    steps[] = 
+    {
+        { { ExecEvent_Breakpoint,   Func_Scenario1Func0, 0x0005, 0 }, { Action_StepInstruction, true, false } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func0, 0x0006, 0 }, { Action_StepInstruction, true, false } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func0, 0x0008, 0 }, { Action_StepInstruction, true, false } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func1, 0x0000, 0 }, { Action_StepInstruction, true, false } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func2, 0x0000, 0 }, { Action_StepRange, false, false, false, Func_None, 0, 0x000E } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func2, 0x000E, 0 }, { Action_StepRange, false, false, false, Func_None, 0, 0x0005 } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func2, 0x0013, 0 }, { Action_StepInstruction, false, false } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func1, 0x0005, 0 }, { Action_StepInstruction, false, false } },
+        { { ExecEvent_StepComplete, Func_Scenario1Func0, 0x000D, 0 }, { Action_Go, true, false } },
+        { { ExecEvent_ProcessExit,  Func_None,           0,      0 }, { Action_Go, true, false } },
+    };
+
+    RunDebuggee( steps, _countof( steps ) );
+}
+
 void StepOneThreadSuite::RunDebuggee( Step* steps, int stepsCount )
 {
     Exec    exec;
@@ -402,6 +425,8 @@ void StepOneThreadSuite::RunDebuggee( Step* steps, int stepsCount )
             else if ( curStep->Action.Action == Action_StepRange )
             {
                 AddressRange range = { context.Eip, context.Eip };
+                if ( curStep->Action.RangeLength != 0 )
+                    range.End = context.Eip + curStep->Action.RangeLength - 1;
                 TEST_ASSERT_RETURN( SUCCEEDED( 
                     exec.StepRange( process.Get(), curStep->Action.StepIn, range, true ) ) );
                 continued = true;
@@ -28,6 +28,7 @@ private:
     void StepInstructionInSourceHaveSource();
     void StepInstructionInSourceNoSource();
     void StepInstructionOverInterruptedByBP();
+    void StepRangeOverLoops();
 
     void RunDebuggee( Step* steps, int stepsCount );
 };
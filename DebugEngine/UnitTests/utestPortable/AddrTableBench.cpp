@@ -0,0 +1,154 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "AddrTableBench.h"
+#include "../../../CVSym/CVSym/OMFAddrTable.h"
+#include <chrono>
+
+typedef OMFAddrTable::Pair  Pair;
+
+
+// a big code segment, like the one of a D program with Phobos linked in, and a
+// few small ones
+static const DWORD  BenchGroupSizes[] = { 50000, 2000, 300, 10 };
+static const WORD   BenchGroupCount = _countof( BenchGroupSizes );
+
+
+static double ElapsedMs( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+static uint32_t NextRandom( uint32_t& seed )
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// lays out a table the way it follows a symbol hash: the group count, the
+// offsets and counts of the groups, then their (symbol offset, address offset)
+// pairs in address order
+static void MakeBenchTable( std::vector<BYTE>& buffer, DWORD& pairCount, DWORD& maxOffset )
+{
+    uint32_t    seed = 1;
+
+    pairCount = 0;
+
+    for ( WORD i = 0; i < BenchGroupCount; i++ )
+        pairCount += BenchGroupSizes[i];
+
+    buffer.assign( 4 + 8 * BenchGroupCount + pairCount * sizeof( Pair ), 0 );
+
+    WORD*   numGroups = (WORD*) &buffer[0];
+    DWORD*  offsets = (DWORD*) &buffer[4];
+    DWORD*  counts = offsets + BenchGroupCount;
+    Pair*   pairs = (Pair*) (counts + BenchGroupCount);
+    DWORD   symOffset = 0;
+
+    *numGroups = BenchGroupCount;
+    maxOffset = 0;
+
+    for ( WORD i = 0; i < BenchGroupCount; i++ )
+    {
+        DWORD   addr = 0x1000;
+
+        offsets[i] = (DWORD) ((BYTE*) pairs - (BYTE*) (counts + BenchGroupCount));
+        counts[i] = BenchGroupSizes[i];
+
+        for ( DWORD j = 0; j < BenchGroupSizes[i]; j++ )
+        {
+            pairs[j].first = symOffset;
+            pairs[j].second = addr;
+
+            symOffset += 0x20 + (NextRandom( seed ) % 0x40);
+            addr += 0x10 + (NextRandom( seed ) % 0x200);
+        }
+
+        maxOffset = std::max( maxOffset, addr );
+        pairs += BenchGroupSizes[i];
+    }
+}
+
+void RunAddrTableBench( uint32_t count )
+{
+    std::vector<BYTE>   buffer;
+    DWORD               pairCount = 0;
+    DWORD               maxOffset = 0;
+    uint32_t            seed = 7;
+    uint32_t            differed = 0;
+    uint32_t            found = 0;
+
+    MakeBenchTable( buffer, pairCount, maxOffset );
+
+    OMFAddrTable            table( &buffer[0] );
+    std::vector<WORD>       segments( count );
+    std::vector<DWORD>      addrs( count );
+    std::vector<uint32_t>   linearSyms( count );
+    std::vector<uint32_t>   binarySyms( count );
+    std::vector<bool>       linearFound( count );
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        segments[i] = (WORD) (1 + NextRandom( seed ) % BenchGroupCount);
+        addrs[i] = NextRandom( seed ) % (maxOffset + 0x100);
+    }
+
+    // what BuildAddrIndex does: the groups that are in order are used in place,
+    // and the others are copied and sorted
+    auto    start = std::chrono::steady_clock::now();
+    bool    sorted = true;
+
+    for ( WORD i = 0; i < BenchGroupCount; i++ )
+        sorted = OMFAddrTable::IsSorted( table.GetGroup( i ), table.GetNumItems( i ) ) && sorted;
+
+    double  checkMs = ElapsedMs( start );
+
+    std::vector<Pair>   shuffled( table.GetGroup( 0 ), table.GetGroup( 0 ) + table.GetNumItems( 0 ) );
+
+    for ( size_t i = shuffled.size() - 1; i > 0; i-- )
+        std::swap( shuffled[i], shuffled[NextRandom( seed ) % (i + 1)] );
+
+    start = std::chrono::steady_clock::now();
+
+    std::vector<Pair>   copy( shuffled.begin(), shuffled.end() );
+    OMFAddrTable::SortByOffset( copy.data(), (DWORD) copy.size() );
+
+    double  sortMs = ElapsedMs( start );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( uint32_t i = 0; i < count; i++ )
+        linearFound[i] = table.GetSymbolOffset( segments[i], addrs[i], linearSyms[i] );
+
+    double  linearMs = ElapsedMs( start );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        WORD    group = segments[i] - 1;
+        bool    ok = OMFAddrTable::FindSymbolOffset( table.GetGroup( group ), table.GetNumItems( group ), addrs[i], binarySyms[i] );
+
+        if ( (ok != linearFound[i]) || (ok && (binarySyms[i] != linearSyms[i])) )
+            differed++;
+        if ( ok )
+            found++;
+    }
+
+    double  binaryMs = ElapsedMs( start );
+
+    if ( !sorted || (copy != std::vector<Pair>( table.GetGroup( 0 ), table.GetGroup( 0 ) + table.GetNumItems( 0 ) )) )
+        differed++;
+
+    printf( "Address table: %u lookups (%u found) in %u symbols, linear scan in %.1f ms, binary search in %.1f ms: %.1fx; "
+        "checking the order took %.2f ms, sorting the biggest group %.2f ms",
+        count, found, pairCount, linearMs, binaryMs, (binaryMs > 0) ? linearMs / binaryMs : 0.0, checkMs, sortMs );
+    if ( differed != 0 )
+        printf( ", %u results differ", differed );
+    printf( "\n" );
+}
@@ -0,0 +1,14 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+// Looks up count random addresses in a large symbol hash address table, with
+// the linear scan and with the binary search over the sorted index, and prints
+// the times and how long the index took to build.
+void RunAddrTableBench( uint32_t count );
@@ -0,0 +1,278 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "../../Exec/Types.h"
+#include "../../Exec/DecodeX86.h"
+#include "DecodeX86Suite.h"
+
+
+static bool CheckFlow( 
+    const uint8_t* code, 
+    int codeLen, 
+    CpuSizeMode mode, 
+    InstructionFlow flow, 
+    int size, 
+    int32_t target = 0 );
+
+#define CHECK_FLOW( mode, flow, size, ... )                                         \
+    {                                                                               \
+        const uint8_t   code[] = { __VA_ARGS__ };                                   \
+        TEST_ASSERT_MSG( CheckFlow( code, sizeof code, mode, flow, size ), #__VA_ARGS__ );  \
+    }
+
+#define CHECK_BRANCH( mode, flow, size, target, ... )                               \
+    {                                                                               \
+        const uint8_t   code[] = { __VA_ARGS__ };                                   \
+        TEST_ASSERT_MSG( CheckFlow( code, sizeof code, mode, flow, size, target ), #__VA_ARGS__ );  \
+    }
+
+
+DecodeX86Suite::DecodeX86Suite()
+{
+    TEST_ADD( DecodeX86Suite::DecodePrefixes );
+    TEST_ADD( DecodeX86Suite::DecodeImmediates );
+    TEST_ADD( DecodeX86Suite::DecodeBranches );
+    TEST_ADD( DecodeX86Suite::DecodeOther );
+    TEST_ADD( DecodeX86Suite::DecodeTruncated );
+    TEST_ADD( DecodeX86Suite::FindRangeExits );
+    TEST_ADD( DecodeX86Suite::FindRangeExitsAtTop );
+    TEST_ADD( DecodeX86Suite::FailUndecodableRange );
+}
+
+static bool CheckFlow( 
+    const uint8_t* code, 
+    int codeLen, 
+    CpuSizeMode mode, 
+    InstructionFlow flow, 
+    int size, 
+    int32_t target )
+{
+    // trailing bytes must not change the length
+    uint8_t         mem[MAX_INSTRUCTION_SIZE + 4];
+    int             instSize = 0;
+    int32_t         instTarget = 0;
+    InstructionFlow instFlow = Flow_None;
+
+    memset( mem, 0x90, sizeof mem );
+    memcpy( mem, code, codeLen );
+
+    instFlow = GetInstructionFlow( mem, sizeof mem, mode, instSize, instTarget );
+    if ( instFlow != flow )
+        return false;
+
+    if ( flow == Flow_None )
+        return true;
+
+    if ( instSize != size )
+        return false;
+
+    if ( (flow == Flow_Branch || flow == Flow_Jump) && (instTarget != target) )
+        return false;
+
+    return true;
+}
+
+void DecodeX86Suite::DecodePrefixes()
+{
+    // add ax, 1234h
+    CHECK_FLOW( Cpu_32, Flow_Next, 4, 0x66, 0x05, 0x34, 0x12 );
+    // mov eax, fs:[bx]
+    CHECK_FLOW( Cpu_32, Flow_Next, 4, 0x64, 0x67, 0x8B, 0x07 );
+    // mov eax, [edi]
+    CHECK_FLOW( Cpu_64, Flow_Next, 3, 0x67, 0x8B, 0x07 );
+    // lock inc dword ptr [rax]
+    CHECK_FLOW( Cpu_64, Flow_Next, 3, 0xF0, 0xFF, 0x00 );
+    // 48 is dec eax in 32-bit mode, and not a prefix
+    CHECK_FLOW( Cpu_32, Flow_Next, 1, 0x48, 0x05, 0x78, 0x56, 0x34, 0x12 );
+    // a REX prefix before a legacy prefix is ignored, so this is add ax, 1234h
+    CHECK_FLOW( Cpu_64, Flow_Next, 5, 0x48, 0x66, 0x05, 0x34, 0x12 );
+    // rep movsb stops, but movsb doesn't
+    CHECK_FLOW( Cpu_32, Flow_Other, 2, 0xF3, 0xA4 );
+    CHECK_FLOW( Cpu_32, Flow_Next, 1, 0xA4 );
+}
+
+void DecodeX86Suite::DecodeImmediates()
+{
+    // add eax, 12345678h and add rax, 12345678h
+    CHECK_FLOW( Cpu_64, Flow_Next, 6, 0x81, 0xC0, 0x78, 0x56, 0x34, 0x12 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 7, 0x48, 0x81, 0xC0, 0x78, 0x56, 0x34, 0x12 );
+    // add ax, 1234h
+    CHECK_FLOW( Cpu_64, Flow_Next, 5, 0x66, 0x81, 0xC0, 0x34, 0x12 );
+    // REX.W wins over the operand size prefix, so this is add rax, 12345678h
+    CHECK_FLOW( Cpu_64, Flow_Next, 8, 0x66, 0x48, 0x81, 0xC0, 0x78, 0x56, 0x34, 0x12 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 7, 0x66, 0x48, 0x05, 0x78, 0x56, 0x34, 0x12 );
+
+    // mov ax, 1234h
+    CHECK_FLOW( Cpu_32, Flow_Next, 4, 0x66, 0xB8, 0x34, 0x12 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 4, 0x66, 0xB8, 0x34, 0x12 );
+    // mov rax, imm64
+    CHECK_FLOW( Cpu_64, Flow_Next, 10, 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 11, 0x66, 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 );
+
+    // mov eax, [moffs]
+    CHECK_FLOW( Cpu_32, Flow_Next, 5, 0xA1, 1, 2, 3, 4 );
+    CHECK_FLOW( Cpu_32, Flow_Next, 4, 0x67, 0xA1, 1, 2 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 9, 0xA1, 1, 2, 3, 4, 5, 6, 7, 8 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 6, 0x67, 0xA1, 1, 2, 3, 4 );
+
+    // test byte ptr [eax+esi*4+10h], 1
+    CHECK_FLOW( Cpu_32, Flow_Next, 5, 0xF6, 0x44, 0xB0, 0x10, 0x01 );
+    // enter 10h, 0
+    CHECK_FLOW( Cpu_32, Flow_Next, 4, 0xC8, 0x10, 0x00, 0x00 );
+}
+
+void DecodeX86Suite::DecodeBranches()
+{
+    // jz rel8
+    CHECK_BRANCH( Cpu_32, Flow_Branch, 2, 0x10, 0x74, 0x10 );
+    CHECK_BRANCH( Cpu_64, Flow_Branch, 2, -0x10, 0x74, 0xF0 );
+    // jz rel32 and jnz rel32
+    CHECK_BRANCH( Cpu_32, Flow_Branch, 6, 0x100, 0x0F, 0x84, 0x00, 0x01, 0x00, 0x00 );
+    CHECK_BRANCH( Cpu_64, Flow_Branch, 6, -6, 0x0F, 0x85, 0xFA, 0xFF, 0xFF, 0xFF );
+    // jecxz and loop
+    CHECK_BRANCH( Cpu_32, Flow_Branch, 2, 5, 0xE3, 0x05 );
+    CHECK_BRANCH( Cpu_64, Flow_Branch, 2, -2, 0xE2, 0xFE );
+
+    // jmp rel8 and jmp rel32
+    CHECK_BRANCH( Cpu_32, Flow_Jump, 2, -2, 0xEB, 0xFE );
+    CHECK_BRANCH( Cpu_32, Flow_Jump, 5, -5, 0xE9, 0xFB, 0xFF, 0xFF, 0xFF );
+    CHECK_BRANCH( Cpu_64, Flow_Jump, 5, 0x12345678, 0xE9, 0x78, 0x56, 0x34, 0x12 );
+    // REX.W doesn't change the displacement
+    CHECK_BRANCH( Cpu_64, Flow_Jump, 6, 0x10, 0x48, 0xE9, 0x10, 0x00, 0x00, 0x00 );
+
+    // the operand size prefix cuts the instruction pointer down to 16 bits
+    CHECK_FLOW( Cpu_32, Flow_Other, 4, 0x66, 0xE9, 0x34, 0x12 );
+    CHECK_FLOW( Cpu_32, Flow_Other, 3, 0x66, 0x74, 0x10 );
+    CHECK_FLOW( Cpu_32, Flow_Other, 5, 0x66, 0x0F, 0x84, 0x34, 0x12 );
+    // and processors disagree about what it does in 64-bit mode
+    CHECK_FLOW( Cpu_64, Flow_None, 0, 0x66, 0xE9, 0x34, 0x12, 0x00, 0x00 );
+    CHECK_FLOW( Cpu_64, Flow_None, 0, 0x66, 0x74, 0x10 );
+}
+
+void DecodeX86Suite::DecodeOther()
+{
+    // call rel32, call [rip+disp32], jmp eax, ret, ret 8, int 3, int 21h
+    CHECK_FLOW( Cpu_32, Flow_Other, 5, 0xE8, 0x00, 0x00, 0x00, 0x00 );
+    CHECK_FLOW( Cpu_64, Flow_Other, 6, 0xFF, 0x15, 0x00, 0x10, 0x00, 0x00 );
+    CHECK_FLOW( Cpu_32, Flow_Other, 2, 0xFF, 0xE0 );
+    CHECK_FLOW( Cpu_64, Flow_Other, 1, 0xC3 );
+    CHECK_FLOW( Cpu_32, Flow_Other, 3, 0xC2, 0x08, 0x00 );
+    CHECK_FLOW( Cpu_32, Flow_Other, 1, 0xCC );
+    CHECK_FLOW( Cpu_32, Flow_Other, 2, 0xCD, 0x21 );
+    // syscall
+    CHECK_FLOW( Cpu_64, Flow_Other, 2, 0x0F, 0x05 );
+    // far jmp doesn't exist in 64-bit mode
+    CHECK_FLOW( Cpu_32, Flow_Other, 7, 0xEA, 1, 2, 3, 4, 5, 6 );
+    CHECK_FLOW( Cpu_64, Flow_None, 0, 0xEA, 1, 2, 3, 4, 5, 6 );
+
+    // vzeroupper, and vpalignr xmm0, xmm0, xmm1, 8
+    CHECK_FLOW( Cpu_32, Flow_Next, 3, 0xC5, 0xF8, 0x77 );
+    CHECK_FLOW( Cpu_64, Flow_Next, 6, 0xC4, 0xE3, 0x79, 0x0F, 0xC1, 0x08 );
+    // in 32-bit mode, C5 with a memory operand is lds
+    CHECK_FLOW( Cpu_32, Flow_Next, 2, 0xC5, 0x00 );
+}
+
+void DecodeX86Suite::DecodeTruncated()
+{
+    const uint8_t   code[] = { 0x66, 0x0F, 0x84, 0x00, 0x01, 0x00, 0x00 };
+    int             size = 0;
+    int32_t         target = 0;
+
+    TEST_ASSERT( GetInstructionFlow( (uint8_t*) code, 1, Cpu_32, size, target ) == Flow_None );
+    TEST_ASSERT( GetInstructionFlow( (uint8_t*) &code[1], 1, Cpu_32, size, target ) == Flow_None );
+    TEST_ASSERT( GetInstructionFlow( (uint8_t*) &code[1], 5, Cpu_64, size, target ) == Flow_None );
+    TEST_ASSERT( GetInstructionFlow( (uint8_t*) &code[1], 6, Cpu_64, size, target ) == Flow_Branch );
+    TEST_ASSERT( size == 6 );
+}
+
+void DecodeX86Suite::FindRangeExits()
+{
+    const uint8_t   code[] = 
+    {
+        0x31, 0xC0,                     // 1000: xor eax, eax
+        0x90,                           // 1002: nop
+        0x3D, 0x10, 0x00, 0x00, 0x00,   // 1003: cmp eax, 10h
+        0x72, 0xF8,                     // 1008: jb 1002
+        0xE8, 0x00, 0x00, 0x00, 0x00,   // 100A: call
+        0x85, 0xC0,                     // 100F: test eax, eax
+        0x75, 0x20,                     // 1011: jnz 1033, out of the range
+        0x90,                           // 1013: nop
+        0xEB, 0xEA,                     // 1014: jmp 1000
+        0x90,                           // 1016: nop
+        0xB8, 0x01, 0x02, 0x03, 0x04,   // 1017: mov eax, 4030201h
+        0xEB, 0xFB,                     // 101C: jmp 1019, into the middle of the mov
+        0x90,                           // 101E: nop, falls through
+    };
+    AddressRange            range = { 0x1000, 0x101E };
+    std::vector<Address>    starts;
+    std::vector<Address>    exits;
+    const Address           expectedStarts[] = 
+    { 
+        0x1000, 0x1002, 0x1003, 0x1008, 0x100A, 0x100F, 0x1011, 0x1013, 0x1014, 
+        0x1016, 0x1017, 0x101C, 0x101E,
+    };
+    const Address           expectedExits[] = { 0x100A, 0x1011, 0x101C, 0x101E };
+
+    for ( int i = 0; i < 2; i++ )
+    {
+        CpuSizeMode mode = (i == 0) ? Cpu_32 : Cpu_64;
+
+        starts.clear();
+        exits.clear();
+
+        TEST_ASSERT_RETURN( GetRangeExits( (uint8_t*) code, sizeof code, range, mode, starts, exits ) );
+        TEST_ASSERT_RETURN( starts.size() == _countof( expectedStarts ) );
+        TEST_ASSERT_RETURN( exits.size() == _countof( expectedExits ) );
+        TEST_ASSERT( std::equal( starts.begin(), starts.end(), expectedStarts ) );
+        TEST_ASSERT( std::equal( exits.begin(), exits.end(), expectedExits ) );
+    }
+}
+
+void DecodeX86Suite::FindRangeExitsAtTop()
+{
+    const uint8_t   code[] = 
+    {
+        0x31, 0xC0,                     // FFFFFFF0: xor eax, eax
+        0x74, 0x0C,                     // FFFFFFF2: jz 0, after wrapping around
+        0x40, 0x40, 0x40, 0x40, 0x40,   // FFFFFFF4: inc eax
+        0x40, 0x40, 0x40, 0x40, 0x40,
+        0xEB, 0xF0,                     // FFFFFFFE: jmp FFFFFFF0
+    };
+    AddressRange            range = { 0xFFFFFFF0, 0xFFFFFFFF };
+    std::vector<Address>    starts;
+    std::vector<Address>    exits;
+
+    TEST_ASSERT_RETURN( GetRangeExits( (uint8_t*) code, sizeof code, range, Cpu_32, starts, exits ) );
+    TEST_ASSERT( starts.size() == 13 );
+    TEST_ASSERT( starts.back() == 0xFFFFFFFE );
+    TEST_ASSERT_RETURN( exits.size() == 1 );
+    TEST_ASSERT( exits[0] == 0xFFFFFFF2 );
+}
+
+void DecodeX86Suite::FailUndecodableRange()
+{
+    // FF /7 isn't an instruction
+    const uint8_t   code[] = { 0x90, 0x90, 0xFF, 0xF8, 0x90 };
+    AddressRange            range = { 0x1000, 0x1004 };
+    std::vector<Address>    starts;
+    std::vector<Address>    exits;
+
+    TEST_ASSERT( !GetRangeExits( (uint8_t*) code, sizeof code, range, Cpu_32, starts, exits ) );
+
+    // memory that runs out before the range does
+    starts.clear();
+    exits.clear();
+    range.End = 0x1001;
+    TEST_ASSERT( GetRangeExits( (uint8_t*) code, 2, range, Cpu_32, starts, exits ) );
+    TEST_ASSERT( exits.size() == 1 );
+
+    starts.clear();
+    exits.clear();
+    range.End = 0x1003;
+    TEST_ASSERT( !GetRangeExits( (uint8_t*) code, 2, range, Cpu_32, starts, exits ) );
+}
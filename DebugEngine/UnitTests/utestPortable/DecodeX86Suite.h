@@ -0,0 +1,25 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+class DecodeX86Suite : public Test::Suite
+{
+public:
+    DecodeX86Suite();
+
+private:
+    void DecodePrefixes();
+    void DecodeImmediates();
+    void DecodeBranches();
+    void DecodeOther();
+    void DecodeTruncated();
+    void FindRangeExits();
+    void FindRangeExitsAtTop();
+    void FailUndecodableRange();
+};
@@ -0,0 +1,31 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+/* d-demangle.c is compiled with this header forced in, so that the demangle
+   benchmark can count the demangler's allocations. */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern size_t DemangleAllocCount;
+
+void* DemangleCountedAlloc( size_t size );
+void* DemangleCountedRealloc( void* p, size_t size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#define XNEWVEC(T, n)       DemangleCountedAlloc(sizeof(T)*(n))
+#define XRESIZEVEC(T, p, n) DemangleCountedRealloc(p, sizeof(T)*(n))
+#define XDELETEVEC(p)       free(p)
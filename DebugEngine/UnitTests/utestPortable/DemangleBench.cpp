@@ -0,0 +1,118 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "DemangleBench.h"
+#include "DemangleAlloc.h"
+#include <chrono>
+
+extern "C" char* dlang_demangle( const char* mangled, int options );
+extern "C" int dlang_demangle_buffer( const char* mangled, int options, char** buffer, size_t* size );
+
+
+size_t  DemangleAllocCount;
+
+extern "C" void* DemangleCountedAlloc( size_t size )
+{
+    DemangleAllocCount++;
+    return malloc( size );
+}
+
+extern "C" void* DemangleCountedRealloc( void* p, size_t size )
+{
+    DemangleAllocCount++;
+    return realloc( p, size );
+}
+
+
+// the kinds of names a call stack and the modules window show for a D program:
+// runtime and library functions, templates, nested functions, and type info
+static const char* const DemangleCorpus[] =
+{
+    "_D2rt15deh_win64_posix9terminateFZv",
+    "_D2rt4util4hash6hashOfFNaNbNiNeAxvmZ9get16bitsFNaNbNiPxhZk",
+    "_D4core2gc11gcinterface2GC11__InterfaceZ",
+    "_D4core6memory2GC12ProfileStats6__initZ",
+    "_D8demangle4testFAiZv",
+    "_D8demangle4testFHiiZv",
+    "_D8demangle11__T4testTaZv",
+    "_D4core6thread6Thread5startMFNeZC4core6thread6Thread",
+    "_D4core4time8Duration6__initZ",
+    "_D6object9Throwable8toStringMFZAya",
+    "_D6object6Object8opEqualsMFC6ObjectZb",
+    "_D3std5array__T8AppenderTAyaZ8Appender6__initZ",
+    "_D3std4conv__T2toTiZ__T2toTAyaZ2toFNaNfAyaZi",
+    "_D3std5stdio4File17LockingTextWriter6__ctorMFNcNeKS3std5stdio4FileZS3std5stdio4File17LockingTextWriter",
+    "_D2rt6dmain211_d_run_mainUiPPaPUAAaZiZ7tryExecMFMDFZvZv",
+    "_D3std6format__T14formattedWriteTSQBg5stdio4File17LockingTextWriterTaTiZQCeFKQBwxAaiZk",
+    "_D6object__T4idupTxaZQjFNaNbNdNfAxaZAya",
+    "_D4core4sync5mutex5Mutex4lockMFNeZv",
+    "_D3std9exception__T7enforceZ__TQmTbZQrFNaNfbLC6object9ThrowableZb",
+};
+
+static const uint32_t   DemangleCorpusSize = sizeof DemangleCorpus / sizeof DemangleCorpus[0];
+
+
+static double ElapsedMs( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+void RunDemangleBench( uint32_t count )
+{
+    char*       buffer = NULL;
+    size_t      bufferSize = 0;
+    uint32_t    differed = 0;
+    uint32_t    calls = count * DemangleCorpusSize;
+
+    // both ways have to give the same names for the times to mean anything
+    for ( uint32_t i = 0; i < DemangleCorpusSize; i++ )
+    {
+        char*   name = dlang_demangle( DemangleCorpus[i], 0 );
+        int     len = dlang_demangle_buffer( DemangleCorpus[i], 0, &buffer, &bufferSize );
+
+        if ( (name == NULL) != (len < 0)
+            || ((name != NULL) && (strcmp( name, buffer ) != 0)) )
+            differed++;
+
+        free( name );
+    }
+
+    DemangleAllocCount = 0;
+    auto    start = std::chrono::steady_clock::now();
+
+    for ( uint32_t n = 0; n < count; n++ )
+    {
+        for ( uint32_t i = 0; i < DemangleCorpusSize; i++ )
+            free( dlang_demangle( DemangleCorpus[i], 0 ) );
+    }
+
+    double  singleMs = ElapsedMs( start );
+    size_t  singleAllocs = DemangleAllocCount;
+
+    DemangleAllocCount = 0;
+    start = std::chrono::steady_clock::now();
+
+    for ( uint32_t n = 0; n < count; n++ )
+    {
+        for ( uint32_t i = 0; i < DemangleCorpusSize; i++ )
+            dlang_demangle_buffer( DemangleCorpus[i], 0, &buffer, &bufferSize );
+    }
+
+    double  bufferMs = ElapsedMs( start );
+    size_t  bufferAllocs = DemangleAllocCount;
+
+    free( buffer );
+
+    printf( "Demangle: %u names, dlang_demangle in %.1f ms (%.2f allocations a name), "
+        "dlang_demangle_buffer in %.1f ms (%.2f allocations a name): %.1fx",
+        calls, singleMs, (double) singleAllocs / calls, bufferMs, (double) bufferAllocs / calls,
+        (bufferMs > 0) ? singleMs / bufferMs : 0.0 );
+    if ( differed != 0 )
+        printf( ", %u names differ", differed );
+    printf( "\n" );
+}
@@ -0,0 +1,14 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+// Demangles a list of D symbols count times, with dlang_demangle and with
+// dlang_demangle_buffer reusing one buffer, and prints the times and how many
+// times the demangler allocated.
+void RunDemangleBench( uint32_t count );
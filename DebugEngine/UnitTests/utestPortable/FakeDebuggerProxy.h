@@ -0,0 +1,165 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+#include "../../MagoNatDE/Address.h"
+#include "../../MagoNatDE/IDebuggerProxy.h"
+
+
+// A debugger proxy over a block of memory in this process, for testing the code
+// that reads debuggee memory. Pages can be made unreadable, and calls are counted.
+
+class FakeDebuggerProxy : public Mago::IDebuggerProxy
+{
+public:
+    static const uint32_t       PageSize = 0x1000;
+
+    Mago::Address64             Base;
+    std::vector<uint8_t>        Memory;
+    std::vector<bool>           Unreadable;     // by page
+
+    uint32_t                    ReadCount;
+    uint32_t                    BatchCount;
+    uint32_t                    RangesRead;
+
+    FakeDebuggerProxy( Mago::Address64 base, uint32_t pageCount )
+        :   Base( base ),
+            Memory( pageCount * PageSize ),
+            Unreadable( pageCount ),
+            ReadCount( 0 ),
+            BatchCount( 0 ),
+            RangesRead( 0 )
+    {
+        for ( size_t i = 0; i < Memory.size(); i++ )
+            Memory[i] = (uint8_t) (i * 7 + (i >> 12));
+    }
+
+    void ResetCounts()
+    {
+        ReadCount = 0;
+        BatchCount = 0;
+        RangesRead = 0;
+    }
+
+    bool IsReadable( Mago::Address64 address )
+    {
+        if ( (address < Base) || (address - Base >= Memory.size()) )
+            return false;
+
+        return !Unreadable[(size_t) ((address - Base) / PageSize)];
+    }
+
+    // changes memory behind the back of anyone reading it, like the debuggee does
+    void Poke( Mago::Address64 address, uint8_t value )
+    {
+        Memory[(size_t) (address - Base)] = value;
+    }
+
+    virtual HRESULT ReadMemory( 
+        Mago::ICoreProcess* process, 
+        Mago::Address64 address,
+        uint32_t length, 
+        uint32_t& lengthRead, 
+        uint32_t& lengthUnreadable, 
+        uint8_t* buffer )
+    {
+        ReadCount++;
+        return ReadDirect( address, length, lengthRead, lengthUnreadable, buffer );
+    }
+
+    // the same as ReadMemory, without counting
+    HRESULT ReadDirect(
+        Mago::Address64 address,
+        uint32_t length, 
+        uint32_t& lengthRead, 
+        uint32_t& lengthUnreadable, 
+        uint8_t* buffer )
+    {
+        uint32_t    i = 0;
+
+        // readable bytes first, then unreadable ones up to the next readable byte
+        for ( ; (i < length) && IsReadable( address + i ); i++ )
+            buffer[i] = Memory[(size_t) (address + i - Base)];
+
+        lengthRead = i;
+
+        for ( ; (i < length) && !IsReadable( address + i ); i++ )
+            ;
+
+        lengthUnreadable = i - lengthRead;
+        return S_OK;
+    }
+
+    virtual HRESULT ReadMemoryBatch( 
+        Mago::ICoreProcess* process, 
+        uint32_t count, 
+        Mago::MemoryReadRange* ranges, 
+        uint8_t* buffer )
+    {
+        BatchCount++;
+        RangesRead += count;
+
+        uint8_t* dest = buffer;
+
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            ranges[i].Result = ReadDirect( 
+                ranges[i].Begin, 
+                ranges[i].Length, 
+                ranges[i].LengthRead, 
+                ranges[i].LengthUnreadable, 
+                dest );
+
+            dest += ranges[i].Length;
+        }
+
+        return S_OK;
+    }
+
+    virtual HRESULT WriteMemory( 
+        Mago::ICoreProcess* process, 
+        Mago::Address64 address,
+        uint32_t length, 
+        uint32_t& lengthWritten, 
+        uint8_t* buffer )
+    {
+        uint32_t    i = 0;
+
+        for ( ; (i < length) && IsReadable( address + i ); i++ )
+            Memory[(size_t) (address + i - Base)] = buffer[i];
+
+        lengthWritten = i;
+        return S_OK;
+    }
+
+    virtual HRESULT Launch( LaunchInfo* launchInfo, Mago::ICoreProcess*& process ) { return E_NOTIMPL; }
+    virtual HRESULT Attach( uint32_t id, Mago::ICoreProcess*& process ) { return E_NOTIMPL; }
+    virtual HRESULT Terminate( Mago::ICoreProcess* process ) { return E_NOTIMPL; }
+    virtual HRESULT Detach( Mago::ICoreProcess* process ) { return E_NOTIMPL; }
+    virtual HRESULT ResumeLaunchedProcess( Mago::ICoreProcess* process ) { return E_NOTIMPL; }
+    virtual HRESULT SetBreakpoint( Mago::ICoreProcess* process, Mago::Address64 address ) { return E_NOTIMPL; }
+    virtual HRESULT RemoveBreakpoint( Mago::ICoreProcess* process, Mago::Address64 address ) { return E_NOTIMPL; }
+    virtual HRESULT StepOut( Mago::ICoreProcess* process, Mago::Address64 targetAddr, bool handleException ) { return E_NOTIMPL; }
+    virtual HRESULT StepInstruction( Mago::ICoreProcess* process, bool stepIn, bool handleException ) { return E_NOTIMPL; }
+    virtual HRESULT StepRange( 
+        Mago::ICoreProcess* process, bool stepIn, Mago::AddressRange64 range, bool handleException ) { return E_NOTIMPL; }
+    virtual HRESULT Continue( Mago::ICoreProcess* process, bool handleException ) { return E_NOTIMPL; }
+    virtual HRESULT Execute( Mago::ICoreProcess* process, bool handleException ) { return E_NOTIMPL; }
+    virtual HRESULT AsyncBreak( Mago::ICoreProcess* process ) { return E_NOTIMPL; }
+    virtual HRESULT GetThreadContext( 
+        Mago::ICoreProcess* process, Mago::ICoreThread* thread, Mago::IRegisterSet*& regSet ) { return E_NOTIMPL; }
+    virtual HRESULT SetThreadContext( 
+        Mago::ICoreProcess* process, Mago::ICoreThread* thread, Mago::IRegisterSet* regSet ) { return E_NOTIMPL; }
+    virtual HRESULT GetPData( 
+        Mago::ICoreProcess* process, 
+        Mago::Address64 address, 
+        Mago::Address64 imageBase, 
+        uint32_t size, 
+        uint32_t& sizeRead, 
+        uint8_t* pdata ) { return E_NOTIMPL; }
+};
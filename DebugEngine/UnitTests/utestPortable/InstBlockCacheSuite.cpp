@@ -0,0 +1,109 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "InstBlockCacheSuite.h"
+#include "../../MagoNatDE/Address.h"
+#include "../../MagoNatDE/InstBlockCache.h"
+
+using Mago::Address64;
+using Mago::InstBlock;
+using Mago::InstBlockCache;
+
+
+static const Address64  Base = 0x400000;
+static const uint32_t   BlockSize = InstBlock::BlockSize;
+
+
+InstBlockCacheSuite::InstBlockCacheSuite()
+{
+    TEST_ADD( InstBlockCacheSuite::FindAdded );
+    TEST_ADD( InstBlockCacheSuite::DropLeastRecentlyUsed );
+    TEST_ADD( InstBlockCacheSuite::InvalidateOverlapping );
+    TEST_ADD( InstBlockCacheSuite::KeepHeldBlocks );
+}
+
+void InstBlockCacheSuite::FindAdded()
+{
+    InstBlockCache  cache;
+
+    TEST_ASSERT( cache.Find( Base ) == NULL );
+
+    std::shared_ptr<InstBlock>  block = cache.Add( Base );
+
+    TEST_ASSERT_RETURN( block != NULL );
+    TEST_ASSERT( block->Address == Base );
+    TEST_ASSERT( block->State == Mago::BlockState_Invalid );
+    TEST_ASSERT( cache.Find( Base ) == block );
+    TEST_ASSERT( cache.Find( Base + BlockSize ) == NULL );
+
+    // adding it again replaces it
+    std::shared_ptr<InstBlock>  newBlock = cache.Add( Base );
+
+    TEST_ASSERT( newBlock != block );
+    TEST_ASSERT( cache.Find( Base ) == newBlock );
+    TEST_ASSERT( cache.GetCount() == 1 );
+}
+
+void InstBlockCacheSuite::DropLeastRecentlyUsed()
+{
+    InstBlockCache  cache;
+
+    for ( uint32_t i = 0; i < InstBlockCache::MaxBlocks; i++ )
+        cache.Add( Base + i * BlockSize );
+
+    // the first block is used again, so the second one is the oldest
+    TEST_ASSERT( cache.Find( Base ) != NULL );
+
+    cache.Add( Base + InstBlockCache::MaxBlocks * BlockSize );
+
+    TEST_ASSERT( cache.GetCount() == InstBlockCache::MaxBlocks );
+    TEST_ASSERT( cache.Find( Base ) != NULL );
+    TEST_ASSERT( cache.Find( Base + BlockSize ) == NULL );
+    TEST_ASSERT( cache.Find( Base + 2 * BlockSize ) != NULL );
+    TEST_ASSERT( cache.Find( Base + InstBlockCache::MaxBlocks * BlockSize ) != NULL );
+}
+
+void InstBlockCacheSuite::InvalidateOverlapping()
+{
+    InstBlockCache  cache;
+
+    for ( uint32_t i = 0; i < 4; i++ )
+        cache.Add( Base + i * BlockSize );
+
+    // the last byte of the second block and the first of the third
+    cache.Invalidate( Base + 2 * BlockSize - 1, 2 );
+
+    TEST_ASSERT( cache.Find( Base ) != NULL );
+    TEST_ASSERT( cache.Find( Base + BlockSize ) == NULL );
+    TEST_ASSERT( cache.Find( Base + 2 * BlockSize ) == NULL );
+    TEST_ASSERT( cache.Find( Base + 3 * BlockSize ) != NULL );
+
+    // up to the end of the address space
+    cache.Invalidate( Base + 3 * BlockSize, 0xFFFFFFFF );
+    TEST_ASSERT( cache.Find( Base + 3 * BlockSize ) == NULL );
+    TEST_ASSERT( cache.GetCount() == 1 );
+
+    cache.Clear();
+    TEST_ASSERT( cache.GetCount() == 0 );
+}
+
+void InstBlockCacheSuite::KeepHeldBlocks()
+{
+    InstBlockCache              cache;
+    std::shared_ptr<InstBlock>  held = cache.Add( Base );
+
+    held->State = Mago::BlockState_Loaded;
+    held->Inst[0] = 0x90;
+
+    // a stream still using a block can finish with it after the program drops it
+    cache.Clear();
+
+    TEST_ASSERT( cache.Find( Base ) == NULL );
+    TEST_ASSERT( held->Address == Base );
+    TEST_ASSERT( held->Inst[0] == 0x90 );
+}
@@ -0,0 +1,21 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+class InstBlockCacheSuite : public Test::Suite
+{
+public:
+    InstBlockCacheSuite();
+
+private:
+    void FindAdded();
+    void DropLeastRecentlyUsed();
+    void InvalidateOverlapping();
+    void KeepHeldBlocks();
+};
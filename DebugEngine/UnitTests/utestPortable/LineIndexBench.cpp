@@ -0,0 +1,217 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "LineIndexBench.h"
+#include "../../../CVSym/CVSym/LineRangeIndex.h"
+#include <chrono>
+
+
+static const WORD       BenchSeg = 1;
+static const uint16_t   BenchCompilandCount = 3000;
+static const uint16_t   BenchFileCount = 3;         // per compiland
+static const uint16_t   BenchPartCount = 4;         // contributions to the code section, per compiland
+
+
+// what the line tables of a compiland say about where its code is: the parts
+// of the section it contributes (its OMFSegDesc table), and for each source
+// file, the ranges of its line number blocks (start/end pairs)
+struct BenchCompiland
+{
+    std::vector<std::pair<DWORD, DWORD> >   Parts;
+    std::vector<std::vector<std::pair<DWORD, DWORD> > > FileRanges;
+};
+
+struct BenchBlock
+{
+    uint16_t    CompIndex;
+    uint16_t    FileIndex;
+    uint16_t    SegInstance;
+};
+
+
+static double ElapsedMs( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+static uint32_t NextRandom( uint32_t& seed )
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// each part of a compiland is one function, from one of its files, and the
+// parts of all compilands are spread over the section, like COMDATs are
+static void MakeBenchProgram( std::vector<BenchCompiland>& comps, DWORD& sectionSize )
+{
+    std::vector<uint32_t>   order( BenchCompilandCount * BenchPartCount );
+    uint32_t                seed = 3;
+    DWORD                   offset = 0x10;
+
+    for ( uint32_t i = 0; i < order.size(); i++ )
+        order[i] = i;
+
+    for ( size_t i = order.size() - 1; i > 0; i-- )
+        std::swap( order[i], order[NextRandom( seed ) % (i + 1)] );
+
+    comps.assign( BenchCompilandCount, BenchCompiland() );
+
+    for ( uint16_t i = 0; i < BenchCompilandCount; i++ )
+    {
+        comps[i].Parts.resize( BenchPartCount );
+        comps[i].FileRanges.resize( BenchFileCount );
+    }
+
+    for ( uint32_t part : order )
+    {
+        BenchCompiland& comp = comps[part / BenchPartCount];
+        DWORD           size = 0x20 + (NextRandom( seed ) % 0x400);
+
+        comp.Parts[part % BenchPartCount] = std::make_pair( offset, size );
+        offset += size + (NextRandom( seed ) % 0x10);
+    }
+
+    for ( BenchCompiland& comp : comps )
+    {
+        for ( uint16_t part = 0; part < BenchPartCount; part++ )
+        {
+            DWORD   start = comp.Parts[part].first;
+            DWORD   end = start + comp.Parts[part].second - 1;
+
+            comp.FileRanges[part % BenchFileCount].push_back( std::make_pair( start, end ) );
+        }
+    }
+
+    sectionSize = offset;
+}
+
+// the way FindCompilandFileSegmentByOffset looked before the index: the first
+// compiland with a part that holds the address, then the first file with a
+// line block that does
+static bool FindBlockByWalking( const std::vector<BenchCompiland>& comps, DWORD offset, BenchBlock& block )
+{
+    for ( uint16_t zCompIx = 0; zCompIx < comps.size(); zCompIx++ )
+    {
+        const BenchCompiland&   comp = comps[zCompIx];
+
+        for ( uint16_t modSegIx = 0; modSegIx < comp.Parts.size(); modSegIx++ )
+        {
+            if ( (offset >= comp.Parts[modSegIx].first)
+                && ((offset - comp.Parts[modSegIx].first + 1) <= comp.Parts[modSegIx].second) )
+            {
+                for ( uint16_t zFileIx = 0; zFileIx < comp.FileRanges.size(); zFileIx++ )
+                {
+                    for ( uint16_t zSegIx = 0; zSegIx < comp.FileRanges[zFileIx].size(); zSegIx++ )
+                    {
+                        if ( (comp.FileRanges[zFileIx][zSegIx].first <= offset)
+                            && (comp.FileRanges[zFileIx][zSegIx].second >= offset) )
+                        {
+                            block.CompIndex = zCompIx + 1;
+                            block.FileIndex = zFileIx;
+                            block.SegInstance = zSegIx;
+                            return true;
+                        }
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    return false;
+}
+
+// what BuildLineIndex adds for each line block
+static void BuildBenchIndex( const std::vector<BenchCompiland>& comps, LineRangeIndex& index )
+{
+    index.Clear();
+
+    for ( uint16_t zCompIx = 0; zCompIx < comps.size(); zCompIx++ )
+    {
+        for ( uint16_t zFileIx = 0; zFileIx < comps[zCompIx].FileRanges.size(); zFileIx++ )
+        {
+            const std::vector<std::pair<DWORD, DWORD> >&    ranges = comps[zCompIx].FileRanges[zFileIx];
+
+            for ( uint16_t zSegIx = 0; zSegIx < ranges.size(); zSegIx++ )
+            {
+                LineRangeIndex::Range   range = { 0 };
+
+                range.Seg = BenchSeg;
+                range.CompIndex = zCompIx + 1;
+                range.FileIndex = zFileIx;
+                range.SegInstance = zSegIx;
+                range.Start = ranges[zSegIx].first;
+                range.End = ranges[zSegIx].second;
+
+                index.Add( range );
+            }
+        }
+    }
+
+    index.Sort();
+}
+
+void RunLineIndexBench( uint32_t count )
+{
+    std::vector<BenchCompiland> comps;
+    std::vector<DWORD>          addrs( count );
+    std::vector<BenchBlock>     walked( count );
+    std::vector<bool>           walkedFound( count );
+    LineRangeIndex              index;
+    DWORD                       sectionSize = 0;
+    uint32_t                    seed = 5;
+    uint32_t                    differed = 0;
+    uint32_t                    found = 0;
+
+    MakeBenchProgram( comps, sectionSize );
+
+    // a few addresses fall in the gaps between functions
+    for ( uint32_t i = 0; i < count; i++ )
+        addrs[i] = NextRandom( seed ) % sectionSize;
+
+    auto    start = std::chrono::steady_clock::now();
+
+    for ( uint32_t i = 0; i < count; i++ )
+        walkedFound[i] = FindBlockByWalking( comps, addrs[i], walked[i] );
+
+    double  walkMs = ElapsedMs( start );
+
+    start = std::chrono::steady_clock::now();
+
+    BuildBenchIndex( comps, index );
+
+    double  buildMs = ElapsedMs( start );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        const LineRangeIndex::Range*    range = index.Find( BenchSeg, addrs[i] );
+
+        if ( (range != NULL) != walkedFound[i] )
+            differed++;
+        else if ( (range != NULL)
+            && ((range->CompIndex != walked[i].CompIndex)
+                || (range->FileIndex != walked[i].FileIndex)
+                || (range->SegInstance != walked[i].SegInstance)) )
+            differed++;
+
+        if ( range != NULL )
+            found++;
+    }
+
+    double  indexMs = ElapsedMs( start );
+
+    printf( "Line index: %u lookups (%u found) in %u compilands, walking in %.1f ms, index in %.1f ms: %.1fx; "
+        "building the index of %u ranges took %.2f ms",
+        count, found, (uint32_t) comps.size(), walkMs, indexMs, (indexMs > 0) ? walkMs / indexMs : 0.0,
+        (uint32_t) index.GetCount(), buildMs );
+    if ( differed != 0 )
+        printf( ", %u results differ", differed );
+    printf( "\n" );
+}
@@ -0,0 +1,14 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+// Finds the line number blocks for count random addresses in the code of a
+// large program, by walking its compilands and files the way FindLine used to,
+// then with the sorted line range index, and prints the times.
+void RunLineIndexBench( uint32_t count );
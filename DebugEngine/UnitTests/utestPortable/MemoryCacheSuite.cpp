@@ -0,0 +1,261 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "MemoryCacheSuite.h"
+#include "FakeDebuggerProxy.h"
+#include "../../MagoNatDE/MemoryCache.h"
+
+using Mago::Address64;
+using Mago::MemoryCache;
+
+
+static const Address64  Base = 0x10000;
+static const uint32_t   PageCount = 64;
+static const uint32_t   PageSize = FakeDebuggerProxy::PageSize;
+
+
+// reads through the cache, and checks the result against the memory behind it
+static bool ReadAndCompare( 
+    MemoryCache& cache, 
+    FakeDebuggerProxy& proxy, 
+    Address64 address, 
+    uint32_t length )
+{
+    std::vector<uint8_t>    cached( length + 1 );
+    std::vector<uint8_t>    direct( length + 1 );
+    uint32_t                cachedRead = 0;
+    uint32_t                cachedUnreadable = 0;
+    uint32_t                directRead = 0;
+    uint32_t                directUnreadable = 0;
+
+    if ( cache.ReadMemory( &proxy, NULL, address, length, cachedRead, cachedUnreadable, &cached[0] ) != S_OK )
+        return false;
+    proxy.ReadDirect( address, length, directRead, directUnreadable, &direct[0] );
+
+    return (cachedRead == directRead)
+        && (cachedUnreadable == directUnreadable)
+        && (memcmp( &cached[0], &direct[0], cachedRead ) == 0);
+}
+
+// what Program::WriteMemory does
+static HRESULT WriteThroughProgram( 
+    MemoryCache& cache, 
+    FakeDebuggerProxy& proxy, 
+    Address64 address, 
+    uint32_t length, 
+    uint8_t* buffer )
+{
+    uint32_t    lengthWritten = 0;
+
+    cache.Invalidate( address, length );
+    return proxy.WriteMemory( NULL, address, length, lengthWritten, buffer );
+}
+
+
+MemoryCacheSuite::MemoryCacheSuite()
+{
+    TEST_ADD( MemoryCacheSuite::ReadHits );
+    TEST_ADD( MemoryCacheSuite::ReadUnreadablePages );
+    TEST_ADD( MemoryCacheSuite::ReadWhileDisabled );
+    TEST_ADD( MemoryCacheSuite::InvalidateOnWrite );
+    TEST_ADD( MemoryCacheSuite::InvalidateOnContinue );
+    TEST_ADD( MemoryCacheSuite::PrefetchRanges );
+    TEST_ADD( MemoryCacheSuite::MatchDirectReads );
+}
+
+void MemoryCacheSuite::ReadHits()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+
+    cache.Enable( true );
+
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base + 0x10, 16 ) );
+    TEST_ASSERT( proxy.ReadCount == 1 );
+
+    // the same page, and other bytes of it
+    proxy.ResetCounts();
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base + 0x10, 16 ) );
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base + PageSize - 8, 8 ) );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+
+    // the missing pages of a read are asked for together
+    proxy.ResetCounts();
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base + PageSize - 8, 3 * PageSize ) );
+    TEST_ASSERT( proxy.BatchCount == 1 );
+    TEST_ASSERT( proxy.RangesRead == 1 );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+}
+
+void MemoryCacheSuite::ReadUnreadablePages()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+
+    proxy.Unreadable[2] = true;
+    proxy.Unreadable[3] = true;
+    cache.Enable( true );
+
+    // readable bytes, then unreadable ones, like the proxy returns them
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + PageSize + 0x100, 4 * PageSize ) );
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + 2 * PageSize + 0x10, 3 * PageSize ) );
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + 3 * PageSize, 16 ) );
+
+    // unreadable pages are cached too
+    proxy.ResetCounts();
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + 2 * PageSize + 0x20, 0x20 ) );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+
+    // outside of the memory altogether
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base - 0x10, 0x20 ) );
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + PageCount * PageSize - 0x10, 0x20 ) );
+}
+
+void MemoryCacheSuite::ReadWhileDisabled()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base + 0x10, 16 ) );
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base + 0x10, 16 ) );
+    TEST_ASSERT( proxy.ReadCount == 2 );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+
+    // big reads go straight to the proxy, even while enabled
+    cache.Enable( true );
+    proxy.ResetCounts();
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base, MemoryCache::MaxCachedRead + 1 ) );
+    TEST_ASSERT( proxy.ReadCount == 1 );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+}
+
+void MemoryCacheSuite::InvalidateOnWrite()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+    uint8_t             bytes[4] = { 0xDE, 0xAD, 0xBE, 0xEF };
+
+    cache.Enable( true );
+
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base, 4 * PageSize ) );
+
+    // a write across two pages
+    TEST_ASSERT_RETURN( WriteThroughProgram( cache, proxy, Base + 2 * PageSize - 2, 4, bytes ) == S_OK );
+
+    proxy.ResetCounts();
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + 2 * PageSize - 8, 16 ) );
+    TEST_ASSERT( (proxy.ReadCount + proxy.BatchCount) > 0 );
+
+    // the pages that weren't written are still cached, a change behind the cache's back isn't seen
+    proxy.Poke( Base + 0x10, 0x55 );
+    proxy.ResetCounts();
+
+    uint8_t     value = 0;
+    uint32_t    lenRead = 0;
+    uint32_t    lenUnreadable = 0;
+
+    TEST_ASSERT_RETURN( cache.ReadMemory( &proxy, NULL, Base + 0x10, 1, lenRead, lenUnreadable, &value ) == S_OK );
+    TEST_ASSERT( lenRead == 1 );
+    TEST_ASSERT( value != 0x55 );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+}
+
+void MemoryCacheSuite::InvalidateOnContinue()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+
+    // stopped
+    cache.Enable( true );
+    TEST_ASSERT_RETURN( ReadAndCompare( cache, proxy, Base, 16 ) );
+
+    // continuing disables the cache, and the debuggee changes its memory while running
+    cache.Enable( false );
+    proxy.Poke( Base + 4, 0x55 );
+    proxy.ResetCounts();
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base, 16 ) );
+    TEST_ASSERT( proxy.ReadCount == 1 );
+
+    // stopping again starts empty
+    cache.Enable( true );
+    proxy.Poke( Base + 5, 0x66 );
+    proxy.ResetCounts();
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base, 16 ) );
+    TEST_ASSERT( proxy.ReadCount == 1 );
+}
+
+void MemoryCacheSuite::PrefetchRanges()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+
+    // nothing while disabled
+    cache.Prefetch( &proxy, NULL, Base, 4 * PageSize );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+
+    cache.Enable( true );
+    cache.Prefetch( &proxy, NULL, Base + PageSize, PageSize );
+    cache.Prefetch( &proxy, NULL, Base, 4 * PageSize );
+
+    // the second one only asks for the pages around the first one
+    TEST_ASSERT( proxy.BatchCount == 2 );
+    TEST_ASSERT( proxy.RangesRead == 3 );
+
+    proxy.ResetCounts();
+    TEST_ASSERT( ReadAndCompare( cache, proxy, Base + 0x10, 4 * PageSize - 0x20 ) );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+    TEST_ASSERT( proxy.BatchCount == 0 );
+}
+
+void MemoryCacheSuite::MatchDirectReads()
+{
+    FakeDebuggerProxy   proxy( Base, PageCount );
+    MemoryCache         cache;
+    uint32_t            seed = 12345;
+
+    for ( uint32_t i = 5; i < PageCount; i += 7 )
+        proxy.Unreadable[i] = true;
+
+    cache.Enable( true );
+
+    for ( int i = 0; i < 20000; i++ )
+    {
+        // a small LCG, so that a failure can be repeated
+        seed = seed * 1103515245 + 12345;
+        uint32_t    r = seed >> 8;
+        Address64   address = Base - PageSize + (r % ((PageCount + 2) * PageSize));
+        uint32_t    length = 1 + ((r >> 4) % (3 * PageSize));
+
+        switch ( r % 16 )
+        {
+        case 0:
+            {
+                uint8_t bytes[16];
+                for ( int j = 0; j < 16; j++ )
+                    bytes[j] = (uint8_t) (r + j);
+                WriteThroughProgram( cache, proxy, address, 16, bytes );
+            }
+            break;
+
+        case 1:
+            // a stop after running
+            cache.Enable( false );
+            proxy.Poke( Base + (r % (PageCount * PageSize)), (uint8_t) r );
+            cache.Enable( true );
+            break;
+
+        default:
+            TEST_ASSERT_RETURN_MSG( ReadAndCompare( cache, proxy, address, length ), 
+                "cached read doesn't match the memory" );
+            break;
+        }
+    }
+}
@@ -0,0 +1,24 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+class MemoryCacheSuite : public Test::Suite
+{
+public:
+    MemoryCacheSuite();
+
+private:
+    void ReadHits();
+    void ReadUnreadablePages();
+    void ReadWhileDisabled();
+    void InvalidateOnWrite();
+    void InvalidateOnContinue();
+    void PrefetchRanges();
+    void MatchDirectReads();
+};
@@ -0,0 +1,254 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "RemoteReadSuite.h"
+#include "FakeDebuggerProxy.h"
+#include "../../MagoNatDE/MemoryCache.h"
+
+using Mago::Address64;
+using Mago::MemoryCache;
+using Mago::MemoryReadRange;
+
+
+static const Address64  MemBase = 0x10000;
+static const uint32_t   PageCount = 64;
+static const uint32_t   PageSize = FakeDebuggerProxy::PageSize;
+
+
+// The agent's end of a remote debugger proxy, with memory like the client's. It
+// counts the calls it serves, and an agent older than batched reads turns them down.
+
+struct FakeAgent
+{
+    FakeDebuggerProxy   Memory;
+    bool                HasBatch;
+    uint32_t            ReadCalls;
+    uint32_t            BatchCalls;
+
+    FakeAgent( bool hasBatch )
+        :   Memory( MemBase, PageCount ),
+            HasBatch( hasBatch ),
+            ReadCalls( 0 ),
+            BatchCalls( 0 )
+    {
+    }
+};
+
+// A debugger proxy that sends reads to a FakeAgent in batches, the way 
+// RemoteDebuggerProxy sends them to MagoRemote. Its own memory is what the 
+// agent's should be, to check the results against.
+
+class AgentDebuggerProxy : public FakeDebuggerProxy
+{
+    FakeAgent&  mAgent;
+
+public:
+    uint32_t    MaxCount;
+    uint32_t    MaxLength;
+    bool        NoBatch;
+
+    AgentDebuggerProxy( FakeAgent& agent )
+        :   FakeDebuggerProxy( MemBase, PageCount ),
+            mAgent( agent ),
+            MaxCount( 256 ),
+            MaxLength( 0x100000 ),
+            NoBatch( false )
+    {
+    }
+
+    virtual HRESULT ReadMemory( 
+        Mago::ICoreProcess* process, 
+        Mago::Address64 address,
+        uint32_t length, 
+        uint32_t& lengthRead, 
+        uint32_t& lengthUnreadable, 
+        uint8_t* buffer )
+    {
+        ReadCount++;
+        mAgent.ReadCalls++;
+
+        return mAgent.Memory.ReadDirect( address, length, lengthRead, lengthUnreadable, buffer );
+    }
+
+    virtual HRESULT ReadMemoryBatch( 
+        Mago::ICoreProcess* process, 
+        uint32_t count, 
+        Mago::MemoryReadRange* ranges, 
+        uint8_t* buffer )
+    {
+        BatchCount++;
+        RangesRead += count;
+
+        return Mago::ReadMemoryInBatches( 
+            this, process, count, ranges, buffer, MaxCount, MaxLength, NoBatch, 
+            [this]( uint32_t batchCount, Mago::MemoryReadRange* batch, uint32_t length, uint8_t* batchBuf )
+        {
+            mAgent.BatchCalls++;
+
+            if ( !mAgent.HasBatch )
+                return (HRESULT) E_NOTIMPL;
+
+            return mAgent.Memory.ReadMemoryBatch( NULL, batchCount, batch, batchBuf );
+        } );
+    }
+};
+
+
+static void MakeRanges( std::vector<MemoryReadRange>& ranges, uint32_t count, uint32_t seed )
+{
+    ranges.resize( count );
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        ranges[i].Begin = MemBase - 0x100 + ((seed >> 8) % ((PageCount + 1) * PageSize));
+        ranges[i].Length = 1 + ((seed >> 4) % (2 * PageSize));
+    }
+}
+
+static uint32_t TotalLength( const std::vector<MemoryReadRange>& ranges )
+{
+    uint32_t    length = 0;
+
+    for ( size_t i = 0; i < ranges.size(); i++ )
+        length += ranges[i].Length;
+    return length;
+}
+
+// checks the results of a batch against reading each range directly
+static bool CheckRanges( FakeDebuggerProxy& proxy, std::vector<MemoryReadRange>& ranges, const uint8_t* buffer )
+{
+    for ( size_t i = 0; i < ranges.size(); i++ )
+    {
+        std::vector<uint8_t>    direct( ranges[i].Length );
+        uint32_t                lenRead = 0;
+        uint32_t                lenUnreadable = 0;
+
+        proxy.ReadDirect( ranges[i].Begin, ranges[i].Length, lenRead, lenUnreadable, &direct[0] );
+
+        if ( (ranges[i].Result != S_OK) 
+            || (ranges[i].LengthRead != lenRead) 
+            || (ranges[i].LengthUnreadable != lenUnreadable)
+            || (memcmp( buffer, &direct[0], lenRead ) != 0) )
+            return false;
+
+        buffer += ranges[i].Length;
+    }
+    return true;
+}
+
+
+RemoteReadSuite::RemoteReadSuite()
+{
+    TEST_ADD( RemoteReadSuite::ReadOneBatch );
+    TEST_ADD( RemoteReadSuite::SplitBatches );
+    TEST_ADD( RemoteReadSuite::ReadWithOldAgent );
+    TEST_ADD( RemoteReadSuite::PrefetchInOneBatch );
+}
+
+void RemoteReadSuite::ReadOneBatch()
+{
+    FakeAgent                   agent( true );
+    AgentDebuggerProxy          proxy( agent );
+    std::vector<MemoryReadRange> ranges;
+
+    agent.Memory.Unreadable[3] = true;
+    proxy.Unreadable[3] = true;
+
+    MakeRanges( ranges, 20, 1 );
+
+    std::vector<uint8_t>        buffer( TotalLength( ranges ) );
+
+    TEST_ASSERT_RETURN( proxy.ReadMemoryBatch( NULL, (uint32_t) ranges.size(), &ranges[0], &buffer[0] ) == S_OK );
+    TEST_ASSERT( CheckRanges( proxy, ranges, &buffer[0] ) );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+    TEST_ASSERT( agent.ReadCalls == 0 );
+    TEST_ASSERT( agent.BatchCalls == 1 );
+}
+
+void RemoteReadSuite::SplitBatches()
+{
+    FakeAgent                   agent( true );
+    AgentDebuggerProxy          proxy( agent );
+    std::vector<MemoryReadRange> ranges( 10 );
+
+    proxy.MaxCount = 4;
+    proxy.MaxLength = 3 * PageSize;
+
+    for ( uint32_t i = 0; i < ranges.size(); i++ )
+    {
+        ranges[i].Begin = MemBase + i * 4 * PageSize;
+        ranges[i].Length = PageSize;
+    }
+    // too big for any batch, read on its own
+    ranges[5].Length = 4 * PageSize;
+
+    std::vector<uint8_t>        buffer( TotalLength( ranges ) );
+
+    TEST_ASSERT_RETURN( proxy.ReadMemoryBatch( NULL, (uint32_t) ranges.size(), &ranges[0], &buffer[0] ) == S_OK );
+    TEST_ASSERT( CheckRanges( proxy, ranges, &buffer[0] ) );
+
+    // [0 1 2] by length, [3 4], 5 alone, [6 7 8], [9]
+    TEST_ASSERT( agent.BatchCalls == 4 );
+    TEST_ASSERT( proxy.ReadCount == 1 );
+    TEST_ASSERT( agent.ReadCalls == 1 );
+}
+
+void RemoteReadSuite::ReadWithOldAgent()
+{
+    FakeAgent                   agent( false );
+    AgentDebuggerProxy          proxy( agent );
+    std::vector<MemoryReadRange> ranges;
+
+    MakeRanges( ranges, 8, 2 );
+
+    std::vector<uint8_t>        buffer( TotalLength( ranges ) );
+
+    TEST_ASSERT_RETURN( proxy.ReadMemoryBatch( NULL, (uint32_t) ranges.size(), &ranges[0], &buffer[0] ) == S_OK );
+    TEST_ASSERT( CheckRanges( proxy, ranges, &buffer[0] ) );
+    TEST_ASSERT( proxy.NoBatch );
+    TEST_ASSERT( agent.BatchCalls == 1 );
+    TEST_ASSERT( proxy.ReadCount == 8 );
+    TEST_ASSERT( agent.ReadCalls == 8 );
+
+    // the agent isn't asked again
+    MakeRanges( ranges, 8, 3 );
+    buffer.resize( TotalLength( ranges ) );
+
+    TEST_ASSERT_RETURN( proxy.ReadMemoryBatch( NULL, (uint32_t) ranges.size(), &ranges[0], &buffer[0] ) == S_OK );
+    TEST_ASSERT( CheckRanges( proxy, ranges, &buffer[0] ) );
+    TEST_ASSERT( agent.BatchCalls == 1 );
+    TEST_ASSERT( proxy.ReadCount == 16 );
+    TEST_ASSERT( agent.ReadCalls == 16 );
+}
+
+void RemoteReadSuite::PrefetchInOneBatch()
+{
+    FakeAgent                   agent( true );
+    AgentDebuggerProxy          proxy( agent );
+    MemoryCache                 cache;
+    uint8_t                     value = 0;
+    uint32_t                    lenRead = 0;
+    uint32_t                    lenUnreadable = 0;
+
+    // like the stack pages read when the frames of a thread are listed
+    cache.Enable( true );
+    cache.Prefetch( &proxy, NULL, MemBase + 0x10, 4 * PageSize );
+    TEST_ASSERT( agent.BatchCalls == 1 );
+
+    // the reads of one evaluation after that don't go to the agent
+    for ( uint32_t offset = 0; offset < 4 * PageSize; offset += 0x100 )
+    {
+        TEST_ASSERT_RETURN( cache.ReadMemory( &proxy, NULL, MemBase + 0x10 + offset, 1, lenRead, lenUnreadable, &value ) == S_OK );
+        TEST_ASSERT( lenRead == 1 );
+        TEST_ASSERT( value == proxy.Memory[0x10 + offset] );
+    }
+    TEST_ASSERT( agent.BatchCalls == 1 );
+    TEST_ASSERT( proxy.ReadCount == 0 );
+    TEST_ASSERT( agent.ReadCalls == 0 );
+}
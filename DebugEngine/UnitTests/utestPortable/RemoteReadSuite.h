@@ -0,0 +1,21 @@
+/*
+   Copyright (c) 2013 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+class RemoteReadSuite : public Test::Suite
+{
+public:
+    RemoteReadSuite();
+
+private:
+    void ReadOneBatch();
+    void SplitBatches();
+    void ReadWithOldAgent();
+    void PrefetchInOneBatch();
+};
@@ -0,0 +1,180 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "stdafx.h"
+#include "SymbolCacheSuite.h"
+#include "../../../CVSym/CVSTI/SymbolCache.h"
+
+using MagoST::SymbolCache;
+using MagoST::SymbolCacheData;
+
+
+// A cache file as written by a session, with the identity "ID" and:
+//   Globals     "a", "bc"
+//   DebugFuncs  none
+//   FuncShorts  "x.y" -> "y"
+//   UDTShorts   none
+static const uint8_t    CapturedFile[] = 
+{
+    0x4D, 0x47, 0x53, 0x43,     // magic
+    0x01, 0x00, 0x00, 0x00,     // version
+    0x02, 0x00, 0x00, 0x00,  'I',  'D',
+    0x02, 0x00, 0x00, 0x00,     // Globals
+    0x01, 0x00, 0x00, 0x00,  'a', 
+    0x02, 0x00, 0x00, 0x00,  'b',  'c',
+    0x00, 0x00, 0x00, 0x00,     // DebugFuncs
+    0x01, 0x00, 0x00, 0x00,     // FuncShorts
+    0x03, 0x00, 0x00, 0x00,  'x',  '.',  'y',
+    0x01, 0x00, 0x00, 0x00,  'y',
+    0x00, 0x00, 0x00, 0x00,     // UDTShorts
+};
+
+static const char   CapturedIdentity[] = "ID";
+
+
+static void MakeData( SymbolCacheData& data )
+{
+    data.Globals.push_back( "main" );
+    data.Globals.push_back( "" );
+    data.Globals.push_back( std::string( "\0\xFF", 2 ) );
+    data.DebugFuncs.push_back( "__debugOverview" );
+    data.FuncShorts.push_back( SymbolCacheData::NamePair( "std.stdio.writeln", "writeln" ) );
+    data.UDTShorts.push_back( SymbolCacheData::NamePair( "app.Point", "Point" ) );
+    data.UDTShorts.push_back( SymbolCacheData::NamePair( "app.Rect", "Rect" ) );
+}
+
+static bool operator==( const SymbolCacheData& left, const SymbolCacheData& right )
+{
+    return (left.Globals == right.Globals)
+        && (left.DebugFuncs == right.DebugFuncs)
+        && (left.FuncShorts == right.FuncShorts)
+        && (left.UDTShorts == right.UDTShorts);
+}
+
+
+SymbolCacheSuite::SymbolCacheSuite()
+{
+    TEST_ADD( SymbolCacheSuite::RoundTrip );
+    TEST_ADD( SymbolCacheSuite::ReadCapturedFile );
+    TEST_ADD( SymbolCacheSuite::RejectOtherIdentity );
+    TEST_ADD( SymbolCacheSuite::RejectOtherVersion );
+    TEST_ADD( SymbolCacheSuite::RejectTruncated );
+    TEST_ADD( SymbolCacheSuite::RejectTrailingBytes );
+    TEST_ADD( SymbolCacheSuite::RejectHugeCount );
+}
+
+void SymbolCacheSuite::RoundTrip()
+{
+    SymbolCacheData         data;
+    SymbolCacheData         readData;
+    std::vector<uint8_t>    bytes;
+    const std::string       identity( "RSDS\x01\x02\0\x03", 8 );
+
+    MakeData( data );
+    SymbolCache::Write( identity, data, bytes );
+
+    TEST_ASSERT_RETURN( SymbolCache::Read( &bytes[0], bytes.size(), identity, readData ) );
+    TEST_ASSERT( readData == data );
+
+    // nothing at all
+    SymbolCacheData         emptyData;
+
+    SymbolCache::Write( identity, emptyData, bytes );
+    TEST_ASSERT_RETURN( SymbolCache::Read( &bytes[0], bytes.size(), identity, readData ) );
+    TEST_ASSERT( readData == emptyData );
+}
+
+void SymbolCacheSuite::ReadCapturedFile()
+{
+    SymbolCacheData         data;
+    std::vector<uint8_t>    bytes;
+
+    TEST_ASSERT_RETURN( SymbolCache::Read( CapturedFile, sizeof CapturedFile, CapturedIdentity, data ) );
+
+    TEST_ASSERT_RETURN( data.Globals.size() == 2 );
+    TEST_ASSERT( data.Globals[0] == "a" );
+    TEST_ASSERT( data.Globals[1] == "bc" );
+    TEST_ASSERT( data.DebugFuncs.empty() );
+    TEST_ASSERT_RETURN( data.FuncShorts.size() == 1 );
+    TEST_ASSERT( data.FuncShorts[0].first == "x.y" );
+    TEST_ASSERT( data.FuncShorts[0].second == "y" );
+    TEST_ASSERT( data.UDTShorts.empty() );
+
+    // the format doesn't change without a new version
+    SymbolCache::Write( CapturedIdentity, data, bytes );
+    TEST_ASSERT_RETURN( bytes.size() == sizeof CapturedFile );
+    TEST_ASSERT( memcmp( &bytes[0], CapturedFile, sizeof CapturedFile ) == 0 );
+}
+
+void SymbolCacheSuite::RejectOtherIdentity()
+{
+    SymbolCacheData data;
+
+    TEST_ASSERT( !SymbolCache::Read( CapturedFile, sizeof CapturedFile, "IE", data ) );
+    TEST_ASSERT( !SymbolCache::Read( CapturedFile, sizeof CapturedFile, "I", data ) );
+    TEST_ASSERT( !SymbolCache::Read( CapturedFile, sizeof CapturedFile, "", data ) );
+}
+
+void SymbolCacheSuite::RejectOtherVersion()
+{
+    SymbolCacheData         data;
+    std::vector<uint8_t>    bytes( CapturedFile, CapturedFile + sizeof CapturedFile );
+
+    bytes[4] = (uint8_t) (SymbolCache::Version + 1);
+    TEST_ASSERT( !SymbolCache::Read( &bytes[0], bytes.size(), CapturedIdentity, data ) );
+
+    bytes.assign( CapturedFile, CapturedFile + sizeof CapturedFile );
+    bytes[0] = 0;
+    TEST_ASSERT( !SymbolCache::Read( &bytes[0], bytes.size(), CapturedIdentity, data ) );
+}
+
+void SymbolCacheSuite::RejectTruncated()
+{
+    SymbolCacheData         data;
+    std::vector<uint8_t>    bytes;
+
+    MakeData( data );
+    SymbolCache::Write( CapturedIdentity, data, bytes );
+
+    // a file cut off anywhere, like by a full disk, is never taken
+    for ( size_t size = 0; size < bytes.size(); size++ )
+    {
+        // copy, so that a read past the end is caught by the debug heap
+        std::unique_ptr<uint8_t[]>  truncated( new uint8_t[size + 1] );
+        SymbolCacheData             readData;
+
+        memcpy( truncated.get(), &bytes[0], size );
+
+        TEST_ASSERT_RETURN_MSG( 
+            !SymbolCache::Read( truncated.get(), size, CapturedIdentity, readData ),
+            "truncated cache file was read" );
+    }
+}
+
+void SymbolCacheSuite::RejectTrailingBytes()
+{
+    SymbolCacheData         data;
+    std::vector<uint8_t>    bytes( CapturedFile, CapturedFile + sizeof CapturedFile );
+
+    bytes.push_back( 0 );
+    TEST_ASSERT( !SymbolCache::Read( &bytes[0], bytes.size(), CapturedIdentity, data ) );
+}
+
+void SymbolCacheSuite::RejectHugeCount()
+{
+    SymbolCacheData         data;
+    std::vector<uint8_t>    bytes( CapturedFile, CapturedFile + sizeof CapturedFile );
+    const size_t            GlobalsCountOffset = 14;
+
+    // must fail without reserving room for all of them
+    bytes[GlobalsCountOffset + 0] = 0xFF;
+    bytes[GlobalsCountOffset + 1] = 0xFF;
+    bytes[GlobalsCountOffset + 2] = 0xFF;
+    bytes[GlobalsCountOffset + 3] = 0xFF;
+
+    TEST_ASSERT( !SymbolCache::Read( &bytes[0], bytes.size(), CapturedIdentity, data ) );
+}
@@ -0,0 +1,24 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+class SymbolCacheSuite : public Test::Suite
+{
+public:
+    SymbolCacheSuite();
+
+private:
+    void RoundTrip();
+    void ReadCapturedFile();
+    void RejectOtherIdentity();
+    void RejectOtherVersion();
+    void RejectTruncated();
+    void RejectTrailingBytes();
+    void RejectHugeCount();
+};
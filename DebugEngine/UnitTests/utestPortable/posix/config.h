@@ -0,0 +1,10 @@
+// config.h : what cpptest's configure script would find on a POSIX system
+
+#ifndef TEST_CONFIG_H
+#define TEST_CONFIG_H
+
+#define HAVE_GETTIMEOFDAY
+#define HAVE_SYS_TIME_H
+#define HAVE_ROUND
+
+#endif // #ifndef TEST_CONFIG_H
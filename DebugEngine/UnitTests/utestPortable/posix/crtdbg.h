@@ -0,0 +1,16 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// crtdbg.h : the debug CRT macros that the tested code uses,
+// for building the tests outside of Windows
+
+#pragma once
+
+#include <assert.h>
+
+
+#define _ASSERT( expr )     assert( expr )
@@ -0,0 +1,60 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// windows.h : the few Windows declarations that the tested code uses,
+// for building the tests outside of Windows
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+
+
+typedef int32_t         HRESULT;
+typedef uint32_t        DWORD;
+typedef uint16_t        WORD;
+typedef uint8_t         BYTE;
+
+#define S_OK            ((HRESULT) 0)
+#define S_FALSE         ((HRESULT) 1)
+#define E_FAIL          ((HRESULT) 0x80004005)
+#define E_INVALIDARG    ((HRESULT) 0x80070057)
+#define E_OUTOFMEMORY   ((HRESULT) 0x8007000E)
+#define E_NOTIMPL       ((HRESULT) 0x80004001)
+
+#define SUCCEEDED( hr ) (((HRESULT) (hr)) >= 0)
+#define FAILED( hr )    (((HRESULT) (hr)) < 0)
+
+#define _countof( a )   (sizeof (a) / sizeof (a)[0])
+
+
+// like the Windows one, it can be entered again by the thread that holds it
+typedef pthread_mutex_t CRITICAL_SECTION;
+
+inline void InitializeCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( critSec, &attr );
+    pthread_mutexattr_destroy( &attr );
+}
+
+inline void DeleteCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutex_destroy( critSec );
+}
+
+inline void EnterCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutex_lock( critSec );
+}
+
+inline void LeaveCriticalSection( CRITICAL_SECTION* critSec )
+{
+    pthread_mutex_unlock( critSec );
+}
@@ -0,0 +1,62 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// stdafx.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+// The code tested here doesn't need Windows. Outside of Windows, the few
+// Windows declarations that it uses come from the posix directory.
+
+#pragma once
+
+#ifdef _WIN32
+#define _CRTDBG_MAP_ALLOC
+
+#include "targetver.h"
+#endif
+
+// C
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <crtdbg.h>
+
+// C++
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Windows
+#include <windows.h>
+
+// Other
+#include <cpptest.h>
+#include <Guard.h>
+
+
+#define TEST_ASSERT_RETURN( expr )                                  \
+    {                                                               \
+        if (!(expr))                                                \
+        {                                                           \
+            assertment(::Test::Source(__FILE__, __LINE__, #expr));  \
+            return;                                                 \
+        }                                                           \
+    }
+
+#define TEST_ASSERT_RETURN_MSG( expr, msg )                         \
+    {                                                               \
+        if (!(expr))                                                \
+        {                                                           \
+            assertment(::Test::Source(__FILE__, __LINE__, msg));    \
+            return;                                                 \
+        }                                                           \
+    }
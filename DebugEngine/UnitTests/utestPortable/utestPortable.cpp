@@ -0,0 +1,166 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+// utestPortable.cpp : Defines the entry point for the console application.
+//
+// Tests the parts of the debugger that don't need a debuggee or Windows.
+
+#include "stdafx.h"
+#include "SymbolCacheSuite.h"
+#include "MemoryCacheSuite.h"
+#include "RemoteReadSuite.h"
+#include "InstBlockCacheSuite.h"
+#include "DecodeX86Suite.h"
+#include "DemangleBench.h"
+#include "AddrTableBench.h"
+#include "LineIndexBench.h"
+
+using namespace std;
+
+
+enum OutputType
+{
+    Out_None,
+    Out_Text,
+    Out_Compiler,
+    Out_Html,
+};
+
+struct Options
+{
+    OutputType                      OutType;
+    std::shared_ptr<Test::Output>   Out;
+    string                          Filename;
+    uint32_t                        BenchCount;
+};
+
+
+bool ParseCommandLine( int argc, char* argv[], Options& options )
+{
+    options.OutType = Out_None;
+    options.BenchCount = 0;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strcmp( argv[i], "-textOut" ) == 0 )
+        {
+            if ( (i + 1) >= argc )
+                return false;
+
+            Test::TextOutput::Mode  mode;
+
+            i++;
+            if ( strcmp( argv[i], "terse" ) == 0 )
+                mode = Test::TextOutput::Terse;
+            else if ( strcmp( argv[i], "verbose" ) == 0 )
+                mode = Test::TextOutput::Verbose;
+            else
+                return false;
+
+            options.OutType = Out_Text;
+            options.Out.reset( new Test::TextOutput( mode ) );
+        }
+        else if ( strcmp( argv[i], "-compilerOut" ) == 0 )
+        {
+            if ( (i + 1) >= argc )
+                return false;
+
+            Test::CompilerOutput::Format    format;
+
+            i++;
+            if ( strcmp( argv[i], "generic" ) == 0 )
+                format = Test::CompilerOutput::Generic;
+            else if ( strcmp( argv[i], "bcc" ) == 0 )
+                format = Test::CompilerOutput::BCC;
+            else if ( strcmp( argv[i], "gcc" ) == 0 )
+                format = Test::CompilerOutput::GCC;
+            else if ( strcmp( argv[i], "msvc" ) == 0 )
+                format = Test::CompilerOutput::MSVC;
+            else
+                return false;
+
+            options.OutType = Out_Compiler;
+            options.Out.reset( new Test::CompilerOutput( format ) );
+        }
+        else if ( strcmp( argv[i], "-htmlOut" ) == 0 )
+        {
+            options.OutType = Out_Html;
+            options.Out.reset( new Test::HtmlOutput() );
+        }
+        else if ( strcmp( argv[i], "-filename" ) == 0 )
+        {
+            if ( (i + 1) >= argc )
+                return false;
+
+            i++;
+            options.Filename = argv[i];
+        }
+        else if ( strcmp( argv[i], "-bench" ) == 0 )
+        {
+            if ( (i + 1) >= argc )
+                return false;
+
+            i++;
+            options.BenchCount = strtoul( argv[i], NULL, 10 );
+        }
+        else
+            return false;
+    }
+
+    if ( options.OutType == Out_None )
+    {
+        options.Out.reset( new Test::TextOutput( Test::TextOutput::Verbose ) );
+    }
+
+    _ASSERT( options.Out.get() != NULL );
+
+    return true;
+}
+
+void GenerateHtml( Options& options )
+{
+    if ( options.Filename.empty() )
+    {
+        ((Test::HtmlOutput*) options.Out.get())->generate( cout );
+    }
+    else
+    {
+        ofstream    file( options.Filename.c_str() );
+        ((Test::HtmlOutput*) options.Out.get())->generate( file );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    Options options;
+
+    if ( !ParseCommandLine( argc, argv, options ) )
+        return EXIT_FAILURE;
+
+    if ( options.BenchCount != 0 )
+    {
+        RunDemangleBench( options.BenchCount );
+        RunAddrTableBench( options.BenchCount );
+        RunLineIndexBench( options.BenchCount );
+        return 0;
+    }
+
+    Test::Suite         comboSuite;
+
+    comboSuite.add( auto_ptr<Test::Suite>( new SymbolCacheSuite() ) );
+    comboSuite.add( auto_ptr<Test::Suite>( new MemoryCacheSuite() ) );
+    comboSuite.add( auto_ptr<Test::Suite>( new RemoteReadSuite() ) );
+    comboSuite.add( auto_ptr<Test::Suite>( new InstBlockCacheSuite() ) );
+    comboSuite.add( auto_ptr<Test::Suite>( new DecodeX86Suite() ) );
+
+    bool    passed = comboSuite.run( *options.Out.get() );
+
+    if ( options.OutType == Out_Html )
+        GenerateHtml( options );
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,6 +14,7 @@
 #include "Expression.h"
 #include "PropTables.h"
 #include "EnumValues.h"
+#include "NodeArena.h"
 
 
 namespace MagoEE
@@ -120,8 +121,9 @@ namespace MagoEE
                 auto addr = result.ObjVal.Value.Delegate.FuncAddr;
                 auto ctxt = result.ObjVal.Value.Delegate.ContextAddr;
                 propResult.ObjVal._Type = func->GetReturnType();
+                // the strings of the expression have to outlive it, too
                 auto completeProp = !complete ? std::function<HRESULT(HRESULT, MagoEE::DataObject)>{} :
-                    [complete, expr = mExpr, binder, propResult](HRESULT hr, MagoEE::DataObject objval) mutable
+                    [complete, expr = mExpr, strTable = mStrTable, binder, propResult](HRESULT hr, MagoEE::DataObject objval) mutable
                     {
                         propResult.ObjVal = objval;
                         if ( SUCCEEDED( hr ) )
@@ -182,7 +184,7 @@ namespace MagoEE
 
     HRESULT MakeNameTable( NameTable*& nameTable )
     {
-        nameTable = new SimpleNameTable();
+        nameTable = new GenerationNameTable();
 
         if ( nameTable == NULL )
             return E_OUTOFMEMORY;
@@ -241,9 +243,12 @@ namespace MagoEE
         if ( (text == NULL) || (typeEnv == NULL) || (strTable == NULL) )
             return E_INVALIDARG;
 
-        Scanner scanner( text, wcslen( text ), strTable );
+        // the expression holds on to the generation that its strings are in
+        RefPtr<NameTable>   strGen = strTable->GetGeneration();
+        Scanner scanner( text, wcslen( text ), strGen );
         Parser  parser( &scanner, typeEnv );
         RefPtr<Expression>  e;
+        NodeArena::Scope    arena;
 
         try
         {
@@ -260,7 +265,7 @@ namespace MagoEE
             return E_MAGOEE_SYNTAX_ERROR;
         }
 
-        expr = new EEDParsedExpr( e, strTable, typeEnv );
+        expr = new EEDParsedExpr( e, strGen, typeEnv );
         if ( expr == NULL )
             return E_OUTOFMEMORY;
 
@@ -270,6 +275,44 @@ namespace MagoEE
     }
 
 
+    HRESULT EvaluateBatch( 
+        const EvalOptions& options, 
+        IValueBinder* binder, 
+        const std::vector<RefPtr<IEEDParsedExpr>>& exprs, 
+        std::vector<EvalResult>& results,
+        std::function<HRESULT(uint32_t, HRESULT, EvalResult)> complete )
+    {
+        if ( (binder == NULL) || (results.size() != exprs.size()) || !complete )
+            return E_INVALIDARG;
+
+        // the binder's caches and the debuggee aren't safe to use from many threads
+        for ( uint32_t i = 0; i < exprs.size(); i++ )
+        {
+            if ( exprs[i] == NULL )
+                continue;
+
+            EvalOptions itemOptions = options;
+            if ( results[i].fmtOptions.prop )
+                itemOptions.AllowPropertyExec = true;
+
+            // the completion can run after this returns, so it doesn't point into the stack
+            auto completed = std::make_shared<bool>( false );
+
+            HRESULT hr = exprs[i]->Evaluate( itemOptions, binder, results[i], 
+                [complete, completed, i]( HRESULT hr, EvalResult result )
+                {
+                    *completed = true;
+                    return complete( i, hr, result );
+                } );
+            // when evaluating fails before there's a value, the completion isn't called
+            if ( FAILED( hr ) && !*completed )
+                complete( i, hr, results[i] );
+        }
+
+        return S_OK;
+    }
+
+
     HRESULT EnumValueChildren( 
         IValueBinder* binder, 
         const wchar_t* parentExprText, 
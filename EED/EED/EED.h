@@ -123,6 +123,17 @@ namespace MagoEE
     HRESULT StripFormatSpecifier( std::wstring& text, FormatOptions& fmtopt );
     HRESULT AppendFormatSpecifier( std::wstring& text, const FormatOptions& fmtopt );
 
+    // Evaluates expressions bound with the same binder one after the other, so that
+    // what the binder looked up and read for one is there for the next. NULL items
+    // are skipped. An item that calls a function in the debuggee can complete after
+    // this returns. A format specifier asking for properties allows calling them.
+    HRESULT EvaluateBatch( 
+        const EvalOptions& options, 
+        IValueBinder* binder, 
+        const std::vector<RefPtr<IEEDParsedExpr>>& exprs, 
+        std::vector<EvalResult>& results,
+        std::function<HRESULT(uint32_t, HRESULT, EvalResult)> complete );
+
     HRESULT EnumValueChildren( 
         IValueBinder* binder, 
         const wchar_t* parentExprText,
@@ -363,7 +363,14 @@ namespace MagoEE
         }
         else
         {
-            HRESULT hr = mBinder->FillValue( result.ObjVal );
+            // read the elements up to the limit together, they're usually all shown
+            uint64_t endIndex = GetUnlimitedCount();
+            if ( gMaxArrayLength > 0 && endIndex > gMaxArrayLength )
+                endIndex = gMaxArrayLength;
+            if ( endIndex > index )
+                mElemReader.Prefetch( mBinder, result.ObjVal.Addr, result.ObjVal._Type, endIndex - index );
+
+            HRESULT hr = mElemReader.FillValue( mBinder, result.ObjVal );
             if ( FAILED( hr ) )
                 return hr;
         }
@@ -466,7 +473,11 @@ namespace MagoEE
     EEDEnumAArray::EEDEnumAArray( int aaVersion )
         :   mCountDone( 0 )
         ,   mAAVersion ( aaVersion )
+        ,   mChunkFirst( 0 )
+        ,   mChunkCount( 0 )
+        ,   mEntries( std::make_shared<EntryIndex>() )
     {
+        mEntries->Complete = false;
         mBB.nodes = UINT64_MAX;
         mBucketIndex = 0;
         mNextNode = NULL;
@@ -648,42 +659,95 @@ namespace MagoEE
     void EEDEnumAArray::Reset()
     {
         mCountDone = 0;
-        mBucketIndex = 0;
-        mNextNode = NULL;
+
+        // back to the first entry if it's known, without walking the buckets
+        if ( !mEntries->Positions.empty() )
+        {
+            mBucketIndex = mEntries->Positions[0].BucketIndex;
+            mNextNode = mEntries->Positions[0].Node;
+        }
+        else
+        {
+            mBucketIndex = 0;
+            mNextNode = NULL;
+        }
+    }
+
+    HRESULT EEDEnumAArray::ReadBucketChunk( uint64_t bucketIndex )
+    {
+        uint32_t ptrSize = mParentVal.ObjVal._Type->GetSize();
+        uint32_t bucketSize = ( mAAVersion == 1 ? 2 : 1 ) * ptrSize;
+        uint64_t count = mBB.b.length - bucketIndex;
+        uint32_t sizeRead = 0;
+
+        if ( count > MaxChunkSize / bucketSize )
+            count = MaxChunkSize / bucketSize;
+
+        mChunk.resize( (size_t) count * bucketSize );
+        mChunkFirst = bucketIndex;
+        mChunkCount = 0;
+
+        HRESULT hr = mBinder->ReadMemory( 
+            mBB.b.ptr + bucketIndex * bucketSize, (uint32_t) mChunk.size(), sizeRead, mChunk.data() );
+        if ( FAILED( hr ) )
+            return hr;
+
+        // only whole buckets count, an unreadable tail is read again on its own
+        mChunkCount = sizeRead / bucketSize;
+        if ( mChunkCount == 0 )
+            return E_MAGOEE_INVALID_ADDRESS;
+
+        return S_OK;
+    }
+
+    Address EEDEnumAArray::GetChunkAddress( uint64_t slot )
+    {
+        uint32_t ptrSize = mParentVal.ObjVal._Type->GetSize();
+
+        if ( ptrSize == 4 )
+            return ((uint32_t*) mChunk.data())[slot];
+
+        return ((uint64_t*) mChunk.data())[slot];
     }
 
     HRESULT EEDEnumAArray::FindCurrent()
     {
-        if ( mAAVersion == 1 )
-        {
-            uint32_t ptrSize = mParentVal.ObjVal._Type->GetSize();
-            uint64_t hashFilledMark = 1LL << (8 * ptrSize - 1);
+        uint32_t ptrSize = mParentVal.ObjVal._Type->GetSize();
+        uint64_t hashFilledMark = 1LL << (8 * ptrSize - 1);
 
-            while( mNextNode == NULL && mBucketIndex < mBB.b.length )
+        while( mNextNode == NULL && mBucketIndex < mBB.b.length )
+        {
+            if ( mBucketIndex < mChunkFirst || mBucketIndex - mChunkFirst >= mChunkCount )
             {
-                Address hash;
-                HRESULT hr = ReadAddress( mBB.b.ptr, 2 * mBucketIndex, hash );
+                HRESULT hr = ReadBucketChunk( mBucketIndex );
                 if ( FAILED( hr ) )
                     return hr;
+            }
 
-                if ( hash & hashFilledMark )
-                    return ReadAddress( mBB.b.ptr, 2 * mBucketIndex + 1, mNextNode );
+            uint64_t chunkEnd = mChunkFirst + mChunkCount;
 
-                mBucketIndex++;
-            }
-        }
-        else
-        {
-            while( mNextNode == NULL && mBucketIndex < mBB.b.length )
+            if ( mAAVersion == 1 )
             {
-                HRESULT hr = ReadAddress( mBB.b.ptr, mBucketIndex, mNextNode );
-                if ( FAILED( hr ) )
-                    return hr;
+                for ( ; mBucketIndex < chunkEnd; mBucketIndex++ )
+                {
+                    uint64_t slot = 2 * (mBucketIndex - mChunkFirst);
 
-                if( mNextNode != NULL )
-                    return S_OK;
+                    if ( GetChunkAddress( slot ) & hashFilledMark )
+                    {
+                        mNextNode = GetChunkAddress( slot + 1 );
+                        return S_OK;
+                    }
+                }
+            }
+            else
+            {
+                for ( ; mBucketIndex < chunkEnd; mBucketIndex++ )
+                {
+                    mNextNode = GetChunkAddress( mBucketIndex - mChunkFirst );
 
-                mBucketIndex++;
+                    if( mNextNode != NULL )
+                        return S_OK;
+                }
             }
         }
         return S_OK;
@@ -715,6 +779,76 @@ namespace MagoEE
         return FindCurrent();
     }
 
+    HRESULT EEDEnumAArray::FindEntries( uint64_t count )
+    {
+        std::vector<EntryPosition>& positions = mEntries->Positions;
+        HRESULT hr = S_OK;
+
+        // carry on from the last entry found
+        if ( positions.empty() )
+        {
+            mBucketIndex = 0;
+            mNextNode = NULL;
+            hr = FindCurrent();
+        }
+        else
+        {
+            mBucketIndex = positions.back().BucketIndex;
+            mNextNode = positions.back().Node;
+            hr = FindNext();
+        }
+
+        while ( SUCCEEDED( hr ) && (mNextNode != NULL) )
+        {
+            EntryPosition position = { mBucketIndex, mNextNode };
+            positions.push_back( position );
+
+            if ( positions.size() >= count )
+                return S_OK;
+
+            hr = FindNext();
+        }
+        if ( FAILED( hr ) )
+            return hr;
+
+        mEntries->Complete = true;
+        return S_OK;
+    }
+
+    HRESULT EEDEnumAArray::SeekEntry( uint64_t entry )
+    {
+        HRESULT hr = ReadBB();
+        if ( FAILED( hr ) )
+            return hr;
+
+        std::vector<EntryPosition>& positions = mEntries->Positions;
+
+        // past the last entry there's nothing left to find
+        if ( (entry >= positions.size()) && !mEntries->Complete && (entry < GetCount()) )
+        {
+            // find a few more than needed, the IDE asks for children a page at a time
+            uint64_t count = entry + ReadAheadCount;
+            if ( count > GetCount() )
+                count = GetCount();
+
+            hr = FindEntries( count > entry ? count : entry + 1 );
+            if ( FAILED( hr ) )
+                return hr;
+        }
+
+        if ( entry < positions.size() )
+        {
+            mBucketIndex = positions[(size_t) entry].BucketIndex;
+            mNextNode = positions[(size_t) entry].Node;
+        }
+        else
+        {
+            mBucketIndex = mBB.b.length;
+            mNextNode = NULL;
+        }
+        return S_OK;
+    }
+
     HRESULT EEDEnumAArray::Skip( uint32_t count )
     {
         if ( count > (GetCount() - mCountDone) )
@@ -725,18 +859,11 @@ namespace MagoEE
             return S_FALSE;
         }
 
-        HRESULT hr = FindCurrent();
+        HRESULT hr = SeekEntry( mCountDone + count );
         if ( FAILED( hr ) )
-            return hr;
+            return E_FAIL;
 
-        for( uint32_t i = 0; i < count; i++ )
-        {
-            hr = FindNext();
-            if ( FAILED( hr ) )
-                return E_FAIL;
-            
-            mCountDone++;
-        }
+        mCountDone += count;
 
         return S_OK;
     }
@@ -761,6 +888,7 @@ namespace MagoEE
         en->mCountDone = mCountDone;
         en->mBucketIndex = mBucketIndex;
         en->mNextNode = mNextNode;
+        en->mEntries = mEntries;
 
         copiedEnum = en.Detach();
         return S_OK;
@@ -776,7 +904,7 @@ namespace MagoEE
         if ( mCountDone >= GetCount() )
             return E_FAIL;
 
-        HRESULT hr = FindCurrent();
+        HRESULT hr = SeekEntry( mCountDone );
         if ( FAILED( hr ) )
             return hr;
 
@@ -837,7 +965,7 @@ namespace MagoEE
         FillTraits( result, name, fullName, complete );
         mCountDone++;
 
-        return FindNext();
+        return SeekEntry( mCountDone );
     }
 
     //------------------------------------------------------------------------
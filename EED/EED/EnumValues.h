@@ -75,6 +75,7 @@ namespace MagoEE
     {
         uint32_t        mCountDone;
         uint32_t        mBaseOffset;
+        ArrayElementReader mElemReader;
 
         uint64_t GetUnlimitedCount();
 
@@ -138,10 +139,35 @@ namespace MagoEE
             BB64_V1         mBB_V1;
         };
 
+        // a window of the bucket array, so that empty buckets don't cost a read each
+        static const uint32_t MaxChunkSize = 0x10000;
+        std::vector<uint8_t> mChunk;
+        uint64_t        mChunkFirst;
+        uint64_t        mChunkCount;
+
+        // where the entries found so far are, shared with clones,
+        // so that Skip and Clone don't walk the buckets again
+        struct EntryPosition
+        {
+            uint64_t    BucketIndex;
+            Address     Node;
+        };
+        struct EntryIndex
+        {
+            std::vector<EntryPosition> Positions;
+            bool        Complete;
+        };
+        static const uint32_t ReadAheadCount = 64;
+        std::shared_ptr<EntryIndex> mEntries;
+
         HRESULT ReadBB();
         HRESULT ReadAddress( Address baseAddr, uint64_t index, Address& ptrValue );
+        HRESULT ReadBucketChunk( uint64_t bucketIndex );
+        Address GetChunkAddress( uint64_t slot );
         HRESULT FindCurrent();
         HRESULT FindNext();
+        HRESULT FindEntries( uint64_t count );
+        HRESULT SeekEntry( uint64_t entry );
         uint32_t AlignTSize( uint32_t size );
         uint64_t GetUnlimitedCount();
 
@@ -13,6 +13,7 @@
 #include "Property.h"
 #include "SharedString.h"
 #include "NameTable.h"
+#include "NodeArena.h"
 
 
 namespace MagoEE
@@ -28,11 +29,32 @@ namespace MagoEE
     }
 
 
+    void* Expression::operator new( size_t size )
+    {
+        return NodeArena::Alloc( size );
+    }
+
+    void Expression::operator delete( void* mem )
+    {
+        NodeArena::Free( mem );
+    }
+
+
     ObjectKind ExpressionList::GetObjectKind()
     {
         return ObjectKind_ExpressionList;
     }
 
+    void* ExpressionList::operator new( size_t size )
+    {
+        return NodeArena::Alloc( size );
+    }
+
+    void ExpressionList::operator delete( void* mem )
+    {
+        NodeArena::Free( mem );
+    }
+
     bool Expression::TrySetType( Type* type )
     {
         UNREFERENCED_PARAMETER( type );
@@ -65,6 +65,11 @@ namespace MagoEE
 
         Expression();
         virtual ObjectKind GetObjectKind();
+
+        // from the thread's NodeArena while parsing
+        static void* operator new( size_t size );
+        static void operator delete( void* mem );
+
         // TODO: abstract
         virtual HRESULT Semantic( const EvalData& evalData, ITypeEnv* typeEnv, IValueBinder* binder );
         virtual HRESULT Evaluate(EvalMode mode, const EvalData& evalData, IValueBinder* binder, DataObject& obj
@@ -103,6 +108,9 @@ namespace MagoEE
         std::list< RefPtr<Expression> > List;
 
         virtual ObjectKind GetObjectKind();
+
+        static void* operator new( size_t size );
+        static void operator delete( void* mem );
     };
 
 
@@ -530,13 +530,16 @@ namespace MagoEE
         closure->ubyteType.Ref() = ubyteType; // take ownership
         closure->elemStr.resize( length );
 
+        ArrayElementReader reader;
+        reader.Prefetch( binder, addr, elemType, length );
+
         for ( uint64_t i = 0; i < length; i++ )
         {
             DataObject elementObj = { 0 };
             elementObj._Type = elemType;
             elementObj.Addr = addr + elementSize * i;
 
-            HRESULT hr = binder->FillValue( elementObj );
+            HRESULT hr = reader.FillValue( binder, elementObj );
             if ( FAILED( hr ) )
             {
                 // always a read error or internal state error
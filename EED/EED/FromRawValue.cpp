@@ -259,4 +259,72 @@ HRESULT FromRawValue( const void* srcBuf, DataObject& data )
     return hr;
 }
 
+ArrayElementReader::ArrayElementReader()
+    :   mBufferAddr( 0 )
+{
+}
+
+void ArrayElementReader::Prefetch( IValueBinder* binder, Address addr, Type* elemType, uint64_t count )
+{
+    uint32_t    elemSize = elemType->GetSize();
+
+    if ( !HasRawValue( elemType ) || (count == 0) || Contains( addr, elemSize ) )
+        return;
+
+    if ( count > MaxReadSize / elemSize )
+        count = MaxReadSize / elemSize;
+
+    uint32_t    sizeToRead = (uint32_t) count * elemSize;
+    uint32_t    sizeRead = 0;
+
+    mBuffer.resize( sizeToRead );
+    mBufferAddr = addr;
+
+    HRESULT hr = binder->ReadMemory( addr, sizeToRead, sizeRead, mBuffer.data() );
+    if ( FAILED( hr ) )
+        sizeRead = 0;
+
+    // keep what was read, the elements after it will report the error themselves
+    mBuffer.resize( sizeRead );
+}
+
+HRESULT ArrayElementReader::FillValue( IValueBinder* binder, DataObject& elem )
+{
+    Type*   type = elem._Type;
+
+    if ( !HasRawValue( type ) || !Contains( elem.Addr, type->GetSize() ) )
+        return binder->FillValue( elem );
+
+    return FromRawValue( mBuffer.data() + (elem.Addr - mBufferAddr), elem );
+}
+
+void ArrayElementReader::Clear()
+{
+    mBuffer.clear();
+    mBufferAddr = 0;
+}
+
+bool ArrayElementReader::HasRawValue( Type* type )
+{
+    // the types that FillValue reads from memory
+    if ( type->IsSArray() )
+        return false;
+    if ( !type->IsScalar() 
+        && !type->IsDArray() 
+        && !type->IsAArray() 
+        && !type->IsDelegate()
+        && !type->AsTypeEnum() )
+        return false;
+
+    uint32_t    size = type->GetSize();
+    return (size > 0) && (size <= sizeof( DataValue ));
+}
+
+bool ArrayElementReader::Contains( Address addr, uint32_t size )
+{
+    return (addr >= mBufferAddr) 
+        && (addr - mBufferAddr <= mBuffer.size()) 
+        && (mBuffer.size() - (addr - mBufferAddr) >= size);
+}
+
 } // namespace MagoEE
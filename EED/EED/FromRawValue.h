@@ -13,6 +13,7 @@ namespace MagoEE
 {
 	class Type;
 	union DataValue;
+	class IValueBinder;
 
 	HRESULT WriteInt( uint8_t* buffer, uint32_t bufSize, Type* type, uint64_t val );
 	HRESULT WriteFloat( uint8_t* buffer, uint32_t bufSize, Type* type, const Real10& val );
@@ -21,4 +22,27 @@ namespace MagoEE
 	Real10 ReadFloat( const void* srcBuf, uint32_t bufOffset, Type* type );
 	HRESULT FromRawValue( const void* srcBuf, Type* type, DataValue& value );
 	HRESULT FromRawValue( const void* srcBuf, DataObject& data );
+
+	// Reads a run of array elements with one memory read, and fills their values
+	// from that copy like IValueBinder::FillValue does. Elements outside the copy,
+	// or ones the binder can't read as a block, go to the binder one at a time.
+	class ArrayElementReader
+	{
+		std::vector<uint8_t>	mBuffer;
+		Address					mBufferAddr;
+
+	public:
+		static const uint32_t	MaxReadSize = 0x10000;
+
+		ArrayElementReader();
+
+		// does nothing if the element at addr was already read
+		void Prefetch( IValueBinder* binder, Address addr, Type* elemType, uint64_t count );
+		HRESULT FillValue( IValueBinder* binder, DataObject& elem );
+		void Clear();
+
+	private:
+		static bool HasRawValue( Type* type );
+		bool Contains( Address addr, uint32_t size );
+	};
 }
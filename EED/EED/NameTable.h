@@ -23,5 +23,9 @@ namespace MagoEE
         virtual Utf32String* AddString( const dchar_t* str, size_t length ) = 0;
 
         virtual Utf16String* GetEmpty() = 0;
+
+        // Strings stay as long as the table they were added to. This is the table that
+        // they're going to now; hold on to it to keep them, when this one moves on.
+        virtual NameTable* GetGeneration() = 0;
     };
 }
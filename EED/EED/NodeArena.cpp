@@ -0,0 +1,114 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#include "Common.h"
+#include "NodeArena.h"
+
+
+namespace MagoEE
+{
+    static thread_local NodeArena*  gCurArena;
+
+
+    NodeArena::Scope::Scope()
+        :   mArena( new NodeArena() ),
+            mPrevArena( gCurArena )
+    {
+        gCurArena = mArena;
+    }
+
+    NodeArena::Scope::~Scope()
+    {
+        _ASSERT( gCurArena == mArena );
+        gCurArena = mPrevArena;
+        mArena->Release();
+    }
+
+
+    NodeArena::NodeArena()
+        :   mCur( NULL ),
+            mLeft( 0 ),
+            mRefCount( 1 )
+    {
+    }
+
+    NodeArena::~NodeArena()
+    {
+        for ( size_t i = 0; i < mBlocks.size(); i++ )
+            ::operator delete( mBlocks[i] );
+    }
+
+    void* NodeArena::Alloc( size_t size )
+    {
+        NodeArena*  arena = gCurArena;
+        uint8_t*    mem = NULL;
+
+        // each node starts with the arena it came from, so that it can be freed right
+        size = HeaderSize + ((size + HeaderSize - 1) & ~(HeaderSize - 1));
+
+        if ( arena == NULL )
+            mem = (uint8_t*) ::operator new( size );
+        else
+            mem = arena->Take( size );
+
+        *(NodeArena**) mem = arena;
+        return mem + HeaderSize;
+    }
+
+    void NodeArena::Free( void* mem )
+    {
+        if ( mem == NULL )
+            return;
+
+        uint8_t*    start = (uint8_t*) mem - HeaderSize;
+        NodeArena*  arena = *(NodeArena**) start;
+
+        if ( arena == NULL )
+            ::operator delete( start );
+        else
+            arena->Release();
+    }
+
+    uint8_t* NodeArena::Take( size_t size )
+    {
+        uint8_t*    mem = NULL;
+
+        if ( size > mLeft )
+        {
+            // big nodes get a block to themselves, so that they don't waste the rest of one
+            if ( size > BlockSize / 4 )
+            {
+                mBlocks.reserve( mBlocks.size() + 1 );
+                mem = (uint8_t*) ::operator new( size );
+                mBlocks.push_back( mem );
+                mRefCount++;
+                return mem;
+            }
+
+            mBlocks.reserve( mBlocks.size() + 1 );
+            mCur = (uint8_t*) ::operator new( BlockSize );
+            mLeft = BlockSize;
+            mBlocks.push_back( mCur );
+        }
+
+        mem = mCur;
+        mCur += size;
+        mLeft -= size;
+        mRefCount++;
+        return mem;
+    }
+
+    void NodeArena::Release()
+    {
+        mRefCount--;
+        _ASSERT( mRefCount >= 0 );
+        if ( mRefCount == 0 )
+        {
+            delete this;
+        }
+    }
+}
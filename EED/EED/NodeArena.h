@@ -0,0 +1,60 @@
+/*
+   Copyright (c) 2010 Aldo J. Nunez
+
+   Licensed under the Apache License, Version 2.0.
+   See the LICENSE text file for details.
+*/
+
+#pragma once
+
+
+namespace MagoEE
+{
+    // Memory for the nodes of one parsed expression. While an arena is open on a thread,
+    // expression nodes made on it are bumped out of large blocks, instead of each going
+    // to the heap. The nodes are still reference counted, because bound types and other
+    // results can keep them alive, but freeing one only counts it off. The blocks go
+    // away together after the arena is closed and its last node is freed.
+    // This class is not multithread safe, like the nodes themselves.
+
+    class NodeArena
+    {
+        static const size_t BlockSize = 4096;
+        static const size_t HeaderSize = 16;    // keeps nodes aligned like the heap does
+
+        std::vector<uint8_t*>   mBlocks;
+        uint8_t*        mCur;
+        size_t          mLeft;
+        long            mRefCount;              // live nodes, plus one while it's open
+
+    public:
+        // opens a new arena on this thread for as long as it's in scope
+        class Scope
+        {
+            NodeArena*  mArena;
+            NodeArena*  mPrevArena;
+
+        public:
+            Scope();
+            ~Scope();
+
+        private:
+            Scope( const Scope& );
+            Scope& operator=( const Scope& );
+        };
+
+        // for operator new and delete of the nodes;
+        // without an open arena, nodes go to the heap
+        static void*    Alloc( size_t size );
+        static void     Free( void* mem );
+
+    private:
+        NodeArena();
+        ~NodeArena();
+        NodeArena( const NodeArena& );
+        NodeArena& operator=( const NodeArena& );
+
+        uint8_t*        Take( size_t size );
+        void            Release();
+    };
+}
@@ -29,6 +29,13 @@ namespace MagoEE
             mNameTable( nameTable )
     {
         memset( &mTok, 0, sizeof mTok );
+
+        for ( int i = 0; i < StoredNodeCount; i++ )
+        {
+            mStoredNodes[i].Next = mFreeNodes;
+            mFreeNodes = &mStoredNodes[i];
+        }
+
         mCurNodes = NewNode();
     }
 
@@ -38,14 +45,14 @@ namespace MagoEE
         {
             TokenNode*  node = mCurNodes;
             mCurNodes = mCurNodes->Next;
-            delete node;
+            DeleteNode( node );
         }
 
         while ( mFreeNodes != NULL )
         {
             TokenNode*  node = mFreeNodes;
             mFreeNodes = mFreeNodes->Next;
-            delete node;
+            DeleteNode( node );
         }
     }
 
@@ -1809,4 +1816,10 @@ namespace MagoEE
         node->Next = NULL;
         return node;
     }
+
+    void Scanner::DeleteNode( TokenNode* node )
+    {
+        if ( (node < mStoredNodes) || (node >= mStoredNodes + StoredNodeCount) )
+            delete node;
+    }
 }
@@ -29,6 +29,7 @@ namespace MagoEE
         };
 
         static const int    TokenQueueMaxSize = 2;
+        static const int    StoredNodeCount = TokenQueueMaxSize + 2;
 
         enum NUMFLAGS
         {
@@ -46,6 +47,7 @@ namespace MagoEE
         TokenNode*      mCurNodes;
         TokenNode*      mFreeNodes;
         NameTable*      mNameTable;
+        TokenNode       mStoredNodes[StoredNodeCount];  // enough for most lookaheads
 
     public:
         Scanner( const wchar_t* inBuffer, size_t inBufferLen, NameTable* nameTable );
@@ -67,6 +69,7 @@ namespace MagoEE
         wchar_t PeekChar( int index );
         void NextChar();
         TokenNode*  NewNode();
+        void        DeleteNode( TokenNode* node );
         bool hasHexSuffix();
 
         void Scan();
@@ -11,8 +11,53 @@
 
 namespace MagoEE
 {
+    static size_t GetCharSize( StringKind kind )
+    {
+        switch ( kind )
+        {
+        case StringKind_Utf16:  return sizeof( wchar_t );
+        case StringKind_Utf32:  return sizeof( dchar_t );
+        default:                return sizeof( char );
+        }
+    }
+
+    // all the kinds of strings have their characters in the same place
+    static const uint8_t* GetChars( const String* str )
+    {
+        return (const uint8_t*) ((const ByteString*) str)->Str;
+    }
+
+
+    //------------------------------------------------------------------------
+    //  SimpleNameTable
+    //------------------------------------------------------------------------
+
+    size_t SimpleNameTable::StringHash::operator()( const String* str ) const
+    {
+        // FNV-1a
+        const uint8_t*  chars = GetChars( str );
+        size_t          size = str->Length * GetCharSize( str->Kind );
+        uint32_t        hash = 2166136261 ^ str->Kind;
+
+        for ( size_t i = 0; i < size; i++ )
+        {
+            hash ^= chars[i];
+            hash *= 16777619;
+        }
+
+        return hash;
+    }
+
+    bool SimpleNameTable::StringEqual::operator()( const String* str1, const String* str2 ) const
+    {
+        return (str1->Kind == str2->Kind)
+            && (str1->Length == str2->Length)
+            && (memcmp( GetChars( str1 ), GetChars( str2 ), str1->Length * GetCharSize( str1->Kind ) ) == 0);
+    }
+
     SimpleNameTable::SimpleNameTable()
-        :   mRefCount( 0 )
+        :   mRefCount( 0 ),
+            mSize( 0 )
     {
     }
 
@@ -33,87 +78,132 @@ namespace MagoEE
 
     SimpleNameTable::~SimpleNameTable()
     {
-        for ( ByteStringVector::iterator it = mByteStrs.begin();
-            it != mByteStrs.end();
+        for ( StringSet::iterator it = mStrs.begin();
+            it != mStrs.end();
             it++ )
         {
-            ByteString* s = *it;
+            String* s = *it;
             delete [] (char*) s;
         }
+    }
 
-        for ( Utf16StringVector::iterator it = mUtf16Strs.begin();
-            it != mUtf16Strs.end();
-            it++ )
-        {
-            Utf16String* s = *it;
-            delete [] (char*) s;
-        }
+    template <class S, class C>
+    S* SimpleNameTable::Intern( StringKind kind, const C* str, size_t length )
+    {
+        S   key;
 
-        for ( Utf32StringVector::iterator it = mUtf32Strs.begin();
-            it != mUtf32Strs.end();
-            it++ )
-        {
-            Utf32String* s = *it;
-            delete [] (char*) s;
-        }
+        key.Kind = kind;
+        key.Length = (uint32_t) length;
+        key.Str = (C*) str;
+
+        StringSet::iterator it = mStrs.find( &key );
+        if ( it != mStrs.end() )
+            return (S*) *it;
+
+        size_t  size = sizeof( S ) + (length + 1) * sizeof( C );
+        char*   buf = new char[ size ];
+        S*      newStr = (S*) buf;
+
+        newStr->Kind = kind;
+        newStr->Length = (uint32_t) length;
+        newStr->Str = (C*) (buf + sizeof( S ));
+
+        memcpy( newStr->Str, str, length * sizeof( C ) );
+        newStr->Str[length] = 0;
+
+        mStrs.insert( newStr );
+        mSize += size;
+        return newStr;
     }
 
     ByteString* SimpleNameTable::AddString( const char* str, size_t length )
     {
-        char*       buf = new char[ sizeof( ByteString ) + (length + 1) * sizeof( char ) ];
-        ByteString* byteStr = (ByteString*) buf;
+        return Intern<ByteString>( StringKind_Byte, str, length );
+    }
+
+    Utf16String* SimpleNameTable::AddString( const wchar_t* str, size_t length )
+    {
+        return Intern<Utf16String>( StringKind_Utf16, str, length );
+    }
+
+    Utf32String* SimpleNameTable::AddString( const dchar_t* str, size_t length )
+    {
+        return Intern<Utf32String>( StringKind_Utf32, str, length );
+    }
 
-        byteStr->Kind = StringKind_Byte;
-        byteStr->Length = (uint32_t) length;
-        byteStr->Str = buf + sizeof( ByteString );
+    Utf16String* SimpleNameTable::GetEmpty()
+    {
+        static Utf16String  s;
 
-        memcpy_s( byteStr->Str, length, str, length );
-        byteStr->Str[length] = '\0';
+        s.Kind = StringKind_Utf16;
+        s.Length = 0;
+        s.Str = L"";
 
-        mByteStrs.push_back( byteStr );
-        return byteStr;
+        return &s;
     }
 
-    Utf16String* SimpleNameTable::AddString( const wchar_t* str, size_t length )
+    NameTable* SimpleNameTable::GetGeneration()
     {
-        char*           buf = new char[ sizeof( Utf16String ) + (length + 1) * sizeof( wchar_t ) ];
-        Utf16String*    utf16Str = (Utf16String*) buf;
+        return this;
+    }
 
-        utf16Str->Kind = StringKind_Utf16;
-        utf16Str->Length = (uint32_t) length;
-        utf16Str->Str = (wchar_t*) (buf + sizeof( Utf16String ));
+    size_t SimpleNameTable::GetSize()
+    {
+        return mSize;
+    }
 
-        wmemcpy_s( utf16Str->Str, length, str, length );
-        utf16Str->Str[length] = L'\0';
 
-        mUtf16Strs.push_back( utf16Str );
-        return utf16Str;
+    //------------------------------------------------------------------------
+    //  GenerationNameTable
+    //------------------------------------------------------------------------
+
+    GenerationNameTable::GenerationNameTable()
+        :   mRefCount( 0 ),
+            mCurGen( new SimpleNameTable() )
+    {
     }
 
-    Utf32String* SimpleNameTable::AddString( const dchar_t* str, size_t length )
+    void GenerationNameTable::AddRef()
     {
-        char*           buf = new char[ sizeof( Utf32String ) + (length + 1) * sizeof( dchar_t ) ];
-        Utf32String*    utf32Str = (Utf32String*) buf;
+        mRefCount++;
+    }
 
-        utf32Str->Kind = StringKind_Utf32;
-        utf32Str->Length = (uint32_t) length;
-        utf32Str->Str = (dchar_t*) (buf + sizeof( Utf32String ));
+    void GenerationNameTable::Release()
+    {
+        mRefCount--;
+        _ASSERT( mRefCount >= 0 );
+        if ( mRefCount == 0 )
+        {
+            delete this;
+        }
+    }
 
-        memcpy_s( utf32Str->Str, length * 4, str, length * 4 );
-        utf32Str->Str[length] = 0;
+    ByteString* GenerationNameTable::AddString( const char* str, size_t length )
+    {
+        return mCurGen->AddString( str, length );
+    }
 
-        mUtf32Strs.push_back( utf32Str );
-        return utf32Str;
+    Utf16String* GenerationNameTable::AddString( const wchar_t* str, size_t length )
+    {
+        return mCurGen->AddString( str, length );
     }
 
-    Utf16String* SimpleNameTable::GetEmpty()
+    Utf32String* GenerationNameTable::AddString( const dchar_t* str, size_t length )
     {
-        static Utf16String  s;
+        return mCurGen->AddString( str, length );
+    }
 
-        s.Kind = StringKind_Utf16;
-        s.Length = 0;
-        s.Str = L"";
+    Utf16String* GenerationNameTable::GetEmpty()
+    {
+        return mCurGen->GetEmpty();
+    }
 
-        return &s;
+    NameTable* GenerationNameTable::GetGeneration()
+    {
+        // only moves on between parses, so that a parse uses one generation
+        if ( mCurGen->GetSize() >= MaxGenerationSize )
+            mCurGen = new SimpleNameTable();
+
+        return mCurGen;
     }
 }
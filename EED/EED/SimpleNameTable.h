@@ -8,20 +8,31 @@
 #pragma once
 
 #include "NameTable.h"
+#include <unordered_set>
 
 
 namespace MagoEE
 {
+    // One generation of strings. Adding a string that's already here returns the
+    // one that's here, so parsing the same text again doesn't take more memory.
+
     class SimpleNameTable : public NameTable
     {
-        typedef std::vector<ByteString*>    ByteStringVector;
-        typedef std::vector<Utf16String*>   Utf16StringVector;
-        typedef std::vector<Utf32String*>   Utf32StringVector;
+        struct StringHash
+        {
+            size_t operator()( const String* str ) const;
+        };
+
+        struct StringEqual
+        {
+            bool operator()( const String* str1, const String* str2 ) const;
+        };
+
+        typedef std::unordered_set<String*, StringHash, StringEqual>    StringSet;
 
         long                mRefCount;
-        ByteStringVector    mByteStrs;
-        Utf16StringVector   mUtf16Strs;
-        Utf32StringVector   mUtf32Strs;
+        StringSet           mStrs;
+        size_t              mSize;          // bytes taken by the strings
 
     public:
         SimpleNameTable();
@@ -35,5 +46,38 @@ namespace MagoEE
         virtual Utf32String* AddString( const dchar_t* str, size_t length );
 
         virtual Utf16String* GetEmpty();
+        virtual NameTable* GetGeneration();
+
+        size_t GetSize();
+
+    private:
+        template <class S, class C>
+        S* Intern( StringKind kind, const C* str, size_t length );
+    };
+
+
+    // Adds strings to a generation until it gets big, then starts a new one. Parsed
+    // expressions hold the generation they were parsed with, so an old generation
+    // is freed when the last expression parsed with it is.
+
+    class GenerationNameTable : public NameTable
+    {
+        static const size_t MaxGenerationSize = 64 * 1024;
+
+        long                    mRefCount;
+        RefPtr<SimpleNameTable> mCurGen;
+
+    public:
+        GenerationNameTable();
+
+        virtual void AddRef();
+        virtual void Release();
+
+        virtual ByteString* AddString( const char* str, size_t length );
+        virtual Utf16String* AddString( const wchar_t* str, size_t length );
+        virtual Utf32String* AddString( const dchar_t* str, size_t length );
+
+        virtual Utf16String* GetEmpty();
+        virtual NameTable* GetGeneration();
     };
 }
@@ -176,6 +176,23 @@ bool DataEnv::GetArrayLength( MagoEE::dlength_t& length )
     return false;
 }
 
+HRESULT DataEnv::ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+{
+    // like a process, only the allocated part is readable, and a read that runs past it is short
+    sizeRead = 0;
+
+    if ( address >= mAllocSize )
+        return S_OK;
+
+    if ( sizeToRead > mAllocSize - address )
+        sizeRead = (uint32_t) (mAllocSize - address);
+    else
+        sizeRead = sizeToRead;
+
+    memcpy( buffer, mBuf.Get() + address, sizeRead );
+    return S_OK;
+}
+
 uint64_t DataEnv::ReadInt( MagoEE::Address address, size_t size, bool isSigned )
 {
     return ReadInt( mBuf.Get(), address, size, isSigned );
@@ -405,7 +422,7 @@ HRESULT DataEnvBinder::SetValue( MagoEE::Address addr, MagoEE::Type* type, const
 
 HRESULT DataEnvBinder::ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
 {
-    return E_NOTIMPL;
+    return mDataEnv->ReadMemory( addr, sizeToRead, sizeRead, buffer );
 }
 
 HRESULT DataEnvBinder::SymbolFromAddr( MagoEE::Address addr, std::wstring& symName, MagoEE::Type** pType, DWORD* pOffset )
@@ -32,6 +32,7 @@ public:
     virtual RefPtr<MagoEE::Declaration> GetThis();
     virtual RefPtr<MagoEE::Declaration> GetSuper();
     virtual bool GetArrayLength( MagoEE::dlength_t& length );
+    virtual HRESULT ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer );
 
     static uint64_t ReadInt( uint8_t* srcBuf, MagoEE::Address addr, size_t size, bool isSigned );
     static Real10 ReadFloat( uint8_t* srcBuf, MagoEE::Address addr, MagoEE::Type* type );
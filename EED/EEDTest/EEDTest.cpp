@@ -23,6 +23,9 @@ using namespace std;
 using MagoEE::ITypeEnv;
 
 bool TestReal10();
+bool TestEvaluateBatch( ITypeEnv* typeEnv, IScope* scope, IValueEnv* valueEnv );
+bool TestEnumAArray( ITypeEnv* typeEnv, IScope* scope );
+bool TestArrayElementReader( ITypeEnv* typeEnv, IScope* scope );
 
 AppSettings gAppSettings = { 0 };
 
@@ -95,6 +98,7 @@ struct Options
     const wchar_t*  DataFile;
     const wchar_t*  ProgFile;
     uint32_t        Rva;
+    uint32_t        BenchCount;
     bool            PrintDText;
     bool            Verbose;
     bool            SelfTest;
@@ -137,6 +141,14 @@ struct Options
                 else
                     options.Rva = wcstoul( argv[i], NULL, 10 );
             }
+            else if ( _wcsicmp( argv[i], L"-bench" ) == 0 )
+            {
+                i++;
+                if ( i >= argc )
+                    return false;
+
+                options.BenchCount = wcstoul( argv[i], NULL, 10 );
+            }
             else if ( _wcsicmp( argv[i], L"-dtext" ) == 0 )
             {
                 options.PrintDText = true;
@@ -170,6 +182,188 @@ struct Options
 //#include <complex>
 
 
+// the kinds of expressions that are put in watch windows
+static const wchar_t*   gBenchExprs[] =
+{
+    L"x",
+    L"this",
+    L"a.b.c",
+    L"*p",
+    L"p.next.value",
+    L"arr[i]",
+    L"arr[i + 1].name",
+    L"arr[1..$]",
+    L"arr.length",
+    L"s.ptr[0 .. 4]",
+    L"(a + b) * c / 2",
+    L"x << 3 | y & 0xff",
+    L"cast(int) f",
+    L"cast(ubyte*) p + 16",
+    L"p !is null && p.x > 3",
+    L"i >= 0 ? arr[i] : -1",
+    L"aa[\"key\"]",
+    L"1.5e3 + 2.25",
+    L"'c'",
+    L"\"hello world\"",
+};
+
+// Parses and binds each expression above count times. Names that aren't in the
+// data file don't bind, but they're still counted, because they're still parsed.
+
+static void RunParseBench( ITypeEnv* typeEnv, IScope* scope, IValueEnv* valueEnv, uint32_t count )
+{
+    const int           ExprCount = _countof( gBenchExprs );
+    HRESULT             hr = S_OK;
+    RefPtr<MagoEE::NameTable>   nameTable;
+    DataEnvBinder       binder( valueEnv, scope );
+    MagoEE::EvalOptions options = MagoEE::EvalOptions::defaults;
+    LARGE_INTEGER       freq = { 0 };
+    LARGE_INTEGER       start = { 0 };
+    LARGE_INTEGER       end = { 0 };
+    uint32_t            parsed = 0;
+    uint32_t            bound = 0;
+
+    hr = MagoEE::MakeNameTable( nameTable.Ref() );
+    if ( FAILED( hr ) )
+        return;
+
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &start );
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        for ( int j = 0; j < ExprCount; j++ )
+        {
+            RefPtr<MagoEE::IEEDParsedExpr>  expr;
+
+            hr = MagoEE::ParseText( gBenchExprs[j], typeEnv, nameTable, expr.Ref() );
+            if ( FAILED( hr ) )
+                continue;
+
+            parsed++;
+
+            hr = expr->Bind( options, &binder );
+            if ( SUCCEEDED( hr ) )
+                bound++;
+        }
+    }
+
+    QueryPerformanceCounter( &end );
+
+    double  ms = (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+
+    printf( "Parsed %u expressions, bound %u, in %.1f ms: %.0f per second\n",
+        parsed, bound, ms, (ms > 0) ? parsed * 1000.0 / ms : 0.0 );
+}
+
+// Refreshes a watch window of WatchCount watches count times. First each watch 
+// is parsed, bound, and evaluated every time, then each one is bound only once 
+// and evaluated every time, the way the debug engine keeps bound expressions.
+
+static void RunWatchBench( ITypeEnv* typeEnv, IScope* scope, IValueEnv* valueEnv, uint32_t count )
+{
+    const int           ExprCount = _countof( gBenchExprs );
+    const uint32_t      WatchCount = 100;
+    HRESULT             hr = S_OK;
+    RefPtr<MagoEE::NameTable>   nameTable;
+    DataEnvBinder       binder( valueEnv, scope );
+    MagoEE::EvalOptions options = MagoEE::EvalOptions::defaults;
+    LARGE_INTEGER       freq = { 0 };
+    LARGE_INTEGER       start = { 0 };
+    LARGE_INTEGER       end = { 0 };
+    uint32_t            evaluated = 0;
+    double              ms = 0;
+    std::vector<std::wstring>   watches;
+    std::vector<RefPtr<MagoEE::IEEDParsedExpr>>  boundWatches;
+
+    hr = MagoEE::MakeNameTable( nameTable.Ref() );
+    if ( FAILED( hr ) )
+        return;
+
+    // the expressions above, in more and more parentheses, so that each text is different
+    for ( uint32_t i = 0; i < WatchCount; i++ )
+    {
+        size_t          depth = i / ExprCount;
+        std::wstring    text( depth, L'(' );
+
+        text.append( gBenchExprs[i % ExprCount] );
+        text.append( depth, L')' );
+        watches.push_back( text );
+    }
+
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &start );
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        for ( uint32_t j = 0; j < WatchCount; j++ )
+        {
+            RefPtr<MagoEE::IEEDParsedExpr>  expr;
+            MagoEE::EvalResult              result = { 0 };
+
+            hr = MagoEE::ParseText( watches[j].c_str(), typeEnv, nameTable, expr.Ref() );
+            if ( FAILED( hr ) )
+                continue;
+
+            hr = expr->Bind( options, &binder );
+            if ( FAILED( hr ) )
+                continue;
+
+            hr = expr->Evaluate( options, &binder, result, {} );
+            if ( SUCCEEDED( hr ) )
+                evaluated++;
+        }
+    }
+
+    QueryPerformanceCounter( &end );
+
+    ms = (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+
+    printf( "Parsed, bound, and evaluated %u watches %u times, %u values, in %.1f ms\n",
+        WatchCount, count, evaluated, ms );
+
+    boundWatches.resize( WatchCount );
+    evaluated = 0;
+
+    QueryPerformanceCounter( &start );
+
+    for ( uint32_t j = 0; j < WatchCount; j++ )
+    {
+        RefPtr<MagoEE::IEEDParsedExpr>  expr;
+
+        hr = MagoEE::ParseText( watches[j].c_str(), typeEnv, nameTable, expr.Ref() );
+        if ( FAILED( hr ) )
+            continue;
+
+        hr = expr->Bind( options, &binder );
+        if ( SUCCEEDED( hr ) )
+            boundWatches[j] = expr;
+    }
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        for ( uint32_t j = 0; j < WatchCount; j++ )
+        {
+            MagoEE::EvalResult  result = { 0 };
+
+            if ( boundWatches[j] == NULL )
+                continue;
+
+            hr = boundWatches[j]->Evaluate( options, &binder, result, {} );
+            if ( SUCCEEDED( hr ) )
+                evaluated++;
+        }
+    }
+
+    QueryPerformanceCounter( &end );
+
+    ms = (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart;
+
+    printf( "Bound %u watches once, and evaluated them %u times, %u values, in %.1f ms\n",
+        WatchCount, count, evaluated, ms );
+}
+
+
 int _tmain(int argc, _TCHAR* argv[])
 {
     Static::x = 3;
@@ -288,6 +482,17 @@ int _tmain(int argc, _TCHAR* argv[])
         }
 
 
+        TestEvaluateBatch( typeEnv, scope, valueEnv );
+        TestEnumAArray( typeEnv, scope );
+        TestArrayElementReader( typeEnv, scope );
+
+        if ( options.BenchCount != 0 )
+        {
+            RunParseBench( typeEnv, scope, valueEnv, options.BenchCount );
+            RunWatchBench( typeEnv, scope, valueEnv, options.BenchCount );
+            return 0;
+        }
+
         // changing the content handler for the reader (we're keeping the reader)
         // deletes the root element, so make sure we keep the root element here in a RefPtr
         // so it stays alive between the two content handlers
@@ -0,0 +1,279 @@
+#include "Common.h"
+#include "DataEnv.h"
+
+#include <assert.h>
+
+
+// fills values the way the debug engine's binder does, with a memory read for
+// each one, so that they can be compared with the ones ArrayElementReader fills
+class RawMemoryBinder : public DataEnvBinder
+{
+public:
+    uint32_t    MaxReadSize;    // longer reads are short, 0 for no limit
+    uint32_t    ReadCount;
+
+    RawMemoryBinder( IValueEnv* env, IScope* scope )
+        :   DataEnvBinder( env, scope ),
+            MaxReadSize( 0 ),
+            ReadCount( 0 )
+    {
+    }
+
+    virtual HRESULT FillValue( MagoEE::DataObject& data )
+    {
+        HRESULT     hr = S_OK;
+        uint8_t     targetBuf[ sizeof( MagoEE::DataValue ) ] = { 0 };
+        uint32_t    targetSize = data._Type->GetSize();
+        uint32_t    sizeRead = 0;
+
+        hr = ReadMemory( data.Addr, targetSize, sizeRead, targetBuf );
+        if ( FAILED( hr ) )
+            return hr;
+        if ( sizeRead < targetSize )
+            return HRESULT_FROM_WIN32( ERROR_PARTIAL_COPY );
+
+        return MagoEE::FromRawValue( targetBuf, data );
+    }
+
+    virtual HRESULT ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+    {
+        ReadCount++;
+
+        if ( (MaxReadSize != 0) && (sizeToRead > MaxReadSize) )
+            sizeToRead = MaxReadSize;
+
+        return DataEnvBinder::ReadMemory( addr, sizeToRead, sizeRead, buffer );
+    }
+};
+
+
+// an enum type only needs its size and backing type from its declaration
+class EnumDecl : public DeclDataElement
+{
+    MagoEE::ENUMTY  mBackingTy;
+    uint32_t        mSize;
+
+public:
+    EnumDecl( MagoEE::Type* backingType )
+        :   mBackingTy( backingType->GetBackingTy() ),
+            mSize( backingType->GetSize() )
+    {
+    }
+
+    virtual bool GetSize( uint32_t& size )
+    {
+        size = mSize;
+        return true;
+    }
+
+    virtual bool GetBackingTy( MagoEE::ENUMTY& ty )
+    {
+        ty = mBackingTy;
+        return true;
+    }
+
+    virtual bool IsType()
+    {
+        return true;
+    }
+
+    virtual void AddChild( Element* elem ) { }
+    virtual void SetAttribute( const wchar_t* name, const wchar_t* value ) { }
+    virtual void SetAttribute( const wchar_t* name, Element* elemValue ) { }
+    virtual void PrintElement() { }
+};
+
+
+// deterministic bytes, so that every field of every element has a different value
+static MagoEE::Address AllocateArray( DataEnv& env, uint32_t size )
+{
+    MagoEE::Address addr = env.Allocate( size );
+    uint32_t        seed = addr;
+
+    for ( uint32_t i = 0; i < size; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        env.GetBuffer()[addr + i] = (uint8_t) (seed >> 16);
+    }
+
+    return addr;
+}
+
+// fills the elements through a reader the way the array enumerators do, and
+// compares each with what the binder fills for it on its own
+static void CheckElements(
+    RawMemoryBinder& binder,
+    MagoEE::Type* type,
+    MagoEE::Address addr,
+    uint32_t count,
+    uint32_t bitPos,
+    uint32_t bitLen )
+{
+    MagoEE::ArrayElementReader  reader;
+    uint32_t    size = type->GetSize();
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        MagoEE::DataObject  elem = { 0 };
+        MagoEE::DataObject  expected = { 0 };
+        HRESULT     hr = S_OK;
+        HRESULT     expectedHR = S_OK;
+
+        elem._Type = type;
+        elem.Addr = addr + i * size;
+        elem.BitPos = bitPos;
+        elem.BitLen = bitLen;
+        expected = elem;
+
+        reader.Prefetch( &binder, elem.Addr, type, count - i );
+        hr = reader.FillValue( &binder, elem );
+
+        expectedHR = binder.FillValue( expected );
+
+        assert( hr == expectedHR );
+        if ( SUCCEEDED( hr ) )
+            assert( memcmp( &elem.Value, &expected.Value, sizeof elem.Value ) == 0 );
+    }
+}
+
+// counts the reads it takes to fill the elements through a reader
+static uint32_t CountReaderReads(
+    RawMemoryBinder& binder,
+    MagoEE::Type* type,
+    MagoEE::Address addr,
+    uint32_t count )
+{
+    MagoEE::ArrayElementReader  reader;
+    uint32_t    size = type->GetSize();
+    uint32_t    readCount = binder.ReadCount;
+
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        MagoEE::DataObject  elem = { 0 };
+
+        elem._Type = type;
+        elem.Addr = addr + i * size;
+
+        reader.Prefetch( &binder, elem.Addr, type, count - i );
+        reader.FillValue( &binder, elem );
+    }
+
+    return binder.ReadCount - readCount;
+}
+
+bool TestArrayElementReader( MagoEE::ITypeEnv* typeEnv, IScope* scope )
+{
+    HRESULT hr = S_OK;
+    RefPtr<MagoEE::Type>    enum16Type = new MagoEE::TypeEnum( new EnumDecl( typeEnv->GetType( MagoEE::Tint16 ) ) );
+    RefPtr<MagoEE::Type>    enum8Type = new MagoEE::TypeEnum( new EnumDecl( typeEnv->GetType( MagoEE::Tuns8 ) ) );
+    RefPtr<MagoEE::Type>    darrayType;
+    RefPtr<MagoEE::Type>    funcType;
+    RefPtr<MagoEE::Type>    delegateType;
+    RefPtr<MagoEE::ParameterList>   params;
+    MagoEE::Type*   intType = typeEnv->GetType( MagoEE::Tint32 );
+    MagoEE::Type*   uintType = typeEnv->GetType( MagoEE::Tuns32 );
+    MagoEE::Type*   byteType = typeEnv->GetType( MagoEE::Tint8 );
+    MagoEE::Type*   longType = typeEnv->GetType( MagoEE::Tint64 );
+
+    hr = typeEnv->NewDArray( intType, darrayType.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    hr = typeEnv->NewParams( params.Ref() );
+    assert( SUCCEEDED( hr ) );
+    hr = typeEnv->NewFunction( typeEnv->GetType( MagoEE::Tvoid ), NULL, params, 0, 0, funcType.Ref() );
+    assert( SUCCEEDED( hr ) );
+    hr = typeEnv->NewDelegate( funcType, delegateType.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    // a whole array in one read, for each kind of value the reader copies
+    {
+        MagoEE::Type*   types[] =
+        {
+            intType, byteType, longType, typeEnv->GetVoidPointerType(),
+            enum16Type, enum8Type, darrayType, delegateType,
+        };
+
+        for ( MagoEE::Type* type : types )
+        {
+            DataEnv         env( 0x1000 );
+            RawMemoryBinder binder( &env, scope );
+            MagoEE::Address addr = AllocateArray( env, 40 * type->GetSize() );
+
+            CheckElements( binder, type, addr, 40, 0, 0 );
+            assert( CountReaderReads( binder, type, addr, 40 ) == 1 );
+        }
+    }
+
+    // bitfields are cut out of the copy like they are out of a value read alone
+    {
+        DataEnv         env( 0x1000 );
+        RawMemoryBinder binder( &env, scope );
+        MagoEE::Address addr = AllocateArray( env, 40 * sizeof( uint32_t ) );
+
+        CheckElements( binder, uintType, addr, 40, 3, 5 );
+        CheckElements( binder, intType, addr, 40, 4, 7 );
+        CheckElements( binder, intType, addr, 40, 0, 31 );
+    }
+
+    // the fields of a D array and a delegate come out in order
+    {
+        DataEnv         env( 0x1000 );
+        RawMemoryBinder binder( &env, scope );
+        MagoEE::Address addr = env.Allocate( 2 * sizeof( uint32_t ) );
+        MagoEE::ArrayElementReader  reader;
+        MagoEE::DataObject  elem = { 0 };
+        uint32_t        fields[] = { 0x1234, 0x5678 };
+
+        memcpy( env.GetBuffer() + addr, fields, sizeof fields );
+
+        elem._Type = darrayType;
+        elem.Addr = addr;
+        reader.Prefetch( &binder, addr, darrayType, 1 );
+        hr = reader.FillValue( &binder, elem );
+        assert( hr == S_OK );
+        assert( elem.Value.Array.Length == 0x1234 );
+        assert( elem.Value.Array.Addr == 0x5678 );
+
+        elem._Type = delegateType;
+        hr = reader.FillValue( &binder, elem );
+        assert( hr == S_OK );
+        assert( elem.Value.Delegate.ContextAddr == 0x1234 );
+        assert( elem.Value.Delegate.FuncAddr == 0x5678 );
+    }
+
+    // an array bigger than one read is read a window at a time
+    {
+        const uint32_t  Count = MagoEE::ArrayElementReader::MaxReadSize / sizeof( uint32_t ) + 1000;
+        DataEnv         env( Count * sizeof( uint32_t ) + 0x100 );
+        RawMemoryBinder binder( &env, scope );
+        MagoEE::Address addr = AllocateArray( env, Count * sizeof( uint32_t ) );
+
+        CheckElements( binder, intType, addr, Count, 0, 0 );
+        assert( CountReaderReads( binder, intType, addr, Count ) == 2 );
+    }
+
+    // a read that stops in the middle of an element, partway through the window
+    {
+        DataEnv         env( 0x1000 );
+        RawMemoryBinder binder( &env, scope );
+        MagoEE::Address addr = AllocateArray( env, 40 * sizeof( uint64_t ) );
+
+        binder.MaxReadSize = 10 * sizeof( uint64_t ) + 4;
+
+        CheckElements( binder, longType, addr, 40, 0, 0 );
+
+        // the next window starts at the element that was cut
+        assert( CountReaderReads( binder, longType, addr, 40 ) == 4 );
+    }
+
+    // the elements past the end of memory fail like they do alone
+    {
+        DataEnv         env( 0x1000 );
+        RawMemoryBinder binder( &env, scope );
+        MagoEE::Address addr = AllocateArray( env, 10 * sizeof( uint32_t ) + 2 );
+
+        CheckElements( binder, intType, addr, 20, 0, 0 );
+    }
+
+    return true;
+}
@@ -4427,6 +4427,8 @@ public:
     { return mParentEnv->GetSuper(); }
     virtual bool GetArrayLength( MagoEE::dlength_t& length )
     { length = mArrayLen; return true; }
+    virtual HRESULT ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+    { return mParentEnv->ReadMemory( address, sizeToRead, sizeRead, buffer ); }
 };
 
 
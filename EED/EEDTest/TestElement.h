@@ -31,6 +31,7 @@ public:
     virtual RefPtr<MagoEE::Declaration> GetThis() = 0;
     virtual RefPtr<MagoEE::Declaration> GetSuper() = 0;
     virtual bool GetArrayLength( MagoEE::dlength_t& length ) = 0;
+    virtual HRESULT ReadMemory( MagoEE::Address address, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer ) = 0;
 };
 
 
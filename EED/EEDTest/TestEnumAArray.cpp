@@ -0,0 +1,469 @@
+#include "Common.h"
+#include "DataEnv.h"
+
+#include <assert.h>
+#include <algorithm>
+
+
+// reads the AA straight out of a DataEnv, but can cut long reads short,
+// like a transport with a limit on each read, and remembers where every read started
+class AABinder : public DataEnvBinder
+{
+    int     mAAVersion;
+
+public:
+    uint32_t                        MaxReadSize;    // longer reads are short, 0 for no limit
+    std::vector<MagoEE::Address>    Reads;
+
+    AABinder( IValueEnv* env, IScope* scope, int aaVersion )
+        :   DataEnvBinder( env, scope ),
+            mAAVersion( aaVersion ),
+            MaxReadSize( 0 )
+    {
+    }
+
+    virtual int GetAAVersion()
+    {
+        return mAAVersion;
+    }
+
+    virtual HRESULT ReadMemory( MagoEE::Address addr, uint32_t sizeToRead, uint32_t& sizeRead, uint8_t* buffer )
+    {
+        Reads.push_back( addr );
+
+        if ( (MaxReadSize != 0) && (sizeToRead > MaxReadSize) )
+            sizeToRead = MaxReadSize;
+
+        return DataEnvBinder::ReadMemory( addr, sizeToRead, sizeRead, buffer );
+    }
+
+    size_t CountReads( MagoEE::Address begin, MagoEE::Address end )
+    {
+        size_t  count = 0;
+
+        for ( MagoEE::Address addr : Reads )
+        {
+            if ( (addr >= begin) && (addr < end) )
+                count++;
+        }
+        return count;
+    }
+};
+
+
+struct AAEntry
+{
+    uint32_t    Bucket;
+    int32_t     Key;
+    int32_t     Value;
+};
+
+struct TestAA
+{
+    MagoEE::Address Impl;
+    MagoEE::Address Buckets;
+    MagoEE::Address BucketsEnd;
+};
+
+
+static void Poke( DataEnv& env, MagoEE::Address addr, uint32_t value )
+{
+    memcpy( env.GetBuffer() + addr, &value, sizeof value );
+}
+
+static uint32_t Peek( DataEnv& env, MagoEE::Address addr )
+{
+    uint32_t    value = 0;
+    memcpy( &value, env.GetBuffer() + addr, sizeof value );
+    return value;
+}
+
+// lays out a dmd 2.067 AA of int[int]: buckets pointing to lists of {next, hash, key, value},
+// each entry goes on the end of its bucket's list
+static TestAA MakeAAV0( DataEnv& env, uint32_t bucketCount, const std::vector<AAEntry>& entries )
+{
+    TestAA  aa = { 0 };
+    BB32    bb = { 0 };
+
+    aa.Buckets = env.Allocate( bucketCount * sizeof( uint32_t ) );
+    aa.BucketsEnd = aa.Buckets + bucketCount * sizeof( uint32_t );
+    memset( env.GetBuffer() + aa.Buckets, 0, bucketCount * sizeof( uint32_t ) );
+
+    for ( const AAEntry& entry : entries )
+    {
+        MagoEE::Address node = env.Allocate( sizeof( aaA32 ) + 2 * sizeof( int32_t ) );
+        MagoEE::Address link = aa.Buckets + entry.Bucket * sizeof( uint32_t );
+
+        Poke( env, node, 0 );
+        Poke( env, node + 4, entry.Key );
+        Poke( env, node + 8, entry.Key );
+        Poke( env, node + 12, entry.Value );
+
+        // the next pointer is the first field of a node
+        while ( Peek( env, link ) != 0 )
+            link = Peek( env, link );
+
+        Poke( env, link, (uint32_t) node );
+    }
+
+    bb.b.length = bucketCount;
+    bb.b.ptr = (uint32_t) aa.Buckets;
+    bb.nodes = (uint32_t) entries.size();
+
+    aa.Impl = env.Allocate( sizeof bb );
+    memcpy( env.GetBuffer() + aa.Impl, &bb, sizeof bb );
+
+    return aa;
+}
+
+// lays out a dmd 2.068 AA of int[int]: open addressed buckets of {hash, entry},
+// where entries are {key, value} and the deleted buckets are left marked as such
+static TestAA MakeAAV1(
+    DataEnv& env,
+    uint32_t bucketCount,
+    const std::vector<AAEntry>& entries,
+    const std::vector<uint32_t>& deleted )
+{
+    const uint32_t  HashDeleted = 1;
+    const uint32_t  HashFilledMark = 0x80000000;
+    TestAA  aa = { 0 };
+    BB32_V1 bb = { 0 };
+
+    aa.Buckets = env.Allocate( bucketCount * sizeof( Bucket32 ) );
+    aa.BucketsEnd = aa.Buckets + bucketCount * sizeof( Bucket32 );
+    memset( env.GetBuffer() + aa.Buckets, 0, bucketCount * sizeof( Bucket32 ) );
+
+    for ( const AAEntry& entry : entries )
+    {
+        MagoEE::Address node = env.Allocate( 2 * sizeof( int32_t ) );
+        MagoEE::Address bucket = aa.Buckets + entry.Bucket * sizeof( Bucket32 );
+
+        Poke( env, node, entry.Key );
+        Poke( env, node + 4, entry.Value );
+
+        Poke( env, bucket, HashFilledMark | entry.Key );
+        Poke( env, bucket + 4, (uint32_t) node );
+    }
+
+    for ( uint32_t index : deleted )
+    {
+        Poke( env, aa.Buckets + index * sizeof( Bucket32 ), HashDeleted );
+    }
+
+    bb.buckets.length = bucketCount;
+    bb.buckets.ptr = (uint32_t) aa.Buckets;
+    bb.used = (uint32_t) (entries.size() + deleted.size());
+    bb.deleted = (uint32_t) deleted.size();
+    bb.keysz = sizeof( int32_t );
+    bb.valsz = sizeof( int32_t );
+    bb.valoff = sizeof( int32_t );
+
+    aa.Impl = env.Allocate( sizeof bb );
+    memcpy( env.GetBuffer() + aa.Impl, &bb, sizeof bb );
+
+    return aa;
+}
+
+static RefPtr<MagoEE::IEEDEnumValues> EnumAA(
+    MagoEE::ITypeEnv* typeEnv,
+    MagoEE::IValueBinder* binder,
+    MagoEE::Address impl )
+{
+    HRESULT hr = S_OK;
+    RefPtr<MagoEE::NameTable>       strTable;
+    RefPtr<MagoEE::Type>            aaType;
+    RefPtr<MagoEE::IEEDEnumValues>  en;
+    MagoEE::Type*       intType = typeEnv->GetType( MagoEE::Tint32 );
+    MagoEE::FormatOptions   fmtopts( 10 );
+    MagoEE::EvalResult  parent = { 0 };
+
+    hr = MagoEE::MakeNameTable( strTable.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    hr = typeEnv->NewAArray( intType, intType, aaType.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    parent.ObjVal._Type = aaType;
+    parent.ObjVal.Value.Addr = impl;
+
+    hr = MagoEE::EnumValueChildren( binder, L"aa", parent, typeEnv, strTable, fmtopts, en.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    return en;
+}
+
+static void CheckEntry( MagoEE::IEEDEnumValues* en, const AAEntry& expected )
+{
+    HRESULT hr = S_OK;
+    MagoEE::EvalResult  result = { 0 };
+    std::wstring        name;
+    std::wstring        fullName;
+
+    hr = en->EvaluateNext( MagoEE::EvalOptions::defaults, result, name, fullName, {} );
+    assert( SUCCEEDED( hr ) );
+
+    assert( name == L"[" + std::to_wstring( expected.Key ) + L"]" );
+    assert( fullName == L"aa" + name );
+    assert( result.ObjVal.Value.Int64Value == expected.Value );
+}
+
+// walks the whole AA, the entries are expected in bucket order, and in list order within a bucket
+static void CheckEntries( MagoEE::IEEDEnumValues* en, const std::vector<AAEntry>& expected )
+{
+    HRESULT hr = S_OK;
+    MagoEE::EvalResult  result = { 0 };
+    std::wstring        name;
+    std::wstring        fullName;
+
+    assert( en->GetCount() == expected.size() );
+
+    for ( const AAEntry& entry : expected )
+    {
+        CheckEntry( en, entry );
+    }
+
+    hr = en->EvaluateNext( MagoEE::EvalOptions::defaults, result, name, fullName, {} );
+    assert( FAILED( hr ) );
+}
+
+// count entries stepping through the buckets by stride, in the order a walk finds them
+static std::vector<AAEntry> MakeEntries( int32_t count, uint32_t bucketCount, uint32_t stride )
+{
+    std::vector<AAEntry> entries;
+
+    for ( int32_t i = 0; i < count; i++ )
+    {
+        AAEntry entry = { (i * stride) % bucketCount, i, i * 3 };
+        entries.push_back( entry );
+    }
+
+    std::stable_sort( entries.begin(), entries.end(),
+        []( const AAEntry& a, const AAEntry& b ) { return a.Bucket < b.Bucket; } );
+
+    return entries;
+}
+
+bool TestEnumAArray( MagoEE::ITypeEnv* typeEnv, IScope* scope )
+{
+    // a 32-bit AA can't be read by a 64-bit type environment
+    if ( typeEnv->GetPointerSize() != 4 )
+        return true;
+
+    // lists of entries sharing a bucket
+    {
+        DataEnv     env( 0x1000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries =
+        {
+            { 0, 7, 700 },
+            { 2, 10, 1000 },
+            { 2, 17, 1700 },
+            { 2, 24, 2400 },
+            { 5, 12, 1200 },
+        };
+        TestAA      aa = MakeAAV0( env, 7, entries );
+
+        CheckEntries( EnumAA( typeEnv, &binder, aa.Impl ), entries );
+    }
+
+    // few entries spread over more buckets than one chunk holds
+    {
+        DataEnv     env( 0x20000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries =
+        {
+            { 3, 3, 30 },
+            { 16383, 16383, 163830 },
+            { 16384, 16384, 163840 },
+            { 19999, 19999, 199990 },
+        };
+        TestAA      aa = MakeAAV0( env, 20000, entries );
+
+        CheckEntries( EnumAA( typeEnv, &binder, aa.Impl ), entries );
+
+        // 0x10000 bytes of buckets at a time
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 2 );
+    }
+
+    // open addressing, with deleted buckets to pass over
+    {
+        DataEnv     env( 0x30000 );
+        AABinder    binder( &env, scope, 1 );
+        std::vector<AAEntry> entries =
+        {
+            { 0, 1, 10 },
+            { 5, 5, 50 },
+            { 8191, 8191, 81910 },
+            { 8192, 8192, 81920 },
+            { 16383, 16383, 163830 },
+        };
+        TestAA      aa = MakeAAV1( env, 16384, entries, { 6, 8000 } );
+
+        CheckEntries( EnumAA( typeEnv, &binder, aa.Impl ), entries );
+
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 2 );
+    }
+
+    // reads that stop in the middle of a bucket, partway through each chunk
+    {
+        DataEnv     env( 0x20000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries =
+        {
+            { 3, 3, 30 },
+            { 999, 999, 9990 },
+            { 1000, 1000, 10000 },
+            { 16383, 16383, 163830 },
+            { 19999, 19999, 199990 },
+        };
+        TestAA      aa = MakeAAV0( env, 20000, entries );
+
+        binder.MaxReadSize = 1000 * sizeof( uint32_t ) + 2;
+
+        CheckEntries( EnumAA( typeEnv, &binder, aa.Impl ), entries );
+
+        // the partial bucket at the end of each read is read again, starting the next one
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 20 );
+        assert( std::count( binder.Reads.begin(), binder.Reads.end(), aa.Buckets + 1000 * sizeof( uint32_t ) ) == 1 );
+        assert( std::count( binder.Reads.begin(), binder.Reads.end(), aa.Buckets + 19000 * sizeof( uint32_t ) ) == 1 );
+    }
+
+    // the entries are found a page at a time, and each bucket is only read once
+    {
+        DataEnv     env( 0x2000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries = MakeEntries( 100, 211, 2 );
+        TestAA      aa = MakeAAV0( env, 211, entries );
+        RefPtr<MagoEE::IEEDEnumValues> en = EnumAA( typeEnv, &binder, aa.Impl );
+
+        // a bucket at a time, once the AA's header has been read
+        assert( en->GetCount() == 100 );
+        binder.MaxReadSize = sizeof( uint32_t );
+
+        CheckEntry( en, entries[0] );
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 2 * 63 + 1 );
+
+        for ( size_t i = 1; i < 63; i++ )
+            CheckEntry( en, entries[i] );
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 2 * 63 + 1 );
+
+        // moving on from the last entry found looks for the next page from there
+        CheckEntry( en, entries[63] );
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 2 * 99 + 1 );
+
+        // and the empty buckets after the last entry aren't read
+        en->Reset();
+        CheckEntries( en, entries );
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 2 * 99 + 1 );
+    }
+
+    // no more entries than the AA has are looked for
+    {
+        DataEnv     env( 0x1000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries = MakeEntries( 10, 50, 1 );
+        TestAA      aa = MakeAAV0( env, 50, entries );
+        RefPtr<MagoEE::IEEDEnumValues> en = EnumAA( typeEnv, &binder, aa.Impl );
+
+        assert( en->GetCount() == 10 );
+        binder.MaxReadSize = sizeof( uint32_t );
+
+        CheckEntry( en, entries[0] );
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 10 );
+    }
+
+    // past the maximum array length, one entry stands for the rest
+    {
+        DataEnv     env( 0x1000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries = MakeEntries( 10, 50, 1 );
+        TestAA      aa = MakeAAV0( env, 50, entries );
+        uint32_t    maxArrayLength = MagoEE::gMaxArrayLength;
+        HRESULT     hr = S_OK;
+        MagoEE::EvalResult  result = { 0 };
+        std::wstring        name;
+        std::wstring        fullName;
+
+        MagoEE::gMaxArrayLength = 5;
+
+        RefPtr<MagoEE::IEEDEnumValues> en = EnumAA( typeEnv, &binder, aa.Impl );
+
+        assert( en->GetCount() == 6 );
+        binder.MaxReadSize = sizeof( uint32_t );
+
+        for ( size_t i = 0; i < 5; i++ )
+            CheckEntry( en, entries[i] );
+
+        hr = en->EvaluateNext( MagoEE::EvalOptions::defaults, result, name, fullName, {} );
+        assert( hr == S_OK );
+        assert( name == L"5 more items not shown..." );
+        assert( fullName.empty() );
+
+        hr = en->EvaluateNext( MagoEE::EvalOptions::defaults, result, name, fullName, {} );
+        assert( FAILED( hr ) );
+
+        // the entries that aren't shown aren't looked for
+        assert( binder.CountReads( aa.Buckets, aa.BucketsEnd ) == 6 );
+
+        MagoEE::gMaxArrayLength = maxArrayLength;
+    }
+
+    // skipping, cloning and resetting land on the same entries as a plain walk
+    {
+        DataEnv     env( 0x2000 );
+        AABinder    binder( &env, scope, 0 );
+        std::vector<AAEntry> entries = MakeEntries( 100, 37, 7 );
+        TestAA      aa = MakeAAV0( env, 37, entries );
+        RefPtr<MagoEE::IEEDEnumValues> en = EnumAA( typeEnv, &binder, aa.Impl );
+        RefPtr<MagoEE::IEEDEnumValues> clone;
+        HRESULT     hr = S_OK;
+        size_t      readCount = 0;
+
+        assert( en->GetCount() == 100 );
+        binder.MaxReadSize = sizeof( uint32_t );
+
+        hr = en->Skip( 10 );
+        assert( hr == S_OK );
+        assert( en->GetIndex() == 10 );
+        CheckEntry( en, entries[10] );
+
+        hr = en->Clone( clone.Ref() );
+        assert( SUCCEEDED( hr ) );
+        assert( clone->GetIndex() == 11 );
+
+        // the clone finds the entries past the first page for both of them
+        hr = clone->Skip( 70 );
+        assert( hr == S_OK );
+        CheckEntry( clone, entries[81] );
+
+        readCount = binder.Reads.size();
+
+        CheckEntry( en, entries[11] );
+        hr = en->Skip( 80 );
+        assert( hr == S_OK );
+        CheckEntry( en, entries[92] );
+        assert( binder.Reads.size() == readCount );
+
+        CheckEntry( clone, entries[82] );
+
+        // back to the start without walking the buckets again
+        en->Reset();
+        assert( en->GetIndex() == 0 );
+        CheckEntry( en, entries[0] );
+        assert( binder.Reads.size() == readCount );
+
+        en->Reset();
+        CheckEntries( en, entries );
+
+        // skipping past the end leaves nothing to evaluate
+        clone->Reset();
+        hr = clone->Skip( 101 );
+        assert( hr == S_FALSE );
+        assert( clone->GetIndex() == 100 );
+
+        hr = clone->Skip( 1 );
+        assert( hr == S_FALSE );
+    }
+
+    return true;
+}
@@ -0,0 +1,151 @@
+#include "Common.h"
+#include "DataEnv.h"
+
+#include <assert.h>
+
+// fails without calling the completion, and remembers the options it was given
+class FailingExpr : public MagoEE::IEEDParsedExpr
+{
+    long    mRefCount;
+
+public:
+    bool    Evaluated;
+    bool    AllowedPropertyExec;
+
+    FailingExpr()
+        :   mRefCount( 0 ),
+            Evaluated( false ),
+            AllowedPropertyExec( false )
+    {
+    }
+
+    virtual void AddRef()
+    {
+        mRefCount++;
+    }
+
+    virtual void Release()
+    {
+        if ( --mRefCount == 0 )
+            delete this;
+    }
+
+    virtual HRESULT Bind( const MagoEE::EvalOptions& options, MagoEE::IValueBinder* binder )
+    {
+        return S_OK;
+    }
+
+    virtual HRESULT Evaluate( const MagoEE::EvalOptions& options, MagoEE::IValueBinder* binder, MagoEE::EvalResult& result,
+        std::function<HRESULT(HRESULT, MagoEE::EvalResult)> complete )
+    {
+        Evaluated = true;
+        AllowedPropertyExec = options.AllowPropertyExec;
+        return E_FAIL;
+    }
+};
+
+static RefPtr<MagoEE::IEEDParsedExpr> ParseAndBind(
+    const wchar_t* text,
+    MagoEE::ITypeEnv* typeEnv,
+    MagoEE::NameTable* nameTable,
+    MagoEE::IValueBinder* binder )
+{
+    RefPtr<MagoEE::IEEDParsedExpr>  expr;
+    HRESULT hr = S_OK;
+
+    hr = MagoEE::ParseText( text, typeEnv, nameTable, expr.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    hr = expr->Bind( MagoEE::EvalOptions::defaults, binder );
+    assert( SUCCEEDED( hr ) );
+
+    return expr;
+}
+
+bool TestEvaluateBatch( MagoEE::ITypeEnv* typeEnv, IScope* scope, IValueEnv* valueEnv )
+{
+    HRESULT hr = S_OK;
+    RefPtr<MagoEE::NameTable>   nameTable;
+    DataEnvBinder       binder( valueEnv, scope );
+    MagoEE::EvalOptions options = MagoEE::EvalOptions::defaults;
+    RefPtr<FailingExpr> failing = new FailingExpr();
+    RefPtr<FailingExpr> failingProp = new FailingExpr();
+    std::vector<RefPtr<MagoEE::IEEDParsedExpr>> exprs;
+    std::vector<MagoEE::EvalResult> results;
+    std::vector<uint32_t>   completed;
+    std::vector<HRESULT>    completedHR;
+    std::vector<int64_t>    completedValues;
+
+    auto complete = [&]( uint32_t index, HRESULT evalHR, MagoEE::EvalResult result )
+    {
+        completed.push_back( index );
+        completedHR.push_back( evalHR );
+        completedValues.push_back( SUCCEEDED( evalHR ) ? result.ObjVal.Value.Int64Value : 0 );
+        return S_OK;
+    };
+
+    hr = MagoEE::MakeNameTable( nameTable.Ref() );
+    assert( SUCCEEDED( hr ) );
+
+    exprs.push_back( ParseAndBind( L"1 + 2", typeEnv, nameTable, &binder ) );
+    exprs.push_back( NULL );
+    exprs.push_back( failing.Get() );
+    exprs.push_back( ParseAndBind( L"3 * 4", typeEnv, nameTable, &binder ) );
+    exprs.push_back( failingProp.Get() );
+
+    results.resize( exprs.size() );
+    results[4].fmtOptions.prop = true;
+
+    options.AllowPropertyExec = false;
+
+    hr = MagoEE::EvaluateBatch( options, &binder, exprs, results, complete );
+    assert( hr == S_OK );
+
+    // each item is completed once, in order, and the NULL item is skipped,
+    // whether evaluating it succeeded or failed
+    assert( completed.size() == 4 );
+    assert( completed[0] == 0 );
+    assert( completed[1] == 2 );
+    assert( completed[2] == 3 );
+    assert( completed[3] == 4 );
+
+    assert( completedHR[0] == S_OK );
+    assert( completedValues[0] == 3 );
+    assert( completedHR[1] == E_FAIL );
+    assert( completedHR[2] == S_OK );
+    assert( completedValues[2] == 12 );
+    assert( completedHR[3] == E_FAIL );
+
+    assert( results[0].ObjVal.Value.Int64Value == 3 );
+    assert( results[3].ObjVal.Value.Int64Value == 12 );
+
+    // only the item with the format specifier can call properties
+    assert( failing->Evaluated && !failing->AllowedPropertyExec );
+    assert( failingProp->Evaluated && failingProp->AllowedPropertyExec );
+
+    // bad arguments complete nothing
+    completed.clear();
+
+    hr = MagoEE::EvaluateBatch( options, NULL, exprs, results, complete );
+    assert( hr == E_INVALIDARG );
+
+    results.pop_back();
+    hr = MagoEE::EvaluateBatch( options, &binder, exprs, results, complete );
+    assert( hr == E_INVALIDARG );
+    results.resize( exprs.size() );
+
+    hr = MagoEE::EvaluateBatch( options, &binder, exprs, results, {} );
+    assert( hr == E_INVALIDARG );
+
+    assert( completed.empty() );
+
+    // an empty batch is fine
+    exprs.clear();
+    results.clear();
+
+    hr = MagoEE::EvaluateBatch( options, &binder, exprs, results, complete );
+    assert( hr == S_OK );
+    assert( completed.empty() );
+
+    return true;
+}
@@ -52,6 +52,8 @@
 
 #include <atomic>
 #include <chrono>
+#include <list>
+#include <unordered_map>
 
 ///////////////////////////////////////////////////////////////////////////////
 #define NOT_IMPL(x) virtual HRESULT x override { return E_NOTIMPL; }
@@ -64,8 +66,66 @@ Evaluation::IL::DkmILCallingConvention::e toCallingConvention(uint8_t callConv);
 CComPtr<DkmString> toDkmString(const wchar_t* str);
 
 extern "C" char* dlang_demangle(const char* mangled, int options);
+extern "C" int dlang_demangle_buffer(const char* mangled, int options, char** buffer, size_t* size);
 extern "C" const char* dlang_demangle_funcattr(const char* mangled);
 
+// Demangled D names for the whole process, keyed by the mangled name.
+// When full, the least recently used name makes room for the new one.
+class DemangledNames
+{
+    static const size_t MaxNames = 0x10000;
+
+    typedef std::list<std::pair<std::wstring, std::wstring>> NameList;
+
+    Guard mGuard;
+    NameList mOrder;    // most recently used first
+    std::unordered_map<std::wstring, NameList::iterator> mNames;
+
+public:
+    bool Find(const std::wstring& mangled, std::wstring& demangled)
+    {
+        GuardedArea guard(mGuard);
+        auto it = mNames.find(mangled);
+        if (it == mNames.end())
+            return false;
+        mOrder.splice(mOrder.begin(), mOrder, it->second);
+        demangled = it->second->second;
+        return true;
+    }
+
+    void Add(const std::wstring& mangled, const std::wstring& demangled)
+    {
+        GuardedArea guard(mGuard);
+        auto it = mNames.find(mangled);
+        if (it != mNames.end())
+        {
+            it->second->second = demangled;
+            mOrder.splice(mOrder.begin(), mOrder, it->second);
+            return;
+        }
+        if (mNames.size() >= MaxNames)
+        {
+            mNames.erase(mOrder.back().first);
+            mOrder.pop_back();
+        }
+        mOrder.emplace_front(mangled, demangled);
+        mNames[mangled] = mOrder.begin();
+    }
+};
+
+// UTF-8 buffers kept by each thread for demangling
+struct DemangleBuffers
+{
+    std::vector<char> Mangled;
+    char* Demangled = nullptr;      // grown by dlang_demangle_buffer with realloc
+    size_t DemangledSize = 0;
+
+    ~DemangleBuffers()
+    {
+        free(Demangled);
+    }
+};
+
 // stub to read/write memory from process, all other functions supposed to not be called
 class CCDebuggerProxy : public Mago::IDebuggerProxy
 {
@@ -103,6 +163,15 @@ public:
         return S_OK;
     }
 
+    virtual HRESULT ReadMemoryBatch( 
+        Mago::ICoreProcess* process, 
+        uint32_t count, 
+        Mago::MemoryReadRange* ranges, 
+        uint8_t* buffer )
+    {
+        return Mago::ReadMemoryRanges( this, process, count, ranges, buffer );
+    }
+
     virtual HRESULT WriteMemory( 
         Mago::ICoreProcess* process, 
         Mago::Address64 address,
@@ -427,26 +496,45 @@ public:
         if (pos >= len || symName[pos] != 'D')
             return false;
 
-        CAutoVectorPtr<char> u8Name;
-        size_t               u8NameLen = 0;
-        HRESULT hr = Utf16To8(symName.data() + pos - 1, len - pos + 1, u8Name.m_p, u8NameLen);
-        if (FAILED(hr))
-            return false;
+        // call stacks and symbol lists show the same long template names over and over
+        static DemangledNames names;
+        std::wstring demangled;
 
-        char* demangled = dlang_demangle(u8Name, 0);
-        if (!demangled)
-            return false;
+        if (names.Find(symName, demangled))
+        {
+            if (demangled.empty())
+                return false;
+            symName.swap(demangled);
+            return true;
+        }
 
-        CAutoVectorPtr<char> u16Name;
-        size_t               u16NameLen = 0;
-        BSTR u16Str = NULL;
-        hr = Utf8To16(demangled, strlen(demangled), u16Str);
-        free(demangled);
-        if (FAILED(hr))
+        // the conversions and the demangler reuse the buffers of this thread
+        static thread_local DemangleBuffers buffers;
+
+        int u8Len = MagoEE::Utf16To8(symName.data() + pos - 1, (int)(len - pos + 1), nullptr, 0);
+        if (u8Len <= 0)
             return false;
+        buffers.Mangled.resize(u8Len + 1);
+        MagoEE::Utf16To8(symName.data() + pos - 1, (int)(len - pos + 1), buffers.Mangled.data(), u8Len);
+        buffers.Mangled[u8Len] = '\0';
+
+        int demangledLen = dlang_demangle_buffer(buffers.Mangled.data(), 0, &buffers.Demangled, &buffers.DemangledSize);
+        if (demangledLen > 0)
+        {
+            int u16Len = MagoEE::Utf8To16(buffers.Demangled, demangledLen, nullptr, 0);
+            if (u16Len > 0)
+            {
+                demangled.resize(u16Len);
+                MagoEE::Utf8To16(buffers.Demangled, demangledLen, &demangled[0], u16Len);
+            }
+        }
+
+        // failures are remembered too, as an empty name
+        names.Add(symName, demangled);
 
-        symName = u16Str;
-        SysFreeString(u16Str);
+        if (demangled.empty())
+            return false;
+        symName.swap(demangled);
         return true;
     }
 
@@ -1026,6 +1114,58 @@ public:
         return ExprContext::Init(mModule->mModule, mThread, funcSH, blockSH, va, mModule->mRegSet);
     }
 
+    // Memory is read through the program's cache while a batch is evaluated. Other
+    // components write debuggee memory through Concord between our calls, and Concord
+    // caches reads while paused, so the cache is only kept for one batch.
+    struct BatchScope
+    {
+        RefPtr<Mago::Program> mProgram;
+        bool mEnabled = false; // turned on by this scope
+
+        BatchScope(CCExprContext* exprContext)
+            : mProgram(exprContext->mModule->mProgram)
+        {
+            if (!mProgram->IsMemoryCacheEnabled())
+            {
+                mProgram->EnableMemoryCache(true);
+                mEnabled = true;
+            }
+        }
+        ~BatchScope()
+        {
+            if (mEnabled)
+                mProgram->EnableMemoryCache(false);
+        }
+    };
+
+    // Evaluates the expressions of a watch window for the frame of this context. The
+    // frame is set up once, expressions bound before in the same scope are used again,
+    // and memory is read through the program's cache. complete is called for each
+    // expression with its index, maybe after this returns.
+    HRESULT EvaluateBatch(const MagoEE::EvalOptions& options,
+                          const std::vector<std::wstring>& texts,
+                          const std::vector<MagoEE::FormatOptions>& fmtopts,
+                          std::function<HRESULT(uint32_t, HRESULT, MagoEE::EvalResult)> complete)
+    {
+        if (texts.size() != fmtopts.size())
+            return E_INVALIDARG;
+
+        BatchScope batch(this);
+        std::vector<RefPtr<MagoEE::IEEDParsedExpr>> exprs(texts.size());
+        std::vector<MagoEE::EvalResult> results(texts.size());
+
+        for (uint32_t i = 0; i < texts.size(); i++)
+        {
+            results[i].fmtOptions = fmtopts[i];
+
+            HRESULT hr = ParseBoundText(texts[i].c_str(), options.Radix, exprs[i]);
+            if (FAILED(hr))
+                complete(i, hr, results[i]);
+        }
+
+        return MagoEE::EvaluateBatch(options, this, exprs, results, complete);
+    }
+
     virtual HRESULT GetSession(MagoST::ISession*& session)
     {
         _ASSERT(session == NULL);
@@ -1459,6 +1599,10 @@ public:
     {
         Log::LogMessage("CMagoNatCCService::CallFunction\n");
 
+        // the function can change any memory, and enabling the cache again drops its pages
+        if (mModule->mProgram->IsMemoryCacheEnabled())
+            mModule->mProgram->EnableMemoryCache(true);
+
         HRESULT hr_gc = S_FALSE;
         if (saveGC && MagoEE::gCallDebuggerUseMagoGC)
             hr_gc = SwitchToMagoGC();
@@ -1833,22 +1977,28 @@ HRESULT InitExprContext(Evaluation::DkmInspectionContext* pInspectionContext,
                         RefPtr<CCExprContext>& exprContext)
 {
     auto session = pInspectionContext->InspectionSession();
-    if (session->GetDataItem<CCExprContext>(&exprContext.Ref()) == S_OK)
+    RefPtr<CCExprContext> sessionContext;
+    if (session->GetDataItem<CCExprContext>(&sessionContext.Ref()) != S_OK)
+        readMagoOptions(); // new inspection context
+
+#if 1 // disable if caching causes too much trouble
+    // The context is kept with the frame, which lives until the process runs again,
+    // so that the watches and locals of a frame don't each look up its module and
+    // function again. Concord drops the frame's data items when it closes the frame.
+    if (pStackFrame->GetDataItem<CCExprContext>(&exprContext.Ref()) == S_OK)
     {
-        if (exprContext->mWorkList == pWorkList && exprContext->mStackFrame == pStackFrame)
-            return S_OK;
-        exprContext = nullptr;
+        tryHR(exprContext->SetWorkList(pWorkList));
+    }
+    else
+#endif
+    {
+        tryHR(MakeCComObject(exprContext));
+        auto process = pInspectionContext->RuntimeInstance()->Process();
+        tryHR(exprContext->Init(process, pWorkList, pStackFrame));
+        tryHR(pStackFrame->SetDataItem(DkmDataCreationDisposition::CreateAlways, exprContext.Get()));
     }
-    else // new inspection context
-        readMagoOptions();
-
-    tryHR(MakeCComObject(exprContext));
-    auto process = pInspectionContext->RuntimeInstance()->Process();
-    tryHR(exprContext->Init(process, pWorkList, pStackFrame));
 
-#if 1 // disable if caching causes too much trouble
     tryHR(session->SetDataItem(DkmDataCreationDisposition::CreateAlways, exprContext.Get()));
-#endif
     return S_OK;
 }
 
@@ -2046,12 +2196,6 @@ HRESULT STDMETHODCALLTYPE CMagoNatCCService::EvaluateExpression(
     MagoEE::FormatOptions fmtopt;
     tryHR(MagoEE::StripFormatSpecifier(exprText, fmtopt));
 
-    auto modContext = exprContext->GetModuleContext();
-    RefPtr<MagoEE::IEEDParsedExpr> pExpr;
-    hr = MagoEE::ParseText(exprText.c_str(), modContext->GetTypeEnv(), modContext->GetStringTable(), pExpr.Ref());
-    if (FAILED(hr))
-        return createEvaluationError(pInspectionContext, pStackFrame, hr, exprText, pCompletionRoutine);
-
     MagoEE::EvalOptions options = MagoEE::EvalOptions::defaults;
     options.Radix = pInspectionContext->Radix();
     options.Timeout = pInspectionContext->Timeout();
@@ -2060,20 +2204,14 @@ HRESULT STDMETHODCALLTYPE CMagoNatCCService::EvaluateExpression(
         options.AllowAssignment = true;
     if ((evalFlags & Evaluation::DkmEvaluationFlags::NoFuncEval) == 0)
         options.AllowFuncExec = true;
-    if (fmtopt.prop)
-        options.AllowPropertyExec = true;
-
-    hr = pExpr->Bind(options, exprContext);
-    if (FAILED(hr))
-        return createEvaluationError(pInspectionContext, pStackFrame, hr, exprText, pCompletionRoutine);
 
-    MagoEE::EvalResult value = { 0 };
-    value.fmtOptions = fmtopt;
-    hr = pExpr->Evaluate(options, exprContext, value,
+    // Concord asks for one expression at a time, but a batch of one still finds
+    // the expression bound already when a watch is refreshed
+    hr = exprContext->EvaluateBatch(options, { exprText }, { fmtopt },
         [exprContext, exprText, fmtopt, options,
         inspectionContext = RefPtr<Evaluation::DkmInspectionContext>(pInspectionContext),
         completionRoutine = RefPtr<IDkmCompletionRoutine<Evaluation::DkmEvaluateExpressionAsyncResult>>(pCompletionRoutine)]
-        (HRESULT hr, MagoEE::EvalResult value)
+        (uint32_t index, HRESULT hr, MagoEE::EvalResult value)
         {
             RefPtr<Mago::Property> pProperty;
             if(SUCCEEDED(hr))
@@ -2126,6 +2264,7 @@ HRESULT STDMETHODCALLTYPE CMagoNatCCService::GetChildren(
 
     RefPtr<CCExprContext> exprContext;
     tryHR(InitExprContext(pInspectionContext, pWorkList, pResult->StackFrame(), false, exprContext));
+    CCExprContext::BatchScope batch(exprContext);
 
     int radix = pInspectionContext->Radix();
     int timeout = pInspectionContext->Timeout();
@@ -2223,6 +2362,8 @@ HRESULT STDMETHODCALLTYPE CMagoNatCCService::GetItems(
 
     RefPtr<CCExprContext> exprContext;
     tryHR(InitExprContext(pEnumContext->InspectionContext(), pWorkList, pEnumContext->StackFrame(), false, exprContext));
+    // the locals or children asked for are evaluated together
+    CCExprContext::BatchScope batch(exprContext);
 
     RefPtr<IEnumDebugPropertyInfo2> pEnum;
     tryHR(pEnumContext->GetDataItem(&pEnum.Ref()));
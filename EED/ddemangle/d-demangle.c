@@ -1751,26 +1751,22 @@ dlang_parse_template (string *decl, const char *mangled, state* options, long le
   return mangled;
 }
 
-/* Extract and demangle the symbol in MANGLED.  Returns the demangled
-   signature on success or NULL on failure.  */
+/* Demangle the symbol in MANGLED into DECL, which may already own a buffer.
+   Returns nonzero and leaves a '\0' terminated result in DECL on success.
+   On failure DECL is emptied, but its buffer is kept.  */
 
-char *
-dlang_demangle (const char *mangled, int options)
+static int
+dlang_demangle_string (string *decl, const char *mangled)
 {
-  string decl;
-  char *demangled = NULL;
-
   if (mangled == NULL || *mangled == '\0')
-    return NULL;
+    return 0;
 
   if (strncmp (mangled, "_D", 2) != 0)
-    return NULL;
-
-  string_init (&decl);
+    return 0;
 
   if (strcmp (mangled, "_Dmain") == 0)
     {
-      string_append (&decl, "D main");
+      string_append (decl, "D main");
     }
   else
     {
@@ -1780,19 +1776,62 @@ dlang_demangle (const char *mangled, int options)
       opts.mangled = mangled;
       opts.last_backref = strlen (mangled);
 
-      mangled = dlang_parse_mangle (&decl, mangled, &opts);
+      mangled = dlang_parse_mangle (decl, mangled, &opts);
       if (mangled == NULL || *mangled != '\0')
-	string_delete (&decl);
+	string_setlength (decl, 0);
     }
 
-  if (string_length (&decl) > 0)
+  if (string_length (decl) > 0)
     {
-      string_need (&decl, 1);
-      *(decl.p) = '\0';
-      demangled = decl.b;
+      string_need (decl, 1);
+      *(decl->p) = '\0';
+      return 1;
     }
 
-  return demangled;
+  return 0;
+}
+
+/* Extract and demangle the symbol in MANGLED.  Returns the demangled
+   signature on success or NULL on failure.  */
+
+char *
+dlang_demangle (const char *mangled, int options)
+{
+  string decl;
+
+  string_init (&decl);
+
+  if (dlang_demangle_string (&decl, mangled))
+    return decl.b;
+
+  string_delete (&decl);
+  return NULL;
+}
+
+/* Like dlang_demangle, but reentrant on a caller's buffer.  *BUFFER is NULL or
+   a block of *SIZE bytes from malloc.  It's grown with realloc as needed, and
+   the caller keeps it for the next call and frees it in the end.  Returns the
+   length of the '\0' terminated signature in *BUFFER, or -1 on failure.  */
+
+int
+dlang_demangle_buffer (const char *mangled, int options, char **buffer, size_t *size)
+{
+  string decl;
+  int ok;
+
+  string_init (&decl);
+  if (*buffer != NULL)
+    {
+      decl.b = decl.p = *buffer;
+      decl.e = *buffer + *size;
+    }
+
+  ok = dlang_demangle_string (&decl, mangled);
+
+  *buffer = decl.b;
+  *size = decl.e - decl.b;
+
+  return ok ? string_length (&decl) : -1;
 }
 
 // return the pointer to the function attributes inside mangled
@@ -1,8 +1,10 @@
 #include <stdlib.h>
 
+#ifndef XNEWVEC
 #define XNEWVEC(T, n)       malloc(sizeof(T)*(n))
 #define XRESIZEVEC(T, p, n) realloc(p, sizeof(T)*(n))
 #define XDELETEVEC(p)       free(p)
+#endif
 
 #define DMGL_NO_OPTS	 0		/* For readability... */
 #define DMGL_PARAMS	 (1 << 0)	/* Include function args */